@@ -0,0 +1,160 @@
+#include "../include/Book.h"
+#include "../include/HashIndex.h"
+#include "../include/MyVector.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <string_view>
+
+/**
+ * @brief HashIndex 与旧版 MyVector::hashFindByIsbn 的 ISBN 查找基准
+ * 旧实现已从 MyVector 中移除，这里按原样复现其布局作对照：哈希值与下标分两个数组存放，
+ * 取模定位，每次比较都按值复制一份 ISBN。
+ * 用法：HashIndexBench [图书数量]，默认 200000；两种实现结果不一致时返回 1。
+ * @author 陈子涵
+ */
+
+namespace {
+    class LegacyIsbnIndex {
+    private:
+        static constexpr size_t EMPTY_SLOT = static_cast<size_t>(-1);
+
+        const MyVector<Book>& books;
+        size_t* hashValues = nullptr;
+        size_t* indices = nullptr;
+        size_t tableSize = 0;
+
+        // 旧版 keyOf 按值返回键
+        std::string keyOf(size_t i) const { return books[i].getIsbn(); }
+
+        static size_t customHash(const std::string& str) {
+            size_t hash = 5381;
+            for (char c : str) {
+                hash = ((hash << 5) + hash) + static_cast<unsigned char>(c);
+            }
+            return hash;
+        }
+
+    public:
+        explicit LegacyIsbnIndex(const MyVector<Book>& books) : books(books) {
+            // 旧版容量从 4 开始翻倍，哈希表是容量的两倍
+            size_t capacity = 4;
+            while (capacity < books.getSize()) capacity *= 2;
+            tableSize = capacity * 2;
+            hashValues = new size_t[tableSize];
+            indices = new size_t[tableSize];
+            for (size_t i = 0; i < tableSize; ++i) {
+                hashValues[i] = 0;
+                indices[i] = EMPTY_SLOT;
+            }
+            for (size_t i = 0; i < books.getSize(); ++i) {
+                std::string key = keyOf(i);
+                size_t hashValue = customHash(key);
+                size_t pos = hashValue % tableSize;
+                while (indices[pos] != EMPTY_SLOT) {
+                    pos = (pos + 1) % tableSize;
+                }
+                hashValues[pos] = hashValue;
+                indices[pos] = i;
+            }
+        }
+        ~LegacyIsbnIndex() {
+            delete[] hashValues;
+            delete[] indices;
+        }
+        LegacyIsbnIndex(const LegacyIsbnIndex&) = delete;
+        LegacyIsbnIndex& operator=(const LegacyIsbnIndex&) = delete;
+
+        int hashFindByIsbn(const std::string& isbn) const {
+            size_t targetHash = customHash(isbn);
+            size_t pos = targetHash % tableSize;
+            for (size_t probe = 0; probe < tableSize; ++probe) {
+                if (indices[pos] == EMPTY_SLOT) break;
+                if (hashValues[pos] == targetHash && keyOf(indices[pos]) == isbn) {
+                    return static_cast<int>(indices[pos]);
+                }
+                pos = (pos + 1) % tableSize;
+            }
+            return -1;
+        }
+    };
+
+    struct IsbnOf {
+        const MyVector<Book>* books;
+        const std::string& operator()(uint32_t index) const { return (*books)[index].getIsbn(); }
+    };
+
+    template<typename Func>
+    double nanosPerCall(size_t calls, Func&& func) {
+        auto start = std::chrono::steady_clock::now();
+        func();
+        auto stop = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::nano>(stop - start).count() / static_cast<double>(calls);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200000;
+    if (count == 0) count = 1;
+
+    MyVector<Book> books(count);
+    char isbn[32];
+    for (size_t i = 0; i < count; ++i) {
+        std::snprintf(isbn, sizeof(isbn), "978-7-%09zu", i * 7919 % 1000000007);
+        books.emplace_back(isbn, "title", "author", "publisher", 2000);
+    }
+    // 查询顺序打乱，一半命中一半未命中
+    MyVector<std::string> queries(count * 2);
+    for (size_t i = 0; i < count; ++i) {
+        queries.push_back(books[i].getIsbn());
+        std::snprintf(isbn, sizeof(isbn), "979-7-%09zu", i);
+        queries.push_back(isbn);
+    }
+    std::mt19937 rng(12345);
+    for (size_t i = queries.getSize(); i > 1; --i) {
+        std::swap(queries[i - 1], queries[rng() % i]);
+    }
+
+    LegacyIsbnIndex legacy(books);
+    HashIndex<std::string_view, uint32_t, IsbnOf> index(IsbnOf{&books});
+    index.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        index.insert(books[i].getIsbn(), static_cast<uint32_t>(i));
+    }
+
+    for (size_t i = 0; i < queries.getSize(); ++i) {
+        const uint32_t* found = index.find(queries[i]);
+        int expected = legacy.hashFindByIsbn(queries[i]);
+        if ((found ? static_cast<int>(*found) : -1) != expected) {
+            std::fprintf(stderr, "mismatch for %s\n", queries[i].c_str());
+            return 1;
+        }
+    }
+
+    const int ROUNDS = 5;
+    size_t calls = queries.getSize() * ROUNDS;
+    long long sink = 0;
+    double legacyNanos = nanosPerCall(calls, [&] {
+        for (int r = 0; r < ROUNDS; ++r) {
+            for (size_t i = 0; i < queries.getSize(); ++i) {
+                sink += legacy.hashFindByIsbn(queries[i]);
+            }
+        }
+    });
+    double indexNanos = nanosPerCall(calls, [&] {
+        for (int r = 0; r < ROUNDS; ++r) {
+            for (size_t i = 0; i < queries.getSize(); ++i) {
+                const uint32_t* found = index.find(queries[i]);
+                sink += found ? static_cast<long long>(*found) : -1;
+            }
+        }
+    });
+
+    std::printf("books: %zu, lookups: %zu (half misses)\n", count, calls);
+    std::printf("legacy hashFindByIsbn: %8.1f ns/lookup\n", legacyNanos);
+    std::printf("HashIndex::find:       %8.1f ns/lookup\n", indexNanos);
+    std::printf("checksum: %lld\n", sink);
+    return 0;
+}
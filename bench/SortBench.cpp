@@ -0,0 +1,187 @@
+#include "../include/Book.h"
+#include "../include/MyVector.h"
+#include "../include/Mysort.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+
+/**
+ * @brief MyAlgorithm 排序基准与正确性检查
+ * 对随机、已排序、逆序、大量重复、山峰形五种输入分别运行 sort、stableSort、
+ * parallelSort（固定 4 个线程，单核机器上也走并行归并）、partialSort、nthElement，
+ * 以 std::sort 为参照计时；再按书名排序一批 Book，检查移动交换的路径。
+ * 任一结果不是输入的有序排列、或稳定排序打乱了相等元素的次序时返回 1。
+ * 用法：SortBench [元素数量]，默认 1000000。
+ * @author 陈子涵
+ */
+
+namespace {
+    struct Item {
+        int key = 0;
+        uint32_t seq = 0; //输入中的位置，用于检查稳定性和是否为原输入的排列
+    };
+
+    bool keyLess(const Item& a, const Item& b) { return a.key < b.key; }
+    bool fullLess(const Item& a, const Item& b) { return a.key != b.key ? a.key < b.key : a.seq < b.seq; }
+
+    enum class Pattern { RANDOM, SORTED, REVERSE, DUPLICATES, ORGAN_PIPE };
+    const char* const PATTERN_NAMES[] = {"random", "sorted", "reverse", "duplicates", "organ-pipe"};
+
+    MyVector<Item> makeInput(Pattern pattern, size_t count) {
+        std::mt19937 rng(static_cast<unsigned>(pattern) * 7919 + 1);
+        MyVector<Item> items(count);
+        for (size_t i = 0; i < count; ++i) {
+            Item item;
+            item.seq = static_cast<uint32_t>(i);
+            switch (pattern) {
+            case Pattern::RANDOM:     item.key = static_cast<int>(rng() & 0x7fffffff); break;
+            case Pattern::SORTED:     item.key = static_cast<int>(i); break;
+            case Pattern::REVERSE:    item.key = static_cast<int>(count - i); break;
+            case Pattern::DUPLICATES: item.key = static_cast<int>(rng() % 16); break;
+            case Pattern::ORGAN_PIPE: item.key = static_cast<int>(i < count / 2 ? i : count - i); break;
+            }
+            items.push_back(item);
+        }
+        return items;
+    }
+
+    // 结果须与 std::sort 按 (key, seq) 排出的序列在 key 上一致，且是输入的一个排列
+    bool sameKeysAs(const MyVector<Item>& result, const MyVector<Item>& expected) {
+        if (result.getSize() != expected.getSize()) return false;
+        MyVector<bool> seen(result.getSize());
+        for (size_t i = 0; i < result.getSize(); ++i) {
+            seen.push_back(false);
+        }
+        for (size_t i = 0; i < result.getSize(); ++i) {
+            if (result[i].key != expected[i].key || result[i].seq >= result.getSize() || seen[result[i].seq]) {
+                return false;
+            }
+            seen[result[i].seq] = true;
+        }
+        return true;
+    }
+
+    bool sameItemsAs(const MyVector<Item>& result, const MyVector<Item>& expected) {
+        for (size_t i = 0; i < result.getSize(); ++i) {
+            if (result[i].key != expected[i].key || result[i].seq != expected[i].seq) return false;
+        }
+        return result.getSize() == expected.getSize();
+    }
+
+    template<typename Func>
+    double millisOf(Func&& func) {
+        auto start = std::chrono::steady_clock::now();
+        func();
+        auto stop = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::milli>(stop - start).count();
+    }
+
+    int failures = 0;
+
+    void check(bool ok, const char* what, const char* pattern) {
+        if (!ok) {
+            std::fprintf(stderr, "FAILED: %s on %s input\n", what, pattern);
+            ++failures;
+        }
+    }
+
+    void runPattern(Pattern pattern, size_t count) {
+        const char* name = PATTERN_NAMES[static_cast<int>(pattern)];
+        const MyVector<Item> input = makeInput(pattern, count);
+        MyVector<Item> expected = input;
+        std::sort(&expected[0], &expected[0] + count, fullLess);
+
+        MyVector<Item> work = input;
+        double stdMillis = millisOf([&] { std::sort(&work[0], &work[0] + count, keyLess); });
+
+        work = input;
+        double sortMillis = millisOf([&] { MyAlgorithm::sort(&work[0], count, keyLess); });
+        check(sameKeysAs(work, expected), "sort", name);
+
+        work = input;
+        double stableMillis = millisOf([&] { MyAlgorithm::stableSort(&work[0], count, keyLess); });
+        check(sameItemsAs(work, expected), "stableSort", name);
+
+        work = input;
+        double parallelMillis = millisOf([&] { MyAlgorithm::parallelSort(&work[0], count, keyLess, 4); });
+        check(sameKeysAs(work, expected), "parallelSort", name);
+
+        // 取一页：前 k 个有序，且是最小的 k 个
+        size_t k = count < 100 ? count : 100;
+        work = input;
+        double partialMillis = millisOf([&] { MyAlgorithm::partialSort(&work[0], count, k, keyLess); });
+        bool partialOk = true;
+        for (size_t i = 0; i < k; ++i) {
+            partialOk = partialOk && work[i].key == expected[i].key;
+        }
+        check(partialOk, "partialSort", name);
+
+        size_t nth = count / 2;
+        work = input;
+        double nthMillis = millisOf([&] { MyAlgorithm::nthElement(&work[0], count, nth, keyLess); });
+        bool nthOk = work[nth].key == expected[nth].key;
+        for (size_t i = 0; i < count && nthOk; ++i) {
+            nthOk = i < nth ? work[i].key <= work[nth].key : work[i].key >= work[nth].key;
+        }
+        check(nthOk, "nthElement", name);
+
+        std::printf("%-11s %9.1f %9.1f %11.1f %13.1f %12.1f %11.1f\n", name, stdMillis, sortMillis,
+                    stableMillis, parallelMillis, partialMillis, nthMillis);
+    }
+
+    // 按书名排序整本 Book，书名大量重复，检查不稳定与稳定两条路径
+    void runBooks(size_t count) {
+        std::mt19937 rng(42);
+        MyVector<Book> books(count);
+        for (size_t i = 0; i < count; ++i) {
+            books.emplace_back("isbn" + std::to_string(i), "title" + std::to_string(rng() % 1000),
+                               "author", "publisher", 2000);
+        }
+        auto byTitle = [](const Book& a, const Book& b) { return a.getTitle() < b.getTitle(); };
+
+        MyVector<Book> work = books;
+        double sortMillis = millisOf([&] { MyAlgorithm::sort(&work[0], count, byTitle); });
+        bool ok = true;
+        for (size_t i = 1; i < count; ++i) {
+            ok = ok && !byTitle(work[i], work[i - 1]);
+        }
+        check(ok, "sort", "books");
+
+        work = books;
+        double stableMillis = millisOf([&] { MyAlgorithm::stableSort(&work[0], count, byTitle); });
+        ok = true;
+        for (size_t i = 1; i < count; ++i) {
+            // 同名图书保持原次序，即 ISBN 编号递增
+            ok = ok && !byTitle(work[i], work[i - 1])
+                 && (work[i].getTitle() != work[i - 1].getTitle()
+                     || std::stoul(work[i].getIsbn().substr(4)) > std::stoul(work[i - 1].getIsbn().substr(4)));
+        }
+        check(ok, "stableSort", "books");
+
+        std::printf("%zu books by title: sort %.1f ms, stableSort %.1f ms\n", count, sortMillis, stableMillis);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    if (count < 2) count = 2;
+
+    std::printf("%zu elements, milliseconds\n", count);
+    std::printf("%-11s %9s %9s %11s %13s %12s %11s\n", "input", "std::sort", "sort", "stableSort",
+                "parallelSort", "partialSort", "nthElement");
+    for (Pattern pattern : {Pattern::RANDOM, Pattern::SORTED, Pattern::REVERSE, Pattern::DUPLICATES,
+                            Pattern::ORGAN_PIPE}) {
+        runPattern(pattern, count);
+    }
+    runBooks(count / 10 > 1 ? count / 10 : 2);
+
+    if (failures > 0) {
+        std::fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    return 0;
+}
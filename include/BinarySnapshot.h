@@ -0,0 +1,81 @@
+#ifndef BINARY_SNAPSHOT_H
+#define BINARY_SNAPSHOT_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include "MyVector.h"
+#include "Book.h"
+#include "User.h"
+#include "BorrowRecord.h"
+
+class MappedCatalog;
+
+/**
+ * @brief 二进制快照格式，JSON 之外的另一种存储方式
+ * 文件布局（整数一律小端）：
+ *   文件头 32 字节：魔数 "BMSB"、版本号 u32、数据类型 u32、保留 u32、行数 u64、字符串表字节数 u64
+ *   字符串表：去重后的全部字符串首尾相接，不含结束符
+ *   按列存放的定长字段：字符串列为 N 个 (偏移 u32, 长度 u32)，整数列为 N 个 i32 或 i64
+ *   文件尾 4 字节：此前全部内容的 CRC-32
+ * 列顺序：
+ *   图书     isbn, title, author, publisher (字符串), publishYear, status (i32)
+ *   用户     username, password (字符串), role (i32)
+ *   借阅记录 bookIsbn, username (字符串), id (i32), borrowDate, dueDate, returnDate (i64), isReturned (i32)
+ * 读取时整个文件映射进内存并校验，任何越界或校验失败都视为文件损坏。
+ * 写入先写临时文件再替换，写到一半崩溃不会损坏原文件，已映射旧文件的读者也不受影响。
+ * @author 陈子涵
+ */
+namespace BinarySnapshot {
+    const uint32_t VERSION = 1;
+
+    enum Kind : uint32_t {
+        BOOKS = 1,
+        USERS = 2,
+        BORROW_RECORDS = 3
+    };
+
+    /**
+     * @brief 快照内容的只读视图，不复制数据
+     * 各列按文件中的顺序用 nextColumn 依次取出，字符串以 string_view 指向字符串表，
+     * 快照内存须在视图使用期间保持有效。
+     */
+    class SnapshotView {
+    private:
+        const unsigned char* bytes = nullptr;
+        size_t rowCount = 0;
+        size_t tableSize = 0;
+        size_t cursor = 0; //下一列的起始位置
+        size_t columnsEnd = 0;
+
+    public:
+        /**
+         * @brief 检查文件头和各段长度
+         * @param verifyChecksum 是否校验 CRC，校验需要读遍整个文件
+         */
+        bool open(const unsigned char* data, size_t size, Kind kind, bool verifyChecksum);
+        size_t getRowCount() const { return rowCount; }
+        // 取下一列的起始位置，width 为每行字节数，越界返回 nullptr
+        const unsigned char* nextColumn(size_t width);
+        // 第 row 行的字符串，引用越出字符串表时返回 false
+        bool stringAt(const unsigned char* column, size_t row, std::string_view& value) const;
+        static int32_t int32At(const unsigned char* column, size_t row);
+        static int64_t int64At(const unsigned char* column, size_t row);
+        // 所有列恰好取完，文件没有多余内容
+        bool finished() const { return cursor == columnsEnd; }
+    };
+
+    // 文件名以 .bin 结尾时视为二进制快照
+    bool isBinaryPath(const std::string& path);
+
+    bool saveBooks(const std::string& path, const MyVector<Book>& books);
+    // 写出映射目录的当前内容，含已修改的图书
+    bool saveBooks(const std::string& path, const MappedCatalog& catalog);
+    bool loadBooks(const std::string& path, MyVector<Book>& books);
+    bool saveUsers(const std::string& path, const MyVector<User>& users);
+    bool loadUsers(const std::string& path, MyVector<User>& users);
+    bool saveBorrowRecords(const std::string& path, const MyVector<BorrowRecord>& records);
+    bool loadBorrowRecords(const std::string& path, MyVector<BorrowRecord>& records);
+}
+
+#endif
@@ -6,6 +6,8 @@
 
 // 前向声明
 class QJsonObject;
+class JsonReader;
+class JsonWriter;
 
 class Book {
 private:
@@ -22,10 +24,10 @@ public:
          const std::string& author, const std::string& publisher, 
          int publishYear);
 
-    std::string getIsbn() const;
-    std::string getTitle() const;
-    std::string getAuthor() const;
-    std::string getPublisher() const;
+    const std::string& getIsbn() const;
+    const std::string& getTitle() const;
+    const std::string& getAuthor() const;
+    const std::string& getPublisher() const;
     int getPublishYear() const;
     int getStatus() const;
 
@@ -39,6 +41,9 @@ public:
     // 数据持久化方法
     QJsonObject toJson() const;
     void fromJson(const QJsonObject& json);
+    // 流式读写，readJson 在读到对象的 { 之后调用，读到对应的 } 为止
+    void writeJson(JsonWriter& writer) const;
+    bool readJson(JsonReader& reader);
 };
 
 #endif // BOOK_H 
@@ -0,0 +1,46 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <string_view>
+#include "Book.h"
+#include "MyVector.h"
+
+/**
+ * @brief The BookImporter class 图书导入文件的并行解析
+ * 导入文件每行一本书，格式为 Python 字典：
+ *   {'书名': '...', '作者': '...', '出版社': '...', 'ISBN': '...', '出版年限': 1967}
+ * 文件整体内存映射后按行边界切成若干块，各线程直接在映射内容上解析，
+ * 只在构造 Book 时复制字段；各块结果按文件顺序拼接，由调用方一次性并入 BookManager。
+ * @author 陈子涵
+ */
+class BookImporter {
+public:
+    struct Stats {
+        size_t lineCount = 0; //非空行数
+        size_t bookCount = 0; //解析成功的图书数
+        size_t skippedCount = 0; //格式错误或字段无效而跳过的行数
+    };
+    /**
+     * @brief 进度回调，参数为已处理字节数和总字节数，返回 false 取消导入
+     * 会在工作线程中调用，须线程安全
+     */
+    using Progress = std::function<bool(size_t doneBytes, size_t totalBytes)>;
+
+    /**
+     * @brief 解析一行，不产生中间字符串
+     * 字符串可用单引号或双引号（Python repr 在值含单引号时改用双引号），支持反斜杠转义；
+     * 字段须齐全且非空，出版年限不能为 0（与界面导入的规则一致）
+     */
+    static bool parseLine(std::string_view line, Book& book);
+
+    /**
+     * @brief 并行解析整个文件
+     * @param path 文件路径，本地编码
+     * @param books 输出按文件顺序排列的图书
+     * @param threadCount 线程数，0 表示使用全部硬件线程
+     * @return 文件无法打开或导入被取消时返回 false
+     */
+    static bool parseFile(const std::string& path, MyVector<Book>& books, Stats& stats,
+                          unsigned threadCount = 0, const Progress& progress = nullptr);
+};
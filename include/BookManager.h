@@ -2,8 +2,19 @@
 #define BOOK_MANAGER_H
 
 #include "MyVector.h"
+#include "HashIndex.h"
+#include "InvertedIndex.h"
+#include "PrefixIndex.h"
+#include "YearIndex.h"
+#include "BookQuery.h"
+#include "IdStream.h"
+#include <cstdint>
 #include <memory>
 #include <algorithm>
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <shared_mutex>
 #include "Book.h"
 
 // 前向声明
@@ -22,37 +33,293 @@ enum class SortOrder {
     DESCENDING
 };
 
+// 建有文本索引的字段
+enum class TextField {
+    TITLE,
+    AUTHOR,
+    PUBLISHER
+};
+
+// 提供输入补全的字段，前三项与 TextField 一一对应
+enum class CompletionField {
+    TITLE,
+    AUTHOR,
+    PUBLISHER,
+    ISBN
+};
+
+/**
+ * @brief 图书查询：条件、可选的排序列和条数上限
+ */
+struct BookQuery {
+    QueryCondition where;
+    bool sorted = false;
+    SortBy sortBy = SortBy::TITLE;
+    SortOrder order = SortOrder::ASCENDING;
+    size_t limit = SIZE_MAX; //最多返回的条数
+
+    BookQuery() = default;
+    explicit BookQuery(QueryCondition where) : where(std::move(where)) {}
+    BookQuery& orderBy(SortBy by, SortOrder direction = SortOrder::ASCENDING) {
+        sorted = true;
+        sortBy = by;
+        order = direction;
+        return *this;
+    }
+    BookQuery& take(size_t count) {
+        limit = count;
+        return *this;
+    }
+};
+
+// 多个检索词之间的关系
+enum class TermMatch {
+    ALL, // 包含全部词（AND）
+    ANY  // 包含任一词（OR）
+};
+
+// 批量导入时 ISBN 已存在（或在同一批中重复）的处理方式
+enum class DuplicatePolicy {
+    SKIP,      // 保留已有图书，忽略导入的
+    OVERWRITE, // 用导入的书名、作者、出版社、年份覆盖已有图书，借阅状态不变
+    MERGE      // 只补全已有图书中为空的字段
+};
+
+/**
+ * @brief 批量导入结果统计
+ */
+struct ImportReport {
+    DuplicatePolicy policy = DuplicatePolicy::SKIP;
+    size_t added = 0; //新增的图书
+    size_t skipped = 0; //SKIP 时忽略的重复图书
+    size_t overwritten = 0; //OVERWRITE 时内容有变化的重复图书
+    size_t merged = 0; //MERGE 时补全了字段的重复图书
+    size_t unchanged = 0; //OVERWRITE/MERGE 时内容没有变化的重复图书
+    size_t duplicates() const { return skipped + overwritten + merged + unchanged; }
+};
+
+/**
+ * @brief The CatalogSnapshot class 图书目录某一版本的只读视图
+ * 持有该版本图书数组的引用计数，复制开销与 shared_ptr 相同。
+ * 之后的修改写入新版本，已取得的视图内容不变，遍历时不需要持锁。
+ * @author 陈子涵
+ */
+class CatalogSnapshot {
+private:
+    std::shared_ptr<const MyVector<Book>> books;
+    uint64_t generation = 0;
+
+public:
+    CatalogSnapshot() : books(std::make_shared<const MyVector<Book>>()) {}
+    CatalogSnapshot(std::shared_ptr<const MyVector<Book>> books, uint64_t generation)
+        : books(std::move(books)), generation(generation) {}
+
+    const MyVector<Book>& getBooks() const { return *books; }
+    size_t getBookCount() const { return books->getSize(); }
+    const Book& getBookAt(uint32_t index) const { return (*books)[index]; }
+    // 与 BookManager::getGeneration 同一计数，相等说明视图仍是最新版本
+    uint64_t getGeneration() const { return generation; }
+};
+
+/**
+ * @brief The BookManager class 图书管理模块
+ * 线程安全：查询、排序持共享读锁，可并发执行；增删改、导入、载入持独占写锁。
+ * 载入和导入先在锁外解析文件，只在替换数据时持写锁。
+ * 多版本读取：snapshot() 发布当前版本的只读视图，保存、导出和界面刷新在视图上进行，
+ * 不持锁也不复制图书；写入时若当前版本仍被视图持有，先复制出新版本再修改。
+ * 返回指针或引用的接口（findBookByIsbn、getAllBooks、getBookAt）须在 readLock() 期间使用，
+ * 持锁期间不要再调用本类其他方法（std::shared_mutex 不可重入）。
+ * @author 陈子涵
+ */
 class BookManager {
 private:
-    MyVector<Book> books;
-    void sortBooks(MyVector<Book> &bookList, SortBy sortBy, SortOrder order) const;
+    // 由图书下标取 ISBN，供哈希索引比较键
+    struct IsbnOf {
+        const BookManager* owner;
+        const std::string& operator()(uint32_t index) const { return (*owner->books)[index].getIsbn(); }
+    };
+
+    // 某一列的升序下标，惰性构建，排序字段变动后失效；代数为 0 表示尚未构建
+    struct SortCache {
+        MyVector<uint32_t> order;
+        uint64_t generation = 0;
+        uint64_t selectGeneration = 0; // 该代数已用过一次部分排序
+    };
+    static constexpr size_t SORT_BY_COUNT = 5;
+    static constexpr size_t TEXT_FIELD_COUNT = 3;
+    static constexpr size_t COMPLETION_FIELD_COUNT = 4;
+    // 年份区间不超过这么多个非空桶时，直接归并各桶而不取出下标再排序
+    static constexpr size_t YEAR_MERGE_FANOUT = 32;
+    static constexpr size_t QUERY_CACHE_CAPACITY = 16;
+
+    // 一次查询的完整结果；多个读者可共享同一份下标表
+    struct QueryCacheEntry {
+        std::string key;
+        uint64_t generation = 0;
+        uint64_t lastUsed = 0; //最近一次命中的序号，淘汰最小的
+        std::shared_ptr<const MyVector<uint32_t>> ids;
+    };
+    // 所取位置不超过总数的 1/PARTIAL_SORT_RATIO 时，首次请求只做部分排序
+    static constexpr size_t PARTIAL_SORT_RATIO = 16;
+
+    std::shared_ptr<MyVector<Book>> books; // 当前版本，发布给视图后不再原地修改
+    HashIndex<std::string_view, uint32_t, IsbnOf> isbnIndex; // ISBN -> 下标
+    InvertedIndex tokenIndexes[TEXT_FIELD_COUNT]; // 按 TextField 的分词倒排索引
+    InvertedIndex trigramIndexes[TEXT_FIELD_COUNT]; // 按 TextField 的码点三元组倒排索引，用于子串检索
+    PrefixIndex prefixIndexes[COMPLETION_FIELD_COUNT]; // 按 CompletionField 的前缀索引
+    YearIndex yearIndex; // 出版年份 -> 下标
+    std::atomic<uint64_t> generation{1}; // 每次修改图书数据时递增，不持锁也可读取
+    // 排序缓存用的代数，借还只改状态、不影响任何排序列，不递增它；持有 mutex 时读写
+    uint64_t sortGeneration = 1;
+    mutable std::shared_mutex mutex; // 保护 books 和 isbnIndex
+    // 多个读者可能同时构建排序缓存，缓存另用一把互斥锁，总在 mutex 之后获取
+    mutable std::mutex cacheMutex;
+    mutable SortCache sortCaches[SORT_BY_COUNT]; // 按 SortBy 缓存的排序结果
+    // 查询结果缓存另用一把锁，同样在 mutex 之后获取，与 cacheMutex 不同时持有
+    mutable std::mutex queryCacheMutex;
+    mutable MyVector<QueryCacheEntry> queryCache; // 按 (条件, 排序, 上限) 缓存的查询结果，LRU 淘汰
+    mutable uint64_t queryCacheTick = 0;
+    // 以下私有方法均要求调用方已持有 mutex
+    int indexOfIsbn(const std::string& isbn) const;
+    void markModified() { ++generation; ++sortGeneration; }
+    void markStatusModified() { ++generation; }
+    void detachBooks();
+    void appendBook(const Book& book);
+    /**
+     * @brief 删除一批图书，removed 为升序无重复的下标
+     * 图书数组压紧一次，各索引的下标也只前移一遍；下标即位置，
+     * 每次删除都要扫遍全部索引，批量删除时把代价摊到整批上
+     */
+    void eraseBooks(const MyVector<uint32_t>& removed);
+    void rebuildIndex();
+    static const std::string& fieldText(const Book& book, TextField field);
+    void indexField(TextField field, uint32_t id, std::string_view text);
+    void unindexField(TextField field, uint32_t id, std::string_view text);
+    // 维护文本索引和年份索引
+    void indexBook(uint32_t id, const Book& book);
+    void unindexBook(uint32_t id, const Book& book);
+    // 下标为 id 的图书由 before 改为 after，只更新内容有变化的字段
+    void reindexBook(uint32_t id, const Book& before, const Book& after);
+    static const std::string& completionText(const Book& book, CompletionField field);
+    // 把下标从 from 起的图书加入前缀索引，批量时排序后一次归并
+    void addCompletions(size_t from);
+    void removeCompletions(const Book& book);
+    void updateCompletions(const Book& before, const Book& after);
+    MyVector<uint32_t> searchTokens(TextField field, const std::string& query, TermMatch match) const;
+    bool substringCandidates(TextField field, const std::string& needle,
+                             MyVector<const MyVector<uint32_t>*>& lists) const;
+    // 字段中含有 needle 的图书下标（升序），结果与逐本 std::string::find 相同
+    MyVector<uint32_t> findSubstring(TextField field, const std::string& needle) const;
+    // 查询规划：预估条件命中的图书数，据此挑选走哪个索引
+    size_t estimateMatches(const QueryCondition& condition) const;
+    // 把条件编译成下标流，流中引用 condition，须在其生命期内使用
+    std::unique_ptr<IdStream> planStream(const QueryCondition& condition) const;
+    MyVector<uint32_t> runQuery(const BookQuery& query) const;
+    std::shared_ptr<const MyVector<uint32_t>> cachedQuery(const BookQuery& query) const;
+    MyVector<Book> booksAt(const MyVector<uint32_t>& ids) const;
+    // 还要求持有 cacheMutex
+    const MyVector<uint32_t> &sortedOrder(SortBy sortBy) const;
+    MyVector<uint32_t> sortedPageIndices(SortBy sortBy, SortOrder order, size_t offset, size_t limit) const;
+    CatalogSnapshot currentSnapshot() const { return CatalogSnapshot(books, generation); }
+    static MyVector<uint32_t> sortIndices(const MyVector<Book> &bookList, SortBy sortBy, SortOrder order);
     //bool parseBookLine(const std::string& line, Book& book);
 public:
+    BookManager();
+    BookManager(const BookManager&) = delete;
+    BookManager& operator=(const BookManager&) = delete;
+
     void addBook(const Book &book);
-    void addBookNoRebuild(const Book &book);
-    void rebuildBookHashTable();
     bool updateBook(const std::string& isbn, const Book& updatedBook);
     bool updateBookStatus(const std::string& isbn,int status);
     bool updateBookField(const std::string& isbn, const std::string& field, const std::string& newValue);
     bool removeBook(const std::string &isbn);
+    // 删除多本图书，找不到的 ISBN 忽略，返回实际删除的本数；比逐本 removeBook 少扫 n - 1 遍索引
+    size_t removeBooks(const MyVector<std::string> &isbns);
+    // 调用方须持有 readLock，且不得通过返回的指针修改图书
     Book *findBookByIsbn(const std::string &isbn);
+    // 按 ISBN 取图书副本，不需要调用方持锁
+    bool findBook(const std::string &isbn, Book &book) const;
     const MyVector<Book> &getAllBooks() const;
     MyVector<Book> findBooksByTitle(const std::string &title);
     MyVector<Book> findBooksByAuthor(const std::string &author);
     MyVector<Book> findBooksByPublisher(const std::string &publisher);
+    // 按年份索引取出，同年的图书按目录顺序
     MyVector<Book> findBooksByYear(int year);
+    // 出版年份在 [startYear, endYear] 内的图书，先按年份、同年按目录顺序
     MyVector<Book> findBooksByYearRange(int startYear, int endYear);
+    /**
+     * @brief 按词检索，走倒排索引，不扫描全部图书
+     * query 按与索引相同的规则分词（英文按单词且不区分大小写，汉字按单字），
+     * 各词的倒排表按 match 求交集或并集；没有可用的词时结果为空
+     * @param snapshot 非空时同时取得与这些下标对应的版本
+     * @return 升序的图书下标
+     */
+    MyVector<uint32_t> searchBookIds(TextField field, const std::string& query, TermMatch match = TermMatch::ALL,
+                                     CatalogSnapshot* snapshot = nullptr) const;
+    MyVector<Book> searchBooks(TextField field, const std::string& query, TermMatch match = TermMatch::ALL) const;
+    /**
+     * @brief 输入补全：字段取值以 prefix 开头（忽略 ASCII 大小写）的前 limit 个，去重
+     * 二分定位后顺序取出，耗时与图书总数的对数和 limit 成正比
+     */
+    MyVector<std::string> getCompletions(CompletionField field, const std::string& prefix, size_t limit) const;
+    /**
+     * @brief 组合条件查询
+     * 规划时按索引预估各子条件的命中数：AND 取预估最少的子条件走索引产出候选，
+     * 其余子条件逐本核对；OR 合并各子条件的流，任一子条件需全表扫描时整体扫描；
+     * NOT 和借阅状态没有索引，逐本判断。下标按流逐个产出，不排序时取够 limit 即停。
+     * 排序时命中较多且该列排序缓存有效，则沿缓存的整列顺序挑出命中的图书，否则只排命中的下标。
+     * @param snapshot 非空时同时取得与这些下标对应的版本
+     * @return 不排序时为升序下标，排序时为排好序的下标
+     */
+    MyVector<uint32_t> queryIds(const BookQuery& query, CatalogSnapshot* snapshot = nullptr) const;
+    MyVector<Book> queryBooks(const BookQuery& query) const;
+    /**
+     * @brief 分页取查询结果的第 [offset, offset + count) 条
+     * 完整结果的下标表按 (条件, 排序) 缓存，最近用过的 QUERY_CACHE_CAPACITY 个保留，
+     * 翻页、改每页条数时只切片，O(count)；增删改和借阅状态变化使代数增加，旧结果随之失效
+     * @param total 输出结果总数
+     * @param snapshot 非空时同时取得与这些下标对应的版本
+     */
+    MyVector<uint32_t> getQueryPage(const BookQuery& query, size_t offset, size_t count, size_t& total,
+                                    CatalogSnapshot* snapshot = nullptr) const;
+    // 按下标升序逐本回调命中的图书，回调返回 false 时停止，返回回调的次数；
+    // 回调期间持有读锁，不得调用本类其他方法
+    size_t forEachMatch(const QueryCondition& condition, const std::function<bool(uint32_t, const Book&)>& visit) const;
     MyVector<Book> getSortedBooks(SortBy sortBy, SortOrder order = SortOrder::ASCENDING) const;
+    // 排序后的图书下标，配合 getBookAt 按需取行，不复制图书
+    MyVector<uint32_t> getSortedIndices(SortBy sortBy, SortOrder order = SortOrder::ASCENDING) const;
+    const Book &getBookAt(uint32_t index) const { return (*books)[index]; }
+    /**
+     * @brief 排序后第 [offset, offset + limit) 位的图书下标，命中缓存时为 O(limit)
+     * @param snapshot 非空时同时取得与这些下标对应的版本，可用其 getBookAt 不持锁取行
+     */
+    MyVector<uint32_t> getSortedPageIndices(SortBy sortBy, SortOrder order, size_t offset, size_t limit,
+                                            CatalogSnapshot* snapshot = nullptr) const;
+    // 排序后第 [offset, offset + limit) 位的图书
+    MyVector<Book> getSortedPage(SortBy sortBy, SortOrder order, size_t offset, size_t limit) const;
+    uint64_t getGeneration() const { return generation.load(); }
+    // 当前版本的只读视图，O(1)
+    CatalogSnapshot snapshot() const;
+    // 共享读锁，持有期间可安全使用 findBookByIsbn、getAllBooks、getBookAt 返回的指针和引用
+    std::shared_lock<std::shared_mutex> readLock() const { return std::shared_lock<std::shared_mutex>(mutex); }
     MyVector<Book> sortSearchResults(const MyVector<Book> &searchResults, SortBy sortBy, SortOrder order = SortOrder::ASCENDING) const;
     size_t getBookCount() const;
-    bool importBooksFromFile(const std::string& filename);
+    bool importBooksFromFile(const std::string& filename, DuplicatePolicy policy = DuplicatePolicy::SKIP);
     bool exportBooksToFile(const std::string& filename) const;
     static bool parseBookLine(const std::string& line, Book& book);
-    void addBooks(const MyVector<Book>& books);
+    /**
+     * @brief 整批导入图书（如并行导入的结果）
+     * 逐本通过 ISBN 索引查重，新图书追加并登记到索引，重复的按 policy 处理；
+     * 同一批中重复的 ISBN 与先导入的那本比较。重复导入同一文件不会使图书增多。
+     */
+    ImportReport importBooks(MyVector<Book>&& batch, DuplicatePolicy policy);
     
     // 数据持久化方法
     bool saveToFile(const QString& filename) const;
     bool loadFromFile(const QString& filename);
+    // 二进制快照，路径为本地编码
+    bool saveToBinaryFile(const std::string& filename) const;
+    bool loadFromBinaryFile(const std::string& filename);
 };
 
 #endif // BOOK_MANAGER_H 
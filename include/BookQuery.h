@@ -0,0 +1,68 @@
+#pragma once
+#include <string>
+#include "MyVector.h"
+#include "Book.h"
+
+/**
+ * @brief The QueryCondition class 图书查询条件
+ * 由字段谓词（子串、精确匹配、出版年份区间、借阅状态）经 AND / OR / NOT 组合成树，
+ * 按值复制。条件本身只描述要什么，matches 逐本判断；走哪个索引由 BookManager 的查询规划决定。
+ * 默认构造的条件匹配全部图书。
+ * @author 陈子涵
+ */
+class QueryCondition {
+public:
+    enum class Kind {
+        ALL,        // 全部图书
+        CONTAINS,   // 字段含子串
+        EQUALS,     // 字段等于
+        YEAR_RANGE, // 出版年份在 [low, high] 内
+        STATUS,     // 借阅状态等于 low
+        AND,
+        OR,
+        NOT
+    };
+    // 前三项与 TextField 一一对应
+    enum class Field {
+        TITLE,
+        AUTHOR,
+        PUBLISHER,
+        ISBN
+    };
+
+private:
+    Kind kind = Kind::ALL;
+    Field field = Field::TITLE;
+    std::string text;
+    int low = 0;
+    int high = 0;
+    MyVector<QueryCondition> children; //AND、OR、NOT 的子条件
+
+    // 组合两个条件，同类的子树展开到同一层
+    static QueryCondition combine(Kind kind, QueryCondition a, QueryCondition b);
+
+public:
+    QueryCondition() = default;
+
+    static QueryCondition contains(Field field, const std::string& text);
+    static QueryCondition equals(Field field, const std::string& text);
+    static QueryCondition yearBetween(int from, int to);
+    static QueryCondition statusIs(int status);
+
+    friend QueryCondition operator&&(QueryCondition a, QueryCondition b) { return combine(Kind::AND, std::move(a), std::move(b)); }
+    friend QueryCondition operator||(QueryCondition a, QueryCondition b) { return combine(Kind::OR, std::move(a), std::move(b)); }
+    friend QueryCondition operator!(QueryCondition a);
+
+    Kind getKind() const { return kind; }
+    Field getField() const { return field; }
+    const std::string& getText() const { return text; }
+    int getLow() const { return low; }
+    int getHigh() const { return high; }
+    const MyVector<QueryCondition>& getChildren() const { return children; }
+
+    // 逐本判断是否满足条件
+    bool matches(const Book& book) const;
+    // 把条件树序列化追加到 out，结构和内容相同的条件得到相同的串，用作缓存键
+    void appendKey(std::string& out) const;
+    static const std::string& fieldValue(const Book& book, Field field);
+};
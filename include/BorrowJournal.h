@@ -0,0 +1,73 @@
+#ifndef BORROW_JOURNAL_H
+#define BORROW_JOURNAL_H
+
+#include <cstdio>
+#include <ctime>
+#include <string>
+#include "MyVector.h"
+
+/**
+ * @brief 借阅日志条目，一次借阅/归还/续借/排队变动
+ */
+struct JournalEntry {
+    enum Type : char {
+        BORROW = 'B',  // 新增借阅记录：recordId, isbn, username, time1=借出时间, time2=应还时间
+        RETURN = 'R',  // 归还：recordId, time1=归还时间
+        RENEW = 'N',   // 续借：recordId, time1=新的应还时间
+        ENQUEUE = 'E', // 加入等待队列：isbn, username
+        DEQUEUE = 'D'  // 队首出队：isbn, username
+    };
+    Type type = BORROW;
+    int recordId = 0;
+    std::string isbn;
+    std::string username;
+    time_t time1 = 0;
+    time_t time2 = 0;
+};
+
+/**
+ * @brief The BorrowJournal class 借阅变动的追加式日志
+ * 每个条目占一行，行尾带 CRC-32，读取时遇到校验失败或不完整的行即视为崩溃留下的残尾。
+ * append 只写入内存缓冲，commit 时一次写出并落盘（组提交），
+ * 一次操作连带产生的多条变动（如归还后自动为排队用户借阅）只同步一次磁盘。
+ * 快照写完后调用 reset 清空日志。
+ * @author 陈子涵
+ */
+class BorrowJournal {
+private:
+    std::FILE* file = nullptr;
+    std::string path;
+    std::string buffer; //尚未提交的条目
+    size_t entryCount = 0; //自上次快照以来的条目数
+
+public:
+    BorrowJournal() = default;
+    ~BorrowJournal();
+    BorrowJournal(const BorrowJournal&) = delete;
+    BorrowJournal& operator=(const BorrowJournal&) = delete;
+
+    /**
+     * @brief 读取日志中的全部有效条目
+     * @param validBytes 输出有效部分的字节数，之后的内容为残尾
+     * @return 文件不存在时返回 true 且条目为空；读取失败返回 false
+     */
+    static bool readAll(const std::string& path, MyVector<JournalEntry>& entries, size_t& validBytes);
+
+    /**
+     * @brief 以追加方式打开日志
+     * @param validBytes 有效部分的字节数，之后的残尾会被截掉
+     * @param existingEntries 日志中已有的条目数
+     */
+    bool open(const std::string& path, size_t validBytes, size_t existingEntries);
+    void close();
+    bool isOpen() const { return file != nullptr; }
+
+    void append(const JournalEntry& entry);
+    // 写出缓冲中的条目并同步到磁盘
+    bool commit();
+    // 快照写完后清空日志
+    bool reset();
+    size_t getEntryCount() const { return entryCount; }
+};
+
+#endif
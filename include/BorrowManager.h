@@ -2,11 +2,16 @@
 #define BORROW_MANAGER_H
 
 #include "MyVector.h"
+#include "HashIndex.h"
+#include "GroupIndex.h"
 #include "BorrowRecord.h"
 #include "BookManager.h"
 #include "User.h"
 #include "MyQueue.h"
+#include "BorrowJournal.h"
+#include <cstdint>
 #include <map>
+#include <shared_mutex>
 
 // 前向声明
 class QString;
@@ -27,20 +32,115 @@ enum class BorrowSortOrder {
     DESCENDING
 };
 
+/**
+ * @brief The BorrowManager class 借阅管理模块
+ * 线程安全：查询和保存持共享读锁，借还、续借、载入、日志操作持独占写锁。
+ * 加锁顺序固定为本类在前、BookManager / UserManager 在后，它们不会反过来调用本类。
+ * 返回指针或引用的接口（getAllBorrowRecords、getRecordAt、findActiveLoanByIsbn、findRecordById）
+ * 须在 readLock() 期间使用，持锁期间不要再调用本类其他方法。
+ * @author 陈子涵
+ */
 class BorrowManager {
 private:
+    // 借阅关系键：(ISBN, 用户名)
+    struct LoanKey {
+        std::string_view isbn;
+        std::string_view username;
+        bool operator==(const LoanKey& other) const { return isbn == other.isbn && username == other.username; }
+    };
+    struct LoanKeyHash {
+        size_t operator()(const LoanKey& key) const {
+            DJB2Hash hash;
+            return hash(key.isbn) * 31 + hash(key.username);
+        }
+    };
+    struct LoanKeyOf {
+        const BorrowManager* owner;
+        LoanKey operator()(uint32_t index) const {
+            const BorrowRecord& record = owner->records[index];
+            return LoanKey{record.getIsbn(), record.getUsername()};
+        }
+    };
+    // 由记录下标取 ISBN / 用户名
+    struct RecordIsbnOf {
+        const BorrowManager* owner;
+        const std::string& operator()(uint32_t index) const { return owner->records[index].getIsbn(); }
+    };
+    struct RecordUsernameOf {
+        const BorrowManager* owner;
+        const std::string& operator()(uint32_t index) const { return owner->records[index].getUsername(); }
+    };
+    // 由记录下标取编号，供稀疏编号的哈希表使用
+    struct RecordIdOf {
+        const BorrowManager* owner;
+        int operator()(uint32_t index) const { return owner->records[index].getId(); }
+    };
+    struct RecordIdHash {
+        size_t operator()(int id) const { return static_cast<size_t>(id) * 0x9E3779B1u; }
+    };
+
     MyVector<BorrowRecord> records;
+    // 记录编号由 BorrowRecord::nextId 递增分配，通常直接用稠密数组做 编号 -> 下标；
+    // 数组长度不超过记录数的 DENSE_ID_FACTOR 倍（另加 DENSE_ID_SLACK），
+    // 手工编辑或损坏文件中远超此范围的编号改放哈希表，避免按最大编号分配内存
+    static constexpr uint32_t NO_SLOT = UINT32_MAX;
+    static constexpr size_t DENSE_ID_FACTOR = 4;
+    static constexpr size_t DENSE_ID_SLACK = 1024;
+    MyVector<uint32_t> slotOfId;
+    HashIndex<int, uint32_t, RecordIdOf, RecordIdHash> sparseIdIndex; // 稠密数组之外的 编号 -> 下标
+    HashIndex<LoanKey, uint32_t, LoanKeyOf, LoanKeyHash> activeLoanIndex; // (ISBN, 用户名) -> 未归还记录下标
+    HashIndex<std::string_view, uint32_t, RecordIsbnOf> activeIsbnIndex; // ISBN -> 未归还记录下标
+    GroupIndex<std::string_view, RecordIsbnOf> isbnGroups; // ISBN -> 全部记录下标
+    GroupIndex<std::string_view, RecordUsernameOf> usernameGroups; // 用户名 -> 全部记录下标
     BookManager* bookManager;
     UserManager* userManager;
     static const int DEFAULT_BORROW_DAYS = 30;
     // 新增：等待队列，key为isbn，value为用户名队列
     std::map<std::string, MyQueue<std::string>> waitingQueues;
+
+    // 变动日志：每次操作只追加变动条目，条目数达到阈值时写快照并清空日志
+    static const size_t COMPACT_THRESHOLD = 4096;
+    BorrowJournal journal;
+    std::string snapshotPath; // 快照文件，UTF-8
+    std::string queuePath; // 等待队列文件，UTF-8
+    std::string journalPath; // 日志文件，本地编码
+    int changeDepth = 0; // 嵌套操作计数，最外层操作结束时才提交
+    bool journalBroken = false; // 日志写入失败且快照尚未写成，此时日志末尾可能残缺
+    class ChangeScope;
+    mutable std::shared_mutex mutex; // 保护以上全部状态
     
+    // 以下私有方法均要求调用方已持有 mutex（静态方法除外）
+    void addRecord(const BorrowRecord& record);
+    void indexRecord(uint32_t index);
+    void rebuildIndex();
+    int slotOfRecordId(int recordId) const;
+    int findActiveLoan(const std::string& isbn, const std::string& username) const;
+    void markReturned(uint32_t index, time_t returnDate);
+    void returnRecord(uint32_t index);
+    void renewRecord(uint32_t index);
+    void serveWaitingQueue(const std::string& isbn);
+    bool commitChanges();
+    void applyJournalEntry(const JournalEntry& entry);
+    MyVector<BorrowRecord> collect(const MyVector<uint32_t>* indices) const;
+    bool borrowUnlocked(const std::string& isbn, const std::string& username);
+    bool reloadUnlocked();
+    bool compactUnlocked();
+    bool loadSnapshot();
+    bool writeRecords(const QString& filename) const;
+    bool writeBinaryRecords(const std::string& filename) const;
+    bool writeQueues(const QString& filename) const;
+    // 解析文件，不涉及成员状态，可在锁外执行
+    static bool readRecords(const QString& filename, MyVector<BorrowRecord>& loaded);
+    static bool readBinaryRecords(const std::string& filename, MyVector<BorrowRecord>& loaded);
+    static bool readQueues(const QString& filename, std::map<std::string, MyQueue<std::string>>& queues);
+
     // 排序辅助方法
-    void sortBorrowRecords(MyVector<BorrowRecord> &recordList, BorrowSortBy sortBy, BorrowSortOrder order) const;
+    static MyVector<uint32_t> sortIndices(const MyVector<BorrowRecord> &recordList, BorrowSortBy sortBy, BorrowSortOrder order);
     
 public:
     BorrowManager(BookManager* bookManager, UserManager* userManager);
+    BorrowManager(const BorrowManager&) = delete;
+    BorrowManager& operator=(const BorrowManager&) = delete;
     bool borrowBook(const std::string& isbn, const std::string& username);
     bool returnBook(const std::string& isbn, const std::string& username);
     bool renewBook(const std::string& isbn, const std::string& username);
@@ -48,7 +148,7 @@ public:
     // 通过ID操作的方法
     void returnBook(int recordId);
     void renewBook(int recordId);
-    bool returnBookByRecordId(const std::string& recordId);
+    bool returnBookByRecordId(int recordId);
     
     MyVector<BorrowRecord> getUserBorrowRecords(const std::string& username);
     MyVector<BorrowRecord> getBookBorrowRecords(const std::string& isbn);
@@ -56,9 +156,15 @@ public:
     const MyVector<BorrowRecord>& getAllBorrowRecords() const { return records; }
     size_t getBorrowCount(const std::string& username) const;
     size_t getOverdueCount(const std::string& username) const;
+    // 某本书当前未归还的借阅记录，没有则返回 nullptr；调用方须持有 readLock
+    const BorrowRecord* findActiveLoanByIsbn(const std::string& isbn) const;
+    // 按记录编号 O(1) 取记录，没有则返回 nullptr；调用方须持有 readLock
+    const BorrowRecord* findRecordById(int recordId) const;
+    // 共享读锁，持有期间可安全使用 getAllBorrowRecords、getRecordAt、findActiveLoanByIsbn、findRecordById 返回的引用和指针
+    std::shared_lock<std::shared_mutex> readLock() const { return std::shared_lock<std::shared_mutex>(mutex); }
 
     //查找方法
-    BorrowRecord *findByRecordId(MyVector<BorrowRecord> &record, const std::string& recordId);
+    BorrowRecord *findByRecordId(MyVector<BorrowRecord> &record, int recordId);
     MyVector<BorrowRecord> findByISBN(MyVector<BorrowRecord> &record, const std::string& ISBN);
     MyVector<BorrowRecord> findByUsername(MyVector<BorrowRecord> &record, const std::string& username);
     MyVector<BorrowRecord> findByBorrowDate(MyVector<BorrowRecord> &record, const std::string& borrowDate);
@@ -68,16 +174,35 @@ public:
     
     // 排序方法
     MyVector<BorrowRecord> getSortedBorrowRecords(BorrowSortBy sortBy, BorrowSortOrder order = BorrowSortOrder::ASCENDING) const;
+    // 排序后的记录下标，配合 getRecordAt 按需取行，不复制记录
+    MyVector<uint32_t> getSortedRecordIndices(BorrowSortBy sortBy, BorrowSortOrder order = BorrowSortOrder::ASCENDING) const;
+    const BorrowRecord& getRecordAt(uint32_t index) const { return records[index]; }
+    // 排序后第 [offset, offset + limit) 位的记录，只做部分排序，O(N log limit)
+    MyVector<BorrowRecord> getSortedPage(BorrowSortBy sortBy, BorrowSortOrder order, size_t offset, size_t limit) const;
     MyVector<BorrowRecord> sortSearchResults(const MyVector<BorrowRecord> &searchResults, BorrowSortBy sortBy, BorrowSortOrder order = BorrowSortOrder::ASCENDING) const;
     
     // 数据持久化方法
     bool saveToFile(const QString& filename) const;
     bool loadFromFile(const QString& filename);
+    // 二进制快照，路径为本地编码
+    bool saveToBinaryFile(const std::string& filename) const;
+    bool loadFromBinaryFile(const std::string& filename);
+
+    /**
+     * @brief 以"快照 + 日志"方式打开存储
+     * 载入快照和等待队列，重放日志尾部，之后的变动只追加到日志
+     * 快照文件名以 .bin 结尾时使用二进制快照
+     */
+    bool openJournal(const QString& snapshotPath, const QString& queuePath, const QString& journalPath);
+    // 重新载入快照并重放日志
+    bool reloadFromJournal();
+    // 写出快照并清空日志
+    bool compact();
 
     // 新增：等待队列相关
     int getWaitingCount(const std::string& isbn) const;
     bool isUserInQueue(const std::string& isbn, const std::string& username) const;
-    void saveWaitingQueues(const QString& filename) const;
+    bool saveWaitingQueues(const QString& filename) const;
     bool loadWaitingQueues(const QString& filename);
 };
 
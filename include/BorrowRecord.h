@@ -3,11 +3,14 @@
 
 #include <string>
 #include <ctime>
+#include <climits>
 #include "Book.h"
 #include "User.h"
 
 // 前向声明
 class QJsonObject;
+class JsonReader;
+class JsonWriter;
 
 class BorrowRecord {
 private:
@@ -24,14 +27,20 @@ public:
                 const std::string& username,
                 time_t borrowDate,
                 time_t dueDate);
+    // 以指定编号构造，用于从日志恢复；同时推进 nextId 保证编号唯一
+    BorrowRecord(int id,
+                const std::string& bookIsbn,
+                const std::string& username,
+                time_t borrowDate,
+                time_t dueDate);
     BorrowRecord() : id(0), borrowDate(0), dueDate(0), returnDate(0), isReturned(false) {}
     
     // 获取方法
     int getId() const;
     std::string getRecordId() const;
-    std::string getIsbn() const;
-    std::string getBookIsbn() const;
-    std::string getUsername() const;
+    const std::string& getIsbn() const;
+    const std::string& getBookIsbn() const;
+    const std::string& getUsername() const;
     time_t getBorrowDate() const;
     time_t getDueDate() const;
     time_t getReturnDate() const;
@@ -42,6 +51,14 @@ public:
     std::string getDueDateStr() const;
     std::string getReturnDateStr() const;
     std::string getStatus() const;
+
+    // 记录编号与界面显示的 "REC000001" 形式互转，只在界面边界使用
+    static std::string formatRecordId(int id);
+    // 接受 "REC000001" 或纯数字，格式错误返回 -1
+    static int parseRecordId(const std::string& recordId);
+    // 文件中读到的编号须在此范围内，上限留出一位保证 nextId 递增不溢出
+    static constexpr long long MAX_ID = INT_MAX - 1;
+    static bool isValidId(long long id) { return id >= 0 && id <= MAX_ID; }
     
     // 设置方法
     void setDueDate(time_t date);
@@ -51,6 +68,9 @@ public:
     // 数据持久化方法
     QJsonObject toJson() const;
     void fromJson(const QJsonObject& json);
+    // 流式读写，readJson 在读到对象的 { 之后调用，读到对应的 } 为止
+    void writeJson(JsonWriter& writer) const;
+    bool readJson(JsonReader& reader);
 };
 
 #endif 
\ No newline at end of file
@@ -0,0 +1,40 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief CRC-32 校验（IEEE 802.3 多项式，与 zlib 的 crc32 结果一致）
+ * 用于日志条目和快照文件的完整性校验。可分段计算：把上一段的结果作为 crc 传入。
+ * @author 陈子涵
+ */
+namespace Checksum {
+    namespace detail {
+        struct Crc32Table {
+            uint32_t entries[256];
+            Crc32Table() {
+                for (uint32_t i = 0; i < 256; ++i) {
+                    uint32_t value = i;
+                    for (int bit = 0; bit < 8; ++bit) {
+                        value = (value & 1) ? (0xEDB88320u ^ (value >> 1)) : (value >> 1);
+                    }
+                    entries[i] = value;
+                }
+            }
+        };
+
+        inline const Crc32Table& crc32Table() {
+            static const Crc32Table table;
+            return table;
+        }
+    }
+
+    inline uint32_t crc32(const void* data, size_t length, uint32_t crc = 0) {
+        const uint32_t* table = detail::crc32Table().entries;
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        crc = ~crc;
+        for (size_t i = 0; i < length; ++i) {
+            crc = table[(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
+        }
+        return ~crc;
+    }
+}
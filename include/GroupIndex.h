@@ -0,0 +1,67 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include "MyVector.h"
+#include "HashIndex.h"
+
+/**
+ * @brief The GroupIndex class 一对多哈希索引
+ * 同一键下的全部元素下标按插入顺序存成一个分组；分组的键由其首个元素经 KeyOf 取回，
+ * 索引本身不复制键。适合只追加的容器，如借阅记录按 ISBN / 用户名分组。
+ * @tparam K 查找键类型，需能与 KeyOf 的返回值做 == 比较
+ * @tparam KeyOf 由元素下标取键的函数对象
+ * @tparam Hash 作用于 K 的哈希函数对象
+ * @author 陈子涵
+ */
+template<typename K, typename KeyOf, typename Hash = DJB2Hash>
+class GroupIndex {
+private:
+    // 由分组编号取键：取该分组首个元素的键
+    struct GroupKeyOf {
+        const GroupIndex* owner;
+        decltype(auto) operator()(uint32_t group) const { return owner->keyOf(owner->groups[group][0]); }
+    };
+
+    KeyOf keyOf; //由元素下标取键
+    MyVector<MyVector<uint32_t>> groups; //各分组的元素下标
+    HashIndex<K, uint32_t, GroupKeyOf, Hash> groupIndex; //键 -> 分组编号
+
+public:
+    explicit GroupIndex(KeyOf keyOf = KeyOf(), Hash hasher = Hash())
+        : keyOf(std::move(keyOf)), groupIndex(GroupKeyOf{this}, std::move(hasher)) {}
+
+    // 分组引用自身，禁止拷贝
+    GroupIndex(const GroupIndex&) = delete;
+    GroupIndex& operator=(const GroupIndex&) = delete;
+
+    // 将元素下标追加到键所在的分组，分组不存在时新建
+    void add(const K& key, uint32_t value) {
+        const uint32_t* group = groupIndex.find(key);
+        if (group) {
+            groups[*group].push_back(value);
+            return;
+        }
+        groups.emplace_back().push_back(value);
+        groupIndex.insert(key, static_cast<uint32_t>(groups.getSize() - 1));
+    }
+
+    // 查找键对应的分组，未找到返回 nullptr
+    const MyVector<uint32_t>* find(const K& key) const {
+        const uint32_t* group = groupIndex.find(key);
+        return group ? &groups[*group] : nullptr;
+    }
+
+    // 键对应的元素个数
+    size_t count(const K& key) const {
+        const MyVector<uint32_t>* group = find(key);
+        return group ? group->getSize() : 0;
+    }
+
+    void clear() {
+        groupIndex.clear();
+        groups.clear();
+    }
+
+    // 不同键的数量
+    size_t size() const { return groups.getSize(); }
+};
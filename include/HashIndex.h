@@ -0,0 +1,180 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <utility>
+
+/**
+ * @brief DJB2 字符串哈希
+ */
+struct DJB2Hash {
+    size_t operator()(std::string_view str) const {
+        size_t hash = 5381;
+        for (char c : str) {
+            hash = ((hash << 5) + hash) + static_cast<unsigned char>(c);
+        }
+        return hash;
+    }
+};
+
+/**
+ * @brief The HashIndex class 开放寻址哈希索引
+ * 槽位只保存 (哈希值, 值, 状态)，连续存放；键通过 KeyOf 由值取回后比较，
+ * 索引本身不复制键。线性探测，删除使用墓碑，装载率超过一半时扩容重哈希。
+ * @tparam K 查找键类型，需能与 KeyOf 的返回值做 == 比较
+ * @tparam V 值类型，通常是元素在容器中的下标
+ * @tparam KeyOf 由值取键的函数对象
+ * @tparam Hash 作用于 K 的哈希函数对象
+ * @author 陈子涵
+ */
+template<typename K, typename V, typename KeyOf, typename Hash = DJB2Hash>
+class HashIndex {
+private:
+    enum SlotState : unsigned char { EMPTY = 0, USED = 1, DELETED = 2 };
+    struct Slot {
+        size_t hash;
+        V value;
+        SlotState state;
+    };
+
+    static constexpr size_t NPOS = static_cast<size_t>(-1);
+    static constexpr size_t MIN_SLOTS = 16;
+
+    Slot* slots = nullptr; //槽位数组
+    size_t slotCount = 0; //槽位数，始终为 2 的幂
+    size_t count = 0; //有效键数量
+    size_t tombstones = 0; //墓碑数量
+    KeyOf keyOf; //由值取键
+    Hash hasher; //哈希函数
+
+    static size_t roundUpPow2(size_t n) {
+        size_t p = MIN_SLOTS;
+        while (p < n) p <<= 1;
+        return p;
+    }
+
+    // 重新分配槽位并按已存哈希值回填，不需要再次取键
+    void rehash(size_t newSlotCount) {
+        Slot* old = slots;
+        size_t oldCount = slotCount;
+        slots = new Slot[newSlotCount];
+        slotCount = newSlotCount;
+        for (size_t i = 0; i < slotCount; ++i) {
+            slots[i].state = EMPTY;
+        }
+        tombstones = 0;
+        for (size_t i = 0; i < oldCount; ++i) {
+            if (old[i].state != USED) continue;
+            size_t pos = old[i].hash & (slotCount - 1);
+            while (slots[pos].state != EMPTY) {
+                pos = (pos + 1) & (slotCount - 1);
+            }
+            slots[pos] = old[i];
+        }
+        delete[] old;
+    }
+
+    // 查找键所在槽位，未找到返回 NPOS
+    size_t findPos(const K& key, size_t hash) const {
+        if (slotCount == 0) return NPOS;
+        size_t pos = hash & (slotCount - 1);
+        for (size_t probe = 0; probe < slotCount; ++probe) {
+            const Slot& slot = slots[pos];
+            if (slot.state == EMPTY) break;
+            if (slot.state == USED && slot.hash == hash && keyOf(slot.value) == key) {
+                return pos;
+            }
+            pos = (pos + 1) & (slotCount - 1);
+        }
+        return NPOS;
+    }
+
+public:
+    explicit HashIndex(KeyOf keyOf = KeyOf(), Hash hasher = Hash())
+        : keyOf(std::move(keyOf)), hasher(std::move(hasher)) {}
+    ~HashIndex() { delete[] slots; }
+
+    // 索引依赖外部容器，禁止拷贝
+    HashIndex(const HashIndex&) = delete;
+    HashIndex& operator=(const HashIndex&) = delete;
+
+    // 预留可容纳 n 个键的空间
+    void reserve(size_t n) {
+        size_t wanted = roundUpPow2(n * 2 + 1);
+        if (wanted > slotCount) {
+            rehash(wanted);
+        }
+    }
+
+    /**
+     * @brief 插入或覆盖
+     * @return 键原先不存在时返回 true；已存在时覆盖其值并返回 false
+     */
+    bool insert(const K& key, const V& value) {
+        if ((count + tombstones + 1) * 2 > slotCount) {
+            rehash(roundUpPow2((count + 1) * 4));
+        }
+        size_t hash = hasher(key);
+        size_t pos = hash & (slotCount - 1);
+        size_t firstDeleted = NPOS;
+        while (slots[pos].state != EMPTY) {
+            Slot& slot = slots[pos];
+            if (slot.state == DELETED) {
+                if (firstDeleted == NPOS) firstDeleted = pos;
+            } else if (slot.hash == hash && keyOf(slot.value) == key) {
+                slot.value = value;
+                return false;
+            }
+            pos = (pos + 1) & (slotCount - 1);
+        }
+        if (firstDeleted != NPOS) {
+            pos = firstDeleted;
+            --tombstones;
+        }
+        slots[pos].hash = hash;
+        slots[pos].value = value;
+        slots[pos].state = USED;
+        ++count;
+        return true;
+    }
+
+    // 查找键，返回值指针，未找到返回 nullptr
+    const V* find(const K& key) const {
+        size_t pos = findPos(key, hasher(key));
+        return pos == NPOS ? nullptr : &slots[pos].value;
+    }
+
+    bool contains(const K& key) const { return find(key) != nullptr; }
+
+    // 删除键，槽位标记为墓碑
+    bool erase(const K& key) {
+        size_t pos = findPos(key, hasher(key));
+        if (pos == NPOS) return false;
+        slots[pos].state = DELETED;
+        --count;
+        ++tombstones;
+        return true;
+    }
+
+    // 对每个有效值调用 func(V&)，用于容器元素移动后批量修正下标
+    template<typename Func>
+    void updateValues(Func func) {
+        for (size_t i = 0; i < slotCount; ++i) {
+            if (slots[i].state == USED) {
+                func(slots[i].value);
+            }
+        }
+    }
+
+    // 清空所有键，保留已分配的槽位
+    void clear() {
+        for (size_t i = 0; i < slotCount; ++i) {
+            slots[i].state = EMPTY;
+        }
+        count = 0;
+        tombstones = 0;
+    }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+};
@@ -0,0 +1,77 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include "MyVector.h"
+
+/**
+ * @brief The IdStream class 按升序逐个产出图书下标的惰性流
+ * 查询规划把条件树编译成流的组合，取结果时才向下游要下一个下标，
+ * 中间结果不落成数组，取够条数即可停止。
+ * 只有一个操作 seek(target)：返回第一个不小于 target 的下标，target 须单调不减。
+ * @author 陈子涵
+ */
+class IdStream {
+public:
+    static constexpr uint32_t END = UINT32_MAX; //流已结束
+
+    virtual ~IdStream() = default;
+    virtual uint32_t seek(uint32_t target) = 0;
+};
+
+// 遍历一张升序下标表，表可以借用索引中的倒排表，也可以自带
+class ListStream : public IdStream {
+private:
+    MyVector<uint32_t> owned;
+    const MyVector<uint32_t>* list;
+    size_t position = 0;
+
+public:
+    explicit ListStream(const MyVector<uint32_t>* list) : list(list) {}
+    explicit ListStream(MyVector<uint32_t>&& ids) : owned(std::move(ids)), list(&owned) {}
+    uint32_t seek(uint32_t target) override;
+};
+
+// [0, total) 内的全部下标，即全表扫描
+class RangeStream : public IdStream {
+private:
+    uint32_t total;
+
+public:
+    explicit RangeStream(size_t total) : total(static_cast<uint32_t>(total)) {}
+    uint32_t seek(uint32_t target) override { return target < total ? target : END; }
+};
+
+// 各子流的交集：第一个子流给出候选，其余子流跳到候选处确认
+class AndStream : public IdStream {
+private:
+    MyVector<std::unique_ptr<IdStream>> streams;
+
+public:
+    // streams 不能为空，应按预估结果数从少到多排列
+    explicit AndStream(MyVector<std::unique_ptr<IdStream>>&& streams) : streams(std::move(streams)) {}
+    uint32_t seek(uint32_t target) override;
+};
+
+// 各子流的并集，去重
+class OrStream : public IdStream {
+private:
+    MyVector<std::unique_ptr<IdStream>> streams;
+    MyVector<uint32_t> heads; //各子流当前的下标
+
+public:
+    explicit OrStream(MyVector<std::unique_ptr<IdStream>>&& streams);
+    uint32_t seek(uint32_t target) override;
+};
+
+// 只保留 keep 返回 true 的下标
+class FilterStream : public IdStream {
+private:
+    std::unique_ptr<IdStream> source;
+    std::function<bool(uint32_t)> keep;
+
+public:
+    FilterStream(std::unique_ptr<IdStream> source, std::function<bool(uint32_t)> keep)
+        : source(std::move(source)), keep(std::move(keep)) {}
+    uint32_t seek(uint32_t target) override;
+};
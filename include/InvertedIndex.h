@@ -0,0 +1,57 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include "MyVector.h"
+#include "HashIndex.h"
+
+/**
+ * @brief The InvertedIndex class 倒排索引：词 -> 含该词的文档下标表
+ * 每个词的下标表（倒排表）保持升序且无重复，检索时对多张表求交集或并集。
+ * 文档下标即图书在 BookManager 中的位置；删除文档后调用 shiftDown，
+ * 使大于它的下标统一减一，与图书数组的前移保持一致。
+ * 下标随位置变化，检索时不必跳过已删除的文档，代价是每次删除都要扫一遍全部倒排表，
+ * 为 O(倒排表总长)；删除多本时应一次传入全部下标，只扫一遍。
+ * 词只增不删，倒排表为空的词保留在词典中。
+ * @author 陈子涵
+ */
+class InvertedIndex {
+private:
+    struct Term {
+        std::string text;
+        MyVector<uint32_t> postings;
+    };
+    // 由词的位置取词文本，供哈希索引比较键
+    struct TermTextOf {
+        const InvertedIndex* owner;
+        const std::string& operator()(uint32_t slot) const { return owner->terms[slot].text; }
+    };
+
+    MyVector<Term> terms;
+    HashIndex<std::string_view, uint32_t, TermTextOf> termIndex; // 词 -> terms 中的位置
+    size_t postingCount = 0; //全部倒排表的元素总数
+
+public:
+    InvertedIndex();
+    InvertedIndex(const InvertedIndex&) = delete;
+    InvertedIndex& operator=(const InvertedIndex&) = delete;
+
+    void clear();
+    // 把 id 加入 term 的倒排表，已存在时忽略；id 不小于表中全部下标时为 O(1)
+    void add(std::string_view term, uint32_t id);
+    // 从 term 的倒排表中移除 id，不存在时忽略
+    void erase(std::string_view term, uint32_t id);
+    // removed 为升序无重复的已删除下标（须先 erase 它们的全部词），每个下标减去比它小的已删除下标个数
+    void shiftDown(const MyVector<uint32_t>& removed);
+    // term 的倒排表，词不存在时返回 nullptr
+    const MyVector<uint32_t>* find(std::string_view term) const;
+    size_t getTermCount() const { return terms.getSize(); }
+    size_t getPostingCount() const { return postingCount; }
+
+    // 在 list 的 [from, size) 中找第一个不小于 target 的位置，先倍增步长再二分
+    static size_t gallop(const MyVector<uint32_t>& list, size_t from, uint32_t target);
+    // result 与 other 求交集，结果写回 result；result 较短时按倍增查找跳过 other 中的大段
+    static void intersect(MyVector<uint32_t>& result, const MyVector<uint32_t>& other);
+    // 两张升序表的并集
+    static MyVector<uint32_t> unite(const MyVector<uint32_t>& a, const MyVector<uint32_t>& b);
+};
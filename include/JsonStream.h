@@ -0,0 +1,155 @@
+#pragma once
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include "MyVector.h"
+
+/**
+ * @brief The JsonReader class 流式 JSON 读取器
+ * 每次 next 返回一个记号，文件按固定大小分块读入，不建立整棵文档树，
+ * 调用方边读边构造对象，峰值内存与单个记号大小相当。
+ * 读取过程中检查语法，出错后一直返回 ERROR。
+ * @author 陈子涵
+ */
+class JsonReader {
+public:
+    enum Token {
+        BEGIN_OBJECT,
+        END_OBJECT,
+        BEGIN_ARRAY,
+        END_ARRAY,
+        KEY,        // 对象的键，getKey 取得
+        STRING,     // getString 取得
+        NUMBER,     // getInteger 取得
+        BOOL,       // getBool 取得
+        NULL_VALUE,
+        END,        // 文档结束
+        ERROR
+    };
+
+private:
+    enum State { EXPECT_VALUE, OBJECT_START, EXPECT_KEY, ARRAY_START, AFTER_VALUE };
+    static const size_t BUFFER_SIZE = 64 * 1024;
+    static const size_t MAX_DEPTH = 512;
+
+    std::FILE* file = nullptr;
+    char* buffer; //读入缓冲
+    size_t position = 0;
+    size_t length = 0;
+    MyVector<char> containers; //嵌套中的容器，'{' 或 '['
+    State state = EXPECT_VALUE;
+    bool failed = false;
+    std::string key;
+    std::string text; //字符串内容或数字原文
+    bool boolValue = false;
+
+    int peek();
+    int get();
+    void skipWhitespace();
+    Token fail();
+    Token closeContainer(char open);
+    Token readValue(int c);
+    bool readString(std::string& out);
+    bool readHex4(unsigned& value);
+    bool readLiteral(const char* literal);
+    bool readNumber();
+
+public:
+    JsonReader();
+    ~JsonReader();
+    JsonReader(const JsonReader&) = delete;
+    JsonReader& operator=(const JsonReader&) = delete;
+
+    // 路径为本地编码
+    bool open(const std::string& path);
+    void close();
+
+    Token next();
+    // 跳过以 first 开头的整个值，first 为刚读到的记号
+    bool skipValue(Token first);
+
+    /**
+     * @brief 读取 {"arrayKey": [{...}, ...], ...} 形式的整个文档
+     * 数组中每读到一个对象的 { 就调用 onObject()，由它读到对应的 } 为止；其余字段跳过
+     * @param found 输出文档中是否有该数组
+     * @return 语法正确且文档完整时返回 true
+     */
+    template<typename OnObject>
+    bool readRootArray(std::string_view arrayKey, bool& found, OnObject&& onObject);
+
+    const std::string& getKey() const { return key; }
+    const std::string& getString() const { return text; }
+    long long getInteger() const;
+    bool getBool() const { return boolValue; }
+};
+
+template<typename OnObject>
+bool JsonReader::readRootArray(std::string_view arrayKey, bool& found, OnObject&& onObject) {
+    found = false;
+    if (next() != BEGIN_OBJECT) return false;
+    Token token;
+    while ((token = next()) == KEY) {
+        bool match = key == arrayKey;
+        token = next();
+        if (!match || token != BEGIN_ARRAY) {
+            if (!skipValue(token)) return false;
+            continue;
+        }
+        found = true;
+        while ((token = next()) != END_ARRAY) {
+            if (token == BEGIN_OBJECT) {
+                if (!onObject()) return false;
+            } else if (!skipValue(token)) {
+                return false;
+            }
+        }
+    }
+    return token == END_OBJECT && next() == END;
+}
+
+/**
+ * @brief The JsonWriter class 流式 JSON 写入器
+ * 按调用顺序直接输出，缓冲满了就写出，不在内存中拼出整份文档。
+ * 先写入临时文件，commit 时落盘并替换目标文件；未 commit 就析构则丢弃临时文件。
+ * 输出带四个空格缩进。
+ * @author 陈子涵
+ */
+class JsonWriter {
+private:
+    static const size_t FLUSH_SIZE = 64 * 1024;
+
+    std::FILE* file = nullptr;
+    std::string path;
+    std::string tempPath;
+    std::string buffer;
+    MyVector<bool> hasElements; //每层容器是否已有元素
+    bool afterKey = false;
+    bool failed = false;
+
+    void beginValue();
+    void newline();
+    void writeQuoted(std::string_view value);
+    void flushIfFull();
+
+public:
+    JsonWriter() = default;
+    ~JsonWriter();
+    JsonWriter(const JsonWriter&) = delete;
+    JsonWriter& operator=(const JsonWriter&) = delete;
+
+    // 路径为本地编码
+    bool open(const std::string& path);
+    // 写出剩余内容、同步到磁盘并替换目标文件
+    bool commit();
+
+    void beginObject();
+    void endObject();
+    void beginArray();
+    void endArray();
+    void key(std::string_view name);
+    void value(std::string_view text);
+    void value(const char* text) { value(std::string_view(text)); }
+    void value(long long number);
+    void value(int number) { value(static_cast<long long>(number)); }
+    void value(bool flag);
+};
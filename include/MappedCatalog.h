@@ -0,0 +1,79 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include "Book.h"
+#include "MyVector.h"
+#include "HashIndex.h"
+#include "MappedFile.h"
+#include "BinarySnapshot.h"
+
+/**
+ * @brief The MappedCatalog class 以内存映射方式只读打开的图书目录
+ * 打开 books.bin 二进制快照后不复制任何图书，字段以 string_view 直接指向映射内容，
+ * 只有被访问到的页才调入内存，同一主机上的多个程序实例共享页缓存。
+ * 打开时只检查文件头和各段长度，不读遍文件；需要完整校验时调用 verifyChecksum。
+ * 修改某本图书时才把它复制成 Book（写时复制），之后对该行的读取都落在副本上，
+ * saveToBinaryFile 把映射内容连同修改写成新的快照。
+ * 返回的 string_view 在下一次 editBook 或 close 之前有效。
+ * @author 陈子涵
+ */
+class MappedCatalog {
+private:
+    // 由副本下标取行号，供哈希索引比较键
+    struct EditedRowOf {
+        const MappedCatalog* owner;
+        uint32_t operator()(uint32_t slot) const { return owner->editedRows[slot]; }
+    };
+    // 行号的乘法哈希
+    struct RowHash {
+        size_t operator()(uint32_t row) const { return static_cast<size_t>(row) * 2654435761u; }
+    };
+
+    MappedFile file;
+    BinarySnapshot::SnapshotView view;
+    const unsigned char* isbns = nullptr;
+    const unsigned char* titles = nullptr;
+    const unsigned char* authors = nullptr;
+    const unsigned char* publishers = nullptr;
+    const unsigned char* years = nullptr;
+    const unsigned char* statuses = nullptr;
+    MyVector<Book> editedBooks; //被修改过的图书副本
+    MyVector<uint32_t> editedRows; //副本对应的行号
+    HashIndex<uint32_t, uint32_t, EditedRowOf, RowHash> editedIndex; //行号 -> 副本下标
+
+    const Book* editedBook(size_t row) const;
+    std::string_view field(const unsigned char* column, size_t row) const;
+
+public:
+    MappedCatalog();
+    MappedCatalog(const MappedCatalog&) = delete;
+    MappedCatalog& operator=(const MappedCatalog&) = delete;
+
+    // 映射图书快照，路径为本地编码
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const { return file.isOpen(); }
+    // 读遍文件校验 CRC
+    bool verifyChecksum() const;
+
+    size_t getBookCount() const { return view.getRowCount(); }
+    std::string_view getIsbn(size_t row) const;
+    std::string_view getTitle(size_t row) const;
+    std::string_view getAuthor(size_t row) const;
+    std::string_view getPublisher(size_t row) const;
+    int getPublishYear(size_t row) const;
+    int getStatus(size_t row) const;
+    // 文本是否直接指向映射内容，即未经复制
+    bool isMapped(std::string_view text) const;
+
+    // 复制出第 row 本图书
+    Book getBook(size_t row) const;
+    // 取第 row 本图书的可修改副本，第一次修改时才复制
+    Book& editBook(size_t row);
+    bool isEdited(size_t row) const { return editedBook(row) != nullptr; }
+    size_t getEditedCount() const { return editedBooks.getSize(); }
+
+    // 写出含修改的新快照，路径为本地编码；先写临时文件再替换，写回当前映射的文件也不影响映射
+    bool saveToBinaryFile(const std::string& path) const;
+};
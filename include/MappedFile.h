@@ -0,0 +1,32 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+/**
+ * @brief The MappedFile class 只读内存映射文件
+ * 文件内容直接映射进地址空间，按需调页，同一文件的多个进程共享页缓存。
+ * 路径为本地编码。映射在 close 或析构前一直有效。
+ * @author 陈子涵
+ */
+class MappedFile {
+private:
+    const unsigned char* data = nullptr;
+    size_t size = 0;
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#endif
+
+public:
+    MappedFile() = default;
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // 打开并映射整个文件，空文件视为失败
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const { return data != nullptr; }
+    const unsigned char* getData() const { return data; }
+    size_t getSize() const { return size; }
+};
@@ -45,6 +45,13 @@ public:
         }
         return false;
     }
+    // 按队列顺序访问每个元素
+    template<typename Func>
+    void forEach(Func&& func) const {
+        for (size_t i = head; i < data.getSize(); ++i) {
+            func(data[i]);
+        }
+    }
     // 清空队列
     void clear() {
         data.clear();
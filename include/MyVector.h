@@ -1,16 +1,17 @@
 #pragma once
 #include <cstddef>
 #include <iostream>
+#include <new>
 #include <string>
 #include <type_traits>
 #include <stdexcept>
-
-struct User;
-struct Book;
-struct BorrowRecord;
+#include <utility>
 
 /**
  * @brief The MyVector class 动态数组
+ * 只负责存储；按键查找由各管理器持有的 HashIndex 负责。
+ * 底层为未初始化内存，只构造实际存在的元素；扩容时移动元素，
+ * 支持移动构造/赋值，按值返回的数组不再深拷贝。
  * @author 陈子涵
  */
 template<typename T>
@@ -19,90 +20,76 @@ private:
     T* data; //数据
     size_t capacity; //容量
     size_t size; //大小
-    size_t* hashValues; //哈希值
-    size_t* indices; //哈希值对应索引
-    size_t hashTableSize; //哈希表大小
 
-public:
-    //构建函数和析构函数
-    explicit MyVector(size_t initialCapacity = 4)
-        : capacity(initialCapacity), size(0), hashTableSize(initialCapacity * 2) {
-        data = new T[capacity];
-        hashValues = new size_t[hashTableSize];
-        indices = new size_t[hashTableSize];
-        for (size_t i = 0; i < hashTableSize; ++i) {
-            hashValues[i] = 0;
-            indices[i] = static_cast<size_t>(-1);
+    static T* allocate(size_t n) {
+        return n > 0 ? static_cast<T*>(::operator new(n * sizeof(T))) : nullptr;
+    }
+
+    // 析构全部元素并释放内存
+    void release() {
+        for (size_t i = 0; i < size; ++i) {
+            data[i].~T();
         }
+        ::operator delete(data);
+        data = nullptr;
+        capacity = 0;
+        size = 0;
     }
-    ~MyVector() {
-        delete[] data;
-        delete[] hashValues;
-        delete[] indices;
+
+    // 将现有元素移动到容量为 newCapacity 的新内存
+    void reallocate(size_t newCapacity) {
+        T* newData = allocate(newCapacity);
+        for (size_t i = 0; i < size; ++i) {
+            new (newData + i) T(std::move(data[i]));
+            data[i].~T();
+        }
+        ::operator delete(data);
+        data = newData;
+        capacity = newCapacity;
     }
-    // 添加元素每添加一个元素就重建哈希表
-    void add(const T& value) { push_back(value); }
-    void push_back(const T& value) {
-        // 如果容量已满，扩展容量
+
+    // 扩容后的容量：原来的两倍，空数组首次扩容到 4
+    size_t grownCapacity() const {
+        return capacity == 0 ? 4 : capacity * 2;
+    }
+
+public:
+    //构建函数和析构函数，容量为 0 时延迟到首次插入再分配
+    explicit MyVector(size_t initialCapacity = 0)
+        : data(allocate(initialCapacity)), capacity(initialCapacity), size(0) {}
+    ~MyVector() {
+        release();
+    }
+    // 添加元素
+    void add(const T& value) { emplace_back(value); }
+    void add(T&& value) { emplace_back(std::move(value)); }
+    void push_back(const T& value) { emplace_back(value); }
+    void push_back(T&& value) { emplace_back(std::move(value)); }
+    // 在末尾原地构造元素
+    template<typename... Args>
+    T& emplace_back(Args&&... args) {
         if (size == capacity) {
-            T* newData = new T[capacity * 2];
+            // 先在新内存中构造新元素，参数引用本数组元素时也安全
+            size_t newCapacity = grownCapacity();
+            T* newData = allocate(newCapacity);
+            new (newData + size) T(std::forward<Args>(args)...);
             for (size_t i = 0; i < size; ++i) {
-                newData[i] = data[i];
+                new (newData + i) T(std::move(data[i]));
+                data[i].~T();
             }
-            delete[] data;
+            ::operator delete(data);
             data = newData;
-            capacity *= 2;
-            // 扩展哈希表
-            size_t newHashTableSize = capacity * 2;
-            size_t* newHashValues = new size_t[newHashTableSize];
-            size_t* newIndices = new size_t[newHashTableSize];
-            for (size_t i = 0; i < newHashTableSize; ++i) {
-                newHashValues[i] = 0;
-                newIndices[i] = static_cast<size_t>(-1);
-            }
-            delete[] hashValues;
-            delete[] indices;
-            hashValues = newHashValues;
-            indices = newIndices;
-            hashTableSize = newHashTableSize;
-        }
-        data[size++] = value;
-        // 重建哈希表
-        if constexpr (std::is_same<T, User>::value) {
-            rebuildHashTable();
-        }
-        if constexpr (std::is_same<T, Book>::value) {
-            rebuildBookHashTable();
-        }
-        if constexpr (std::is_same<T, BorrowRecord>::value) {
-            rebuildBorrowRecordHashTable();
+            capacity = newCapacity;
+        } else {
+            new (data + size) T(std::forward<Args>(args)...);
         }
+        return data[size++];
     }
-    // 不重建哈希表的 push_back 方法
-    void push_back_no_rebuild(const T& value) {
-        if (size == capacity) {
-            T* newData = new T[capacity * 2];
-            for (size_t i = 0; i < size; ++i) {
-                newData[i] = data[i];
-            }
-            delete[] data;
-            data = newData;
-            capacity *= 2;
-            size_t newHashTableSize = capacity * 2;
-            size_t* newHashValues = new size_t[newHashTableSize];
-            size_t* newIndices = new size_t[newHashTableSize];
-            for (size_t i = 0; i < newHashTableSize; ++i) {
-                newHashValues[i] = 0;
-                newIndices[i] = static_cast<size_t>(-1);
-            }
-            delete[] hashValues;
-            delete[] indices;
-            hashValues = newHashValues;
-            indices = newIndices;
-            hashTableSize = newHashTableSize;
+    // 预留容量，不改变元素数
+    void reserve(size_t newCapacity) {
+        if (newCapacity > capacity) {
+            reallocate(newCapacity);
         }
-        data[size++] = value;
-        // 不重建哈希表
     }
     // 删除元素
     void removeAt(size_t index) {
@@ -110,22 +97,10 @@ public:
             throw std::out_of_range("Index out of range");
         }
         for (size_t i = index; i < size - 1; ++i) {
-            data[i] = data[i + 1];
-        }
-        if (size > 0) {
-            data[size - 1] = T(); // 置为默认值，防止悬挂
+            data[i] = std::move(data[i + 1]);
         }
+        data[size - 1].~T();
         --size;
-        // 重建哈希表
-        if constexpr (std::is_same<T, User>::value) {
-            rebuildHashTable();
-        }
-        if constexpr (std::is_same<T, Book>::value) {
-            rebuildBookHashTable();
-        }
-        if constexpr (std::is_same<T, BorrowRecord>::value) {
-            rebuildBorrowRecordHashTable();
-        }
     }
     /**
      * @brief 二分查找
@@ -161,172 +136,80 @@ public:
     const T& operator[](size_t index) const { return data[index]; }
     // 获取大小
     size_t getSize() const { return size; }
-    // DJB2 哈希算法
-    size_t customHash(const std::string& str) const {
-        size_t hash = 5381;
-        for (char c : str) {
-            hash = ((hash << 5) + hash) + static_cast<unsigned char>(c);
+    // 获取容量
+    size_t getCapacity() const { return capacity; }
+
+    /**
+     * @brief 按条件筛选元素
+     * 命中下标表按元素数一次预留，收集后再按命中数一次性分配结果，两者都不再反复扩容
+     * @param pred 判断元素是否入选的函数
+     * @return 入选元素组成的新数组，容量恰好等于元素数
+     */
+    template<typename Pred>
+    MyVector filter(Pred pred) const {
+        MyVector<size_t> hits(size);
+        for (size_t i = 0; i < size; ++i) {
+            if (pred(data[i])) {
+                hits.push_back(i);
+            }
         }
-        return hash;
+        MyVector result(hits.getSize());
+        for (size_t i = 0; i < hits.getSize(); ++i) {
+            result.emplace_back(data[hits[i]]);
+        }
+        return result;
     }
 
-    // 赋值运算符重载
+    // 赋值运算符重载，只按元素数分配
     MyVector& operator=(const MyVector& other) {
         if (this == &other) return *this;
-        delete[] data;
-        delete[] hashValues;
-        delete[] indices;
-        capacity = other.capacity;
-        size = other.size;
-        hashTableSize = other.hashTableSize;
-        data = new T[capacity];
-        hashValues = new size_t[hashTableSize];
-        indices = new size_t[hashTableSize];
-        for (size_t i = 0; i < size; ++i) {
-            data[i] = other.data[i];
-        }
-        for (size_t i = 0; i < hashTableSize; ++i) {
-            hashValues[i] = other.hashValues[i];
-            indices[i] = other.indices[i];
+        release();
+        data = allocate(other.size);
+        capacity = other.size;
+        for (size_t i = 0; i < other.size; ++i) {
+            new (data + i) T(other.data[i]);
+            ++size;
         }
         return *this;
     }
 
-    // 拷贝构造函数
+    // 拷贝构造函数，只按元素数分配
     MyVector(const MyVector& other)
-        : capacity(other.capacity), size(other.size), hashTableSize(other.hashTableSize)
+        : data(allocate(other.size)), capacity(other.size), size(0)
     {
-        data = new T[capacity];
-        hashValues = new size_t[hashTableSize];
-        indices = new size_t[hashTableSize];
-        for (size_t i = 0; i < size; ++i) {
-            data[i] = other.data[i];
-        }
-        for (size_t i = 0; i < hashTableSize; ++i) {
-            hashValues[i] = other.hashValues[i];
-            indices[i] = other.indices[i];
+        for (size_t i = 0; i < other.size; ++i) {
+            new (data + i) T(other.data[i]);
+            ++size;
         }
     }
 
-    //重建用户哈希表
-    template<typename U = T>
-    std::enable_if_t<std::is_same<U, User>::value, void>
-    rebuildHashTable() {
-        // 清空哈希表
-        for (size_t i = 0; i < hashTableSize; ++i) {
-            hashValues[i] = 0;
-            indices[i] = static_cast<size_t>(-1);
-        }
-        for (size_t i = 0; i < size; ++i) {
-            size_t hashValue = customHash(data[i].username);
-            size_t pos = hashValue % hashTableSize;
-            // 线性探测解决冲突
-            while (hashValues[pos] != 0 && hashValues[pos] != hashValue) {
-                pos = (pos + 1) % hashTableSize;
-            }
-            hashValues[pos] = hashValue;
-            indices[pos] = i;
-        }
+    // 移动构造函数，直接接管内存
+    MyVector(MyVector&& other) noexcept
+        : data(other.data), capacity(other.capacity), size(other.size)
+    {
+        other.data = nullptr;
+        other.capacity = 0;
+        other.size = 0;
     }
 
-    //按用户名哈希查找
-    template<typename U = T>
-    std::enable_if_t<std::is_same<U, User>::value, int>
-    hashFindByUsername(const std::string& username) const {
-        size_t targetHash = customHash(username);
-        size_t pos = targetHash % hashTableSize;
-        for (size_t i = 0; i < hashTableSize; ++i) {
-            if (hashValues[pos] == 0) break;
-            if (hashValues[pos] == targetHash) {
-                //验证是否为要查找的记录
-                if (data[indices[pos]].username == username) {
-                    return static_cast<int>(indices[pos]);
-                }
-            }
-            pos = (pos + 1) % hashTableSize;
-        }
-        return -1;
-    }
-    //重建书籍哈希表
-    template<typename U = T>
-    std::enable_if_t<std::is_same<U, Book>::value, void>
-    rebuildBookHashTable() {
-        for (size_t i = 0; i < hashTableSize; ++i) {
-            hashValues[i] = 0;
-            indices[i] = static_cast<size_t>(-1);
-        }
-        for (size_t i = 0; i < size; ++i) {
-            size_t hashValue = customHash(data[i].getIsbn());
-            size_t pos = hashValue % hashTableSize;
-            while (hashValues[pos] != 0 && hashValues[pos] != hashValue) {
-                pos = (pos + 1) % hashTableSize;
-            }
-            hashValues[pos] = hashValue;
-            indices[pos] = i;
-        }
-    }
-    //哈希查找书籍
-    template<typename U = T>
-    std::enable_if_t<std::is_same<U, Book>::value, int>
-    hashFindByIsbn(const std::string& isbn) const {
-        size_t targetHash = customHash(isbn);
-        size_t pos = targetHash % hashTableSize;
-        for (size_t i = 0; i < hashTableSize; ++i) {
-            if (hashValues[pos] == 0) break;
-            if (hashValues[pos] == targetHash) {
-                if (data[indices[pos]].getIsbn() == isbn) {
-                    return static_cast<int>(indices[pos]);
-                }
-            }
-            pos = (pos + 1) % hashTableSize;
-        }
-        return -1;
+    // 移动赋值运算符
+    MyVector& operator=(MyVector&& other) noexcept {
+        if (this == &other) return *this;
+        release();
+        data = other.data;
+        capacity = other.capacity;
+        size = other.size;
+        other.data = nullptr;
+        other.capacity = 0;
+        other.size = 0;
+        return *this;
     }
-    // 重建借阅记录哈希表
-    template<typename U = T>
-    std::enable_if_t<std::is_same<U, BorrowRecord>::value, void>rebuildBorrowRecordHashTable() {
-        for (size_t i = 0; i < hashTableSize; ++i) {
-            hashValues[i] = 0;
-            indices[i] = static_cast<size_t>(-1);
-        }
+
+    //清空，保留容量
+    void clear() {
         for (size_t i = 0; i < size; ++i) {
-            size_t hashValue = customHash(data[i].getRecordId());
-            size_t pos = hashValue % hashTableSize;
-            while (hashValues[pos] != 0 && hashValues[pos] != hashValue) {
-                pos = (pos + 1) % hashTableSize;
-            }
-            hashValues[pos] = hashValue;
-            indices[pos] = i;
+            data[i].~T();
         }
-    }
-    //哈希查找借阅记录
-    template<typename U = T>
-    std::enable_if_t<std::is_same<U, BorrowRecord>::value, int>
-    hashFindByRecordId(const std::string& recordId) const {
-        size_t targetHash = customHash(recordId);
-        size_t pos = targetHash % hashTableSize;
-        for (size_t i = 0; i < hashTableSize; ++i) {
-            if (hashValues[pos] == 0) break;
-            if (hashValues[pos] == targetHash) {
-                if (data[indices[pos]].getRecordId() == recordId) {
-                    return static_cast<int>(indices[pos]);
-                }
-            }
-            pos = (pos + 1) % hashTableSize;
-        }
-        return -1;
-    }
-    //清空哈希表
-    void clear() {
         size = 0;
-        if constexpr (std::is_same<T, User>::value) {
-            rebuildHashTable();
-        }
-        if constexpr (std::is_same<T, Book>::value) {
-            rebuildBookHashTable();
-        }
-        if constexpr (std::is_same<T, BorrowRecord>::value) {
-            rebuildBorrowRecordHashTable();
-        }
     }
 };
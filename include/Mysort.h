@@ -1,62 +1,481 @@
 #pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include "MyVector.h"
 
+/**
+ * @brief MyAlgorithm 排序算法库
+ * sort: 内省排序（快速排序 + 堆排序兜底 + 小区间插入排序），不稳定，O(N log N) 最坏复杂度
+ * stableSort: 归并排序，稳定，适合多列依次排序
+ * parallelSort: 分块并行内省排序 + 并行归并，用于整表排序
+ * partialSort / nthElement: 只排前 k 个 / 只定位第 k 个，用于分页取前几页
+ * 元素交换全部通过移动完成，不再整体拷贝对象
+ */
 namespace MyAlgorithm {
-    template<typename T>
-    int partition(T arr[], int low, int high) {
-        T pivot = arr[high];
-        int i = low - 1;
-        for (int j = low; j < high; j++) {
-            if (arr[j] <= pivot) {
-                i++;
-                T temp = arr[i];
-                arr[i] = arr[j];
-                arr[j] = temp;
-            }
-        }
-        T temp = arr[i + 1];
-        arr[i + 1] = arr[high];
-        arr[high] = temp;
-        return i + 1;
+    namespace detail {
+        // 小于该长度的区间直接插入排序
+        constexpr size_t INSERTION_SORT_THRESHOLD = 16;
+        // 大于该长度的区间用九数取中选主元
+        constexpr size_t NINTHER_THRESHOLD = 128;
+        // 归并排序初始有序段长度
+        constexpr size_t MERGE_RUN_LENGTH = 32;
+        // 小于该长度时并行开销大于收益，直接单线程排序
+        constexpr size_t PARALLEL_SORT_THRESHOLD = 1 << 15;
+
+        template<typename T, typename Compare>
+        void insertionSort(T* arr, size_t length, Compare& compare) {
+            for (size_t i = 1; i < length; ++i) {
+                if (!compare(arr[i], arr[i - 1])) continue;
+                T value = std::move(arr[i]);
+                size_t j = i;
+                do {
+                    arr[j] = std::move(arr[j - 1]);
+                    --j;
+                } while (j > 0 && compare(value, arr[j - 1]));
+                arr[j] = std::move(value);
+            }
+        }
+
+        // 使 a <= b <= c
+        template<typename T, typename Compare>
+        void sort3(T& a, T& b, T& c, Compare& compare) {
+            using std::swap;
+            if (compare(b, a)) swap(a, b);
+            if (compare(c, b)) {
+                swap(b, c);
+                if (compare(b, a)) swap(a, b);
+            }
+        }
+
+        template<typename T, typename Compare>
+        void siftDown(T* arr, size_t root, size_t length, Compare& compare) {
+            T value = std::move(arr[root]);
+            size_t child;
+            while ((child = 2 * root + 1) < length) {
+                if (child + 1 < length && compare(arr[child], arr[child + 1])) {
+                    ++child;
+                }
+                if (!compare(value, arr[child])) break;
+                arr[root] = std::move(arr[child]);
+                root = child;
+            }
+            arr[root] = std::move(value);
+        }
+
+        template<typename T, typename Compare>
+        void heapSort(T* arr, size_t length, Compare& compare) {
+            using std::swap;
+            for (size_t i = length / 2; i-- > 0;) {
+                siftDown(arr, i, length, compare);
+            }
+            for (size_t end = length - 1; end > 0; --end) {
+                swap(arr[0], arr[end]);
+                siftDown(arr, 0, end, compare);
+            }
+        }
+
+        // 选主元放到 arr[0]：短区间三数取中，长区间九数取中
+        template<typename T, typename Compare>
+        void choosePivot(T* arr, size_t length, Compare& compare) {
+            using std::swap;
+            size_t mid = length / 2;
+            if (length > NINTHER_THRESHOLD) {
+                sort3(arr[0], arr[mid], arr[length - 1], compare);
+                sort3(arr[1], arr[mid - 1], arr[length - 2], compare);
+                sort3(arr[2], arr[mid + 1], arr[length - 3], compare);
+                sort3(arr[mid - 1], arr[mid], arr[mid + 1], compare);
+            } else {
+                sort3(arr[0], arr[mid], arr[length - 1], compare);
+            }
+            swap(arr[0], arr[mid]);
+        }
+
+        // Hoare 划分，遇到与主元相等的元素两侧都停下交换，大量重复键时仍能均分
+        template<typename T, typename Compare>
+        size_t partition(T* arr, size_t length, Compare& compare) {
+            using std::swap;
+            choosePivot(arr, length, compare);
+            size_t i = 0;
+            size_t j = length;
+            while (true) {
+                while (++i < length && compare(arr[i], arr[0])) {}
+                while (compare(arr[0], arr[--j])) {}
+                if (i >= j) break;
+                swap(arr[i], arr[j]);
+            }
+            swap(arr[0], arr[j]);
+            return j;
+        }
+
+        template<typename T, typename Compare>
+        void introSort(T* arr, size_t length, int depthLimit, Compare& compare) {
+            while (length > INSERTION_SORT_THRESHOLD) {
+                if (depthLimit == 0) {
+                    // 划分持续失衡，退化为堆排序保证 O(N log N)
+                    heapSort(arr, length, compare);
+                    return;
+                }
+                --depthLimit;
+                size_t pivot = partition(arr, length, compare);
+                // 递归处理较短一侧，循环处理较长一侧，栈深度不超过 O(log N)
+                size_t leftLength = pivot;
+                size_t rightLength = length - pivot - 1;
+                if (leftLength < rightLength) {
+                    introSort(arr, leftLength, depthLimit, compare);
+                    arr += pivot + 1;
+                    length = rightLength;
+                } else {
+                    introSort(arr + pivot + 1, rightLength, depthLimit, compare);
+                    length = leftLength;
+                }
+            }
+            insertionSort(arr, length, compare);
+        }
+
+        inline int depthLimitFor(size_t length) {
+            int depth = 0;
+            while (length > 1) {
+                length >>= 1;
+                ++depth;
+            }
+            return depth * 2;
+        }
+
+        // 将 [from, from+leftLength) 与其后 rightLength 个元素合并到 to
+        template<typename T, typename Compare>
+        void mergeRuns(T* from, size_t leftLength, size_t rightLength, T* to, Compare& compare) {
+            size_t i = 0;
+            size_t j = leftLength;
+            size_t end = leftLength + rightLength;
+            size_t k = 0;
+            while (i < leftLength && j < end) {
+                // 右侧严格更小才先取，保证稳定
+                if (compare(from[j], from[i])) {
+                    to[k++] = std::move(from[j++]);
+                } else {
+                    to[k++] = std::move(from[i++]);
+                }
+            }
+            while (i < leftLength) to[k++] = std::move(from[i++]);
+            while (j < end) to[k++] = std::move(from[j++]);
+        }
+
+        // 两段有序序列 left/right 合并后的第 k 个位置，求应从 left 取的元素个数（相等时左侧优先）
+        template<typename T, typename Compare>
+        size_t mergeSplit(const T* left, size_t leftLength, const T* right, size_t rightLength,
+                          size_t k, Compare& compare) {
+            size_t low = k > rightLength ? k - rightLength : 0;
+            size_t high = k < leftLength ? k : leftLength;
+            while (low < high) {
+                size_t i = low + (high - low) / 2;
+                size_t j = k - i;
+                if (j > 0 && i < leftLength && !compare(right[j - 1], left[i])) {
+                    low = i + 1; // left[i] 不大于 right[j-1]，左侧还应多取
+                } else {
+                    high = i;
+                }
+            }
+            return low;
+        }
+
+        /**
+         * @brief 常驻工作线程组，线程只在构造时创建一次
+         * 每次 run 是一个阶段：任务编号由原子计数分发，工作线程与调用线程抢着领取，
+         * 全部任务完成后 run 才返回。并行排序的分块排序和每一轮归并共用同一组线程。
+         */
+        class TaskPool {
+        private:
+            std::mutex mutex;
+            std::condition_variable wake;  // 新阶段开始或线程组停止
+            std::condition_variable idle;  // 没有工作线程在领取任务
+            const std::function<void(size_t)>* task = nullptr;
+            size_t taskCount = 0;
+            std::atomic<size_t> next{0};  // 下一个待领取的任务编号
+            size_t busy = 0;              // 正在领取任务的工作线程数
+            uint64_t phase = 0;
+            bool stopping = false;
+            MyVector<std::thread> workers;
+
+            // busy 期间 run 不会改写 task 和 taskCount，这里可以不加锁读取
+            void drain() {
+                for (size_t t = next.fetch_add(1); t < taskCount; t = next.fetch_add(1)) {
+                    (*task)(t);
+                }
+            }
+
+            void workLoop() {
+                uint64_t seen = 0;
+                for (;;) {
+                    {
+                        std::unique_lock<std::mutex> lock(mutex);
+                        wake.wait(lock, [&] { return stopping || phase != seen; });
+                        if (stopping) return;
+                        seen = phase;
+                        ++busy;
+                    }
+                    drain();
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (--busy == 0) idle.notify_all();
+                }
+            }
+
+        public:
+            explicit TaskPool(size_t workerCount) : workers(workerCount) {
+                for (size_t i = 0; i < workerCount; ++i) {
+                    workers.emplace_back([this] { workLoop(); });
+                }
+            }
+            ~TaskPool() {
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    stopping = true;
+                }
+                wake.notify_all();
+                for (size_t i = 0; i < workers.getSize(); ++i) {
+                    workers[i].join();
+                }
+            }
+            TaskPool(const TaskPool&) = delete;
+            TaskPool& operator=(const TaskPool&) = delete;
+
+            // 执行编号为 [0, count) 的任务，调用线程也参与领取
+            void run(size_t count, const std::function<void(size_t)>& fn) {
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    // 上一阶段醒得晚的线程可能还在 drain 中，等它们退出后再换任务
+                    idle.wait(lock, [&] { return busy == 0; });
+                    task = &fn;
+                    taskCount = count;
+                    next = 0;
+                    ++phase;
+                }
+                wake.notify_all();
+                drain();
+                // 调用线程领完时任务已全部分出，领到任务的线程都在 busy 中
+                std::unique_lock<std::mutex> lock(mutex);
+                idle.wait(lock, [&] { return busy == 0; });
+            }
+        };
+
+        // 将 taskCount 个任务分给 taskCount - 1 个新线程和当前线程执行，只执行一个阶段时使用
+        template<typename Task>
+        void runParallel(size_t taskCount, Task& task) {
+            if (taskCount == 0) return;
+            TaskPool pool(taskCount - 1);
+            pool.run(taskCount, std::function<void(size_t)>(std::ref(task)));
+        }
+    }
+
+    template<typename T, typename Compare>
+    void sort(T arr[], size_t length, Compare compare) {
+        if (length < 2) return;
+        detail::introSort(arr, length, detail::depthLimitFor(length), compare);
     }
     template<typename T>
-    void quickSort(T arr[], int low, int high) {
-        if (low < high) {
-            int pi = partition(arr, low, high);
-            quickSort(arr, low, pi - 1);
-            quickSort(arr, pi + 1, high);
+    void sort(T arr[], size_t length) {
+        sort(arr, length, [](const T& a, const T& b) { return a < b; });
+    }
+
+    /**
+     * @brief 稳定排序，相等元素保持原有相对次序
+     * 自底向上归并，需要与输入等长的缓冲区（T 需可默认构造）
+     */
+    template<typename T, typename Compare>
+    void stableSort(T arr[], size_t length, Compare compare) {
+        if (length < 2) return;
+        for (size_t start = 0; start < length; start += detail::MERGE_RUN_LENGTH) {
+            size_t runLength = length - start < detail::MERGE_RUN_LENGTH ? length - start : detail::MERGE_RUN_LENGTH;
+            detail::insertionSort(arr + start, runLength, compare);
         }
+        if (length <= detail::MERGE_RUN_LENGTH) return;
+        T* buffer = new T[length];
+        T* from = arr;
+        T* to = buffer;
+        for (size_t width = detail::MERGE_RUN_LENGTH; width < length; width *= 2) {
+            for (size_t start = 0; start < length; start += 2 * width) {
+                size_t leftLength = length - start < width ? length - start : width;
+                size_t rest = length - start - leftLength;
+                size_t rightLength = rest < width ? rest : width;
+                detail::mergeRuns(from + start, leftLength, rightLength, to + start, compare);
+            }
+            std::swap(from, to);
+        }
+        if (from != arr) {
+            for (size_t i = 0; i < length; ++i) {
+                arr[i] = std::move(from[i]);
+            }
+        }
+        delete[] buffer;
     }
     template<typename T>
-    void sort(T arr[], int length) {
-        quickSort(arr, 0, length - 1);
+    void stableSort(T arr[], size_t length) {
+        stableSort(arr, length, [](const T& a, const T& b) { return a < b; });
     }
+
+    /**
+     * @brief 部分排序，使前 k 个位置为全体中最小的 k 个元素且有序
+     * 用大小为 k 的最大堆筛选其余元素，O(N log k)；其余位置的次序不确定
+     */
     template<typename T, typename Compare>
-    int partition(T arr[], int low, int high, Compare compare) {
-        T pivot = arr[high];
-        int i = low - 1;
-        for (int j = low; j < high; j++) {
-            if (compare(arr[j], pivot)) {
-                i++;
-                T temp = arr[i];
-                arr[i] = arr[j];
-                arr[j] = temp;
-            }
-        }
-        T temp = arr[i + 1];
-        arr[i + 1] = arr[high];
-        arr[high] = temp;
-        return i + 1;
+    void partialSort(T arr[], size_t length, size_t k, Compare compare) {
+        using std::swap;
+        if (k >= length) {
+            sort(arr, length, compare);
+            return;
+        }
+        if (k == 0) return;
+        for (size_t i = k / 2; i-- > 0;) {
+            detail::siftDown(arr, i, k, compare);
+        }
+        for (size_t i = k; i < length; ++i) {
+            // 比堆顶（当前第 k 小）更小的元素才入堆
+            if (compare(arr[i], arr[0])) {
+                swap(arr[i], arr[0]);
+                detail::siftDown(arr, 0, k, compare);
+            }
+        }
+        for (size_t end = k - 1; end > 0; --end) {
+            swap(arr[0], arr[end]);
+            detail::siftDown(arr, 0, end, compare);
+        }
     }
+
+    /**
+     * @brief 选择第 nth 小的元素放到 arr[nth]
+     * 其前元素均不大于它、其后元素均不小于它，平均 O(N)；划分失衡时退化为堆排序
+     */
     template<typename T, typename Compare>
-    void quickSort(T arr[], int low, int high, Compare compare) {
-        if (low < high) {
-            int pi = partition(arr, low, high, compare);
-            quickSort(arr, low, pi - 1, compare);
-            quickSort(arr, pi + 1, high, compare);
+    void nthElement(T arr[], size_t length, size_t nth, Compare compare) {
+        if (nth >= length) return;
+        int depthLimit = detail::depthLimitFor(length);
+        while (length > detail::INSERTION_SORT_THRESHOLD) {
+            if (depthLimit-- == 0) {
+                detail::heapSort(arr, length, compare);
+                return;
+            }
+            size_t pivot = detail::partition(arr, length, compare);
+            if (pivot == nth) return;
+            if (nth < pivot) {
+                length = pivot;
+            } else {
+                arr += pivot + 1;
+                length -= pivot + 1;
+                nth -= pivot + 1;
+            }
         }
+        detail::insertionSort(arr, length, compare);
     }
+
+    /**
+     * @brief 并行排序
+     * 将数组均分为 threadCount 块并行内省排序，再逐轮两两归并；
+     * 每次归并按输出位置二分切分，使所有线程在最后几轮也保持忙碌。
+     * 工作线程在开始时创建一次，分块排序和各轮归并都交给同一个 TaskPool。
+     * 小数组或单核时退化为 sort。需要与输入等长的缓冲区（T 需可默认构造）。
+     * @param threadCount 线程数，0 表示使用全部硬件线程
+     */
     template<typename T, typename Compare>
-    void sort(T arr[], int length, Compare compare) {
-        quickSort(arr, 0, length - 1, compare);
+    void parallelSort(T arr[], size_t length, Compare compare, unsigned threadCount = 0) {
+        if (threadCount == 0) {
+            threadCount = std::thread::hardware_concurrency();
+        }
+        if (threadCount < 2 || length < detail::PARALLEL_SORT_THRESHOLD) {
+            sort(arr, length, compare);
+            return;
+        }
+        size_t runCount = threadCount;
+        MyVector<size_t> bounds(runCount + 1);
+        for (size_t r = 0; r <= runCount; ++r) {
+            bounds.push_back(length * r / runCount);
+        }
+        detail::TaskPool pool(threadCount - 1);
+        // 第一阶段：各块独立排序
+        std::function<void(size_t)> sortRun = [&](size_t r) {
+            sort(arr + bounds[r], bounds[r + 1] - bounds[r], compare);
+        };
+        pool.run(runCount, sortRun);
+
+        // 第二阶段：逐轮两两归并，在 arr 与缓冲区之间交替
+        T* buffer = new T[length];
+        T* from = arr;
+        T* to = buffer;
+        while (runCount > 1) {
+            size_t pairCount = runCount / 2;
+            size_t partsPerPair = threadCount / pairCount > 0 ? threadCount / pairCount : 1;
+            bool hasOddRun = runCount % 2 == 1;
+            // 先算好所有切分点：归并任务会移走源元素，不能边归并边二分
+            MyVector<size_t> splits(pairCount * (partsPerPair + 1));
+            for (size_t pair = 0; pair < pairCount; ++pair) {
+                size_t begin = bounds[2 * pair];
+                size_t leftLength = bounds[2 * pair + 1] - begin;
+                size_t rightLength = bounds[2 * pair + 2] - bounds[2 * pair + 1];
+                size_t total = leftLength + rightLength;
+                for (size_t part = 0; part <= partsPerPair; ++part) {
+                    splits.push_back(detail::mergeSplit(from + begin, leftLength, from + begin + leftLength,
+                                                        rightLength, total * part / partsPerPair, compare));
+                }
+            }
+            std::function<void(size_t)> mergeTask = [&](size_t t) {
+                if (t == pairCount * partsPerPair) {
+                    // 奇数块轮空，原样搬到目标区
+                    for (size_t i = bounds[runCount - 1]; i < length; ++i) {
+                        to[i] = std::move(from[i]);
+                    }
+                    return;
+                }
+                size_t pair = t / partsPerPair;
+                size_t part = t % partsPerPair;
+                size_t begin = bounds[2 * pair];
+                size_t leftLength = bounds[2 * pair + 1] - begin;
+                size_t rightLength = bounds[2 * pair + 2] - bounds[2 * pair + 1];
+                const T* left = from + begin;
+                const T* right = left + leftLength;
+                size_t total = leftLength + rightLength;
+                size_t kBegin = total * part / partsPerPair;
+                size_t kEnd = total * (part + 1) / partsPerPair;
+                size_t iBegin = splits[pair * (partsPerPair + 1) + part];
+                size_t iEnd = splits[pair * (partsPerPair + 1) + part + 1];
+                size_t jBegin = kBegin - iBegin;
+                size_t jEnd = kEnd - iEnd;
+                // 切分后的两小段合并到输出的 [kBegin, kEnd)
+                T* out = to + begin + kBegin;
+                size_t i = iBegin;
+                size_t j = jBegin;
+                while (i < iEnd && j < jEnd) {
+                    if (compare(right[j], left[i])) {
+                        *out++ = std::move(from[begin + leftLength + j++]);
+                    } else {
+                        *out++ = std::move(from[begin + i++]);
+                    }
+                }
+                while (i < iEnd) *out++ = std::move(from[begin + i++]);
+                while (j < jEnd) *out++ = std::move(from[begin + leftLength + j++]);
+            };
+            pool.run(pairCount * partsPerPair + (hasOddRun ? 1 : 0), mergeTask);
+            // 归并后的块边界
+            size_t newRunCount = (runCount + 1) / 2;
+            for (size_t r = 0; r < newRunCount; ++r) {
+                bounds[r] = bounds[2 * r];
+            }
+            bounds[newRunCount] = length;
+            runCount = newRunCount;
+            std::swap(from, to);
+        }
+        if (from != arr) {
+            for (size_t i = 0; i < length; ++i) {
+                arr[i] = std::move(from[i]);
+            }
+        }
+        delete[] buffer;
+    }
+    template<typename T>
+    void parallelSort(T arr[], size_t length) {
+        parallelSort(arr, length, [](const T& a, const T& b) { return a < b; });
     }
-} 
\ No newline at end of file
+}
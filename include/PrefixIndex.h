@@ -0,0 +1,38 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include "MyVector.h"
+
+/**
+ * @brief The PrefixIndex class 前缀索引，用于输入时的自动补全
+ * 把字段的不同取值存成有序数组，排序和前缀匹配都忽略 ASCII 大小写（相同时再按原文），
+ * 同一前缀的取值在数组中连续，二分找到起点后顺序取出即可。
+ * 每个取值记录出现次数，次数归零时才移除，多本书同名不会互相影响。
+ * 空文本不参与补全。
+ * @author 陈子涵
+ */
+class PrefixIndex {
+private:
+    struct Entry {
+        std::string text;
+        uint32_t count; //取该值的图书数
+    };
+
+    MyVector<Entry> entries;
+
+    // 第一个不小于 text 的位置
+    size_t lowerBound(std::string_view text) const;
+
+public:
+    void clear() { entries.clear(); }
+    // 取值 text 的次数加一，新取值按序插入
+    void add(std::string_view text);
+    // 取值 text 的次数减一，归零时移除
+    void erase(std::string_view text);
+    // 批量加入：排序后与现有数组归并，导入和重建时使用
+    void addAll(MyVector<std::string_view>& texts);
+    // 以 prefix 开头的前 limit 个取值，按索引顺序
+    MyVector<std::string> complete(std::string_view prefix, size_t limit) const;
+    size_t getSize() const { return entries.getSize(); }
+};
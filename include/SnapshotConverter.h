@@ -0,0 +1,14 @@
+#pragma once
+#include <QString>
+#include "BinarySnapshot.h"
+
+/**
+ * @brief JSON 与二进制快照之间的互相转换
+ * 借助各管理器原有的读写方法完成，kind 指明文件中存放的数据类型。
+ * 图书和借阅记录使用 books.json / borrow_records.json 的格式，用户使用 users.json 的逐行格式。
+ * @author 陈子涵
+ */
+namespace SnapshotConverter {
+    bool jsonToBinary(BinarySnapshot::Kind kind, const QString& jsonFile, const QString& binaryFile);
+    bool binaryToJson(BinarySnapshot::Kind kind, const QString& binaryFile, const QString& jsonFile);
+}
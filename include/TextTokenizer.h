@@ -0,0 +1,102 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+/**
+ * @brief 图书文本分词，供倒排索引建索引和检索共用
+ * 按词：ASCII 字母数字的连续段为一个词，转为小写；其余 ASCII 字符作分隔；
+ * 非 ASCII 字符（如汉字）按 UTF-8 码点切分，每个码点单独成词。
+ * 按三元组：相邻三个码点为一组，保留原文大小写，用于子串检索。
+ * 非法的 UTF-8 字节按单字节处理，不会越界。切分只看序列本身是否完整，
+ * 同一段合法文本无论出现在哪里都切出相同的码点，索引与检索才能对得上。
+ * @author 陈子涵
+ */
+namespace TextTokenizer {
+    // text[i] 起的码点字节数：完整的多字节序列返回其长度，ASCII、续字节和残缺序列按 1 处理
+    inline size_t codePointLength(std::string_view text, size_t i) {
+        unsigned char lead = static_cast<unsigned char>(text[i]);
+        size_t length = 1;
+        if (lead >= 0xF0 && lead <= 0xF7) length = 4;
+        else if (lead >= 0xE0 && lead <= 0xEF) length = 3;
+        else if (lead >= 0xC0 && lead <= 0xDF) length = 2;
+        if (length > text.size() - i) return 1;
+        for (size_t k = 1; k < length; ++k) {
+            if ((static_cast<unsigned char>(text[i + k]) & 0xC0) != 0x80) return 1;
+        }
+        return length;
+    }
+
+    // 每个非 ASCII 字节都属于完整的多字节序列
+    inline bool isWellFormed(std::string_view text) {
+        for (size_t i = 0; i < text.size();) {
+            size_t length = codePointLength(text, i);
+            if (length == 1 && static_cast<unsigned char>(text[i]) >= 0x80) return false;
+            i += length;
+        }
+        return true;
+    }
+
+    template<typename OnCodePoint>
+    void forEachCodePoint(std::string_view text, OnCodePoint&& onCodePoint) {
+        for (size_t i = 0; i < text.size();) {
+            size_t length = codePointLength(text, i);
+            onCodePoint(text.substr(i, length));
+            i += length;
+        }
+    }
+
+    /**
+     * @brief 依次取出 text 中相邻三个码点组成的片段，不足三个码点时不产生
+     * @param onGram 以指向 text 的 std::string_view 调用
+     */
+    template<typename OnGram>
+    void forEachTrigram(std::string_view text, OnGram&& onGram) {
+        size_t first = 0; //窗口中第一个码点的起点
+        size_t second = 0;
+        size_t seen = 0;
+        for (size_t i = 0; i < text.size();) {
+            size_t length = codePointLength(text, i);
+            if (seen >= 2) {
+                onGram(text.substr(first, i + length - first));
+            }
+            first = second;
+            second = i;
+            ++seen;
+            i += length;
+        }
+    }
+
+    inline bool isWordChar(unsigned char c) {
+        return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+    }
+
+    /**
+     * @brief 依次取出 text 中的词
+     * @param onToken 以 std::string_view 调用，视图只在本次调用期间有效
+     */
+    template<typename OnToken>
+    void forEachWord(std::string_view text, OnToken&& onToken) {
+        std::string word;
+        size_t i = 0;
+        while (i < text.size()) {
+            unsigned char c = static_cast<unsigned char>(text[i]);
+            if (c < 0x80) {
+                if (!isWordChar(c)) {
+                    ++i;
+                    continue;
+                }
+                word.clear();
+                while (i < text.size() && isWordChar(static_cast<unsigned char>(text[i]))) {
+                    char ch = text[i++];
+                    word.push_back(ch >= 'A' && ch <= 'Z' ? static_cast<char>(ch - 'A' + 'a') : ch);
+                }
+                onToken(std::string_view(word));
+                continue;
+            }
+            size_t length = codePointLength(text, i);
+            onToken(text.substr(i, length));
+            i += length;
+        }
+    }
+}
@@ -2,8 +2,11 @@
 #define USER_H
 
 #include "./MyVector.h"
+#include "./HashIndex.h"
+#include <cstdint>
 #include <string>
 #include <iostream>
+#include <shared_mutex>
 
 enum Role { USER, ADMIN };
 
@@ -31,24 +34,49 @@ struct User {
 /**
  * @brief The UserManager class 用户管理模块
  * 负责用户的添加、删除、更新、查找等功能
+ * 线程安全：查询共享读锁，增删改独占写锁。返回指针或引用的接口（findUser、getAllUsers）
+ * 须在 readLock() 期间使用，持锁期间不要再调用本类其他方法。
  * @author 陈子涵
  */
 class UserManager
 {
 private:
+    // 由用户下标取用户名，供哈希索引比较键
+    struct UsernameOf {
+        const UserManager* owner;
+        const std::string& operator()(uint32_t index) const { return owner->users[index].username; }
+    };
+
     MyVector<User> users;
+    HashIndex<std::string_view, uint32_t, UsernameOf> usernameIndex; // 用户名 -> 下标
+    mutable std::shared_mutex mutex; // 保护 users 和 usernameIndex
+    // 以下私有方法均要求调用方已持有锁
+    void rebuildIndex();
+    int indexOfUser(const std::string& username) const;
+    bool removeUnlocked(const std::string& username);
 public:
+    UserManager();
+    UserManager(const UserManager&) = delete;
+    UserManager& operator=(const UserManager&) = delete;
+
     void addUser(const User &user);
     bool removeUser(const std::string &username);
     bool updateUser(const std::string &oldUsername, const User &newUser);
     void printAllUsers() const;
     const User* findUser(const std::string &username) const;
+    // 以下两个方法不需要调用方持锁
+    bool hasUser(const std::string &username) const;
+    bool getUser(const std::string &username, User &user) const;
     MyVector<User> fuzzyFindUsers(const std::string& keyword) const;
     MyVector<User> findAndSortUsers(const std::string& keyword, bool ascending = true) const;
     bool adminRemoveUsers(const MyVector<std::string>& usernames);
     bool loadFromFile(const std::string& filename);
     bool saveToFile(const std::string& filename) const;
+    bool loadFromBinaryFile(const std::string& filename);
+    bool saveToBinaryFile(const std::string& filename) const;
     const MyVector<User>& getAllUsers() const { return users; }
+    // 共享读锁，持有期间可安全使用 findUser、getAllUsers 返回的指针和引用
+    std::shared_lock<std::shared_mutex> readLock() const { return std::shared_lock<std::shared_mutex>(mutex); }
 };
 
 #endif // USER_H
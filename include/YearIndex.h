@@ -0,0 +1,53 @@
+#pragma once
+#include <cstdint>
+#include "MyVector.h"
+
+/**
+ * @brief The YearIndex class 出版年份索引
+ * Book::setPublishYear 限定年份在 [MIN_YEAR, MAX_YEAR]，按年份分桶（计数排序的桶），
+ * 每个桶是该年图书下标的升序表，按年份查找直接取桶，按区间查找依次取各桶。
+ * 构造函数和导入不校验年份，范围外的年份另存一张按 (年份, 下标) 排序的表，二分定位。
+ * 文档下标与 InvertedIndex 相同，删除图书后调用 shiftDown。
+ * @author 陈子涵
+ */
+class YearIndex {
+public:
+    static constexpr int MIN_YEAR = 1000;
+    static constexpr int MAX_YEAR = 2024;
+
+private:
+    static constexpr size_t BUCKET_COUNT = MAX_YEAR - MIN_YEAR + 1;
+
+    struct Entry {
+        int year;
+        uint32_t id;
+    };
+
+    MyVector<uint32_t> buckets[BUCKET_COUNT];
+    MyVector<Entry> others; //范围外的年份
+
+    // others 中第一个不小于 (year, id) 的位置
+    size_t lowerBound(int year, uint32_t id) const;
+
+public:
+    void clear();
+    // 年份递增、下标递增地加入时为 O(1)
+    void add(int year, uint32_t id);
+    void erase(int year, uint32_t id);
+    // removed 为升序无重复的已删除下标（须先 erase），每个下标减去比它小的已删除下标个数，只扫一遍各桶
+    void shiftDown(const MyVector<uint32_t>& removed);
+    /**
+     * @brief 出版年份在 [from, to] 内的图书下标
+     * @return 先按年份、同年再按下标升序；from > to 时为空
+     */
+    MyVector<uint32_t> range(int from, int to) const;
+    // 同一区间内的图书下标，按下标升序
+    MyVector<uint32_t> ids(int from, int to) const;
+    // 同一区间内的图书数，不取出下标
+    size_t count(int from, int to) const;
+    /**
+     * @brief 区间内各非空年份桶，借用而不复制
+     * @return false 表示区间内还有范围外年份的图书，只看桶不完整
+     */
+    bool bucketLists(int from, int to, MyVector<const MyVector<uint32_t>*>& lists) const;
+};
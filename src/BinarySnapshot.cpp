@@ -0,0 +1,352 @@
+#include "../include/BinarySnapshot.h"
+#include "../include/Checksum.h"
+#include "../include/HashIndex.h"
+#include "../include/MappedFile.h"
+#include "../include/MappedCatalog.h"
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <string_view>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+    const char MAGIC[4] = {'B', 'M', 'S', 'B'};
+    const size_t HEADER_SIZE = 32;
+    const size_t CRC_SIZE = 4;
+
+    void putU32(std::string& out, uint32_t value) {
+        for (int i = 0; i < 4; ++i) {
+            out += static_cast<char>((value >> (8 * i)) & 0xFF);
+        }
+    }
+
+    void putU64(std::string& out, uint64_t value) {
+        for (int i = 0; i < 8; ++i) {
+            out += static_cast<char>((value >> (8 * i)) & 0xFF);
+        }
+    }
+
+    uint32_t getU32(const unsigned char* p) {
+        return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8)
+               | (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+    }
+
+    uint64_t getU64(const unsigned char* p) {
+        return static_cast<uint64_t>(getU32(p)) | (static_cast<uint64_t>(getU32(p + 4)) << 32);
+    }
+
+    /**
+     * @brief 快照写入器
+     * 字符串经哈希去重后放入字符串表，出版社、作者等重复值只存一份
+     */
+    class SnapshotWriter {
+    private:
+        struct StringRef {
+            uint32_t offset;
+            uint32_t length;
+        };
+        // 由去重编号取字符串，供哈希索引比较键
+        struct StringOf {
+            const SnapshotWriter* owner;
+            std::string_view operator()(uint32_t index) const {
+                const StringRef& ref = owner->uniqueStrings[index];
+                return std::string_view(owner->table.data() + ref.offset, ref.length);
+            }
+        };
+
+        std::string table; //字符串表
+        MyVector<StringRef> uniqueStrings; //去重后的字符串位置
+        HashIndex<std::string_view, uint32_t, StringOf> stringIndex; //字符串 -> 去重编号
+        std::string columns; //按列存放的定长字段
+        size_t rowCount;
+        bool overflow = false;
+
+        StringRef intern(std::string_view value) {
+            const uint32_t* found = stringIndex.find(value);
+            if (found) {
+                return uniqueStrings[*found];
+            }
+            if (table.size() + value.size() > UINT32_MAX) {
+                overflow = true;
+                return StringRef{0, 0};
+            }
+            StringRef ref{static_cast<uint32_t>(table.size()), static_cast<uint32_t>(value.size())};
+            table += value;
+            uniqueStrings.push_back(ref);
+            stringIndex.insert(value, static_cast<uint32_t>(uniqueStrings.getSize() - 1));
+            return ref;
+        }
+
+    public:
+        explicit SnapshotWriter(size_t rowCount) : stringIndex(StringOf{this}), rowCount(rowCount) {}
+
+        // 按行号取值写出一列，get(i) 返回第 i 行的字段
+        template<typename Get>
+        void stringColumnAt(Get get) {
+            columns.reserve(columns.size() + rowCount * 8);
+            for (size_t i = 0; i < rowCount; ++i) {
+                StringRef ref = intern(get(i));
+                putU32(columns, ref.offset);
+                putU32(columns, ref.length);
+            }
+        }
+
+        template<typename Get>
+        void int32ColumnAt(Get get) {
+            columns.reserve(columns.size() + rowCount * 4);
+            for (size_t i = 0; i < rowCount; ++i) {
+                putU32(columns, static_cast<uint32_t>(static_cast<int32_t>(get(i))));
+            }
+        }
+
+        template<typename T, typename Get>
+        void stringColumn(const MyVector<T>& rows, Get get) {
+            stringColumnAt([&](size_t i) -> std::string_view { return get(rows[i]); });
+        }
+
+        template<typename T, typename Get>
+        void int32Column(const MyVector<T>& rows, Get get) {
+            int32ColumnAt([&](size_t i) { return get(rows[i]); });
+        }
+
+        template<typename T, typename Get>
+        void int64Column(const MyVector<T>& rows, Get get) {
+            columns.reserve(columns.size() + rowCount * 8);
+            for (size_t i = 0; i < rowCount; ++i) {
+                putU64(columns, static_cast<uint64_t>(static_cast<int64_t>(get(rows[i]))));
+            }
+        }
+
+        bool writeFile(const std::string& path, BinarySnapshot::Kind kind) const {
+            if (overflow) return false;
+            std::string header(MAGIC, sizeof(MAGIC));
+            putU32(header, BinarySnapshot::VERSION);
+            putU32(header, kind);
+            putU32(header, 0);
+            putU64(header, rowCount);
+            putU64(header, table.size());
+            uint32_t crc = Checksum::crc32(header.data(), header.size());
+            crc = Checksum::crc32(table.data(), table.size(), crc);
+            crc = Checksum::crc32(columns.data(), columns.size(), crc);
+            std::string footer;
+            putU32(footer, crc);
+
+            std::string tempPath = path + ".tmp";
+            std::FILE* file = std::fopen(tempPath.c_str(), "wb");
+            if (!file) return false;
+            bool ok = std::fwrite(header.data(), 1, header.size(), file) == header.size()
+                      && std::fwrite(table.data(), 1, table.size(), file) == table.size()
+                      && std::fwrite(columns.data(), 1, columns.size(), file) == columns.size()
+                      && std::fwrite(footer.data(), 1, footer.size(), file) == footer.size();
+            // 落盘后再改名，否则掉电时日志已被清空而快照仍是空文件
+            ok = std::fflush(file) == 0 && ok;
+#ifdef _WIN32
+            ok = _commit(_fileno(file)) == 0 && ok;
+#else
+            ok = fsync(fileno(file)) == 0 && ok;
+#endif
+            ok = std::fclose(file) == 0 && ok;
+            std::error_code error;
+            if (ok) {
+                std::filesystem::rename(tempPath, path, error);
+            }
+            if (!ok || error) {
+                std::filesystem::remove(tempPath, error);
+                return false;
+            }
+            return true;
+        }
+    };
+
+    bool readString(const BinarySnapshot::SnapshotView& view, const unsigned char* column, size_t row,
+                    std::string& value) {
+        std::string_view text;
+        if (!view.stringAt(column, row, text)) return false;
+        value.assign(text.data(), text.size());
+        return true;
+    }
+}
+
+bool BinarySnapshot::SnapshotView::open(const unsigned char* data, size_t size, Kind kind, bool verifyChecksum) {
+    bytes = nullptr;
+    rowCount = 0;
+    if (!data || size < HEADER_SIZE + CRC_SIZE) return false;
+    size_t crcOffset = size - CRC_SIZE;
+    if (verifyChecksum && Checksum::crc32(data, crcOffset) != getU32(data + crcOffset)) return false;
+    if (std::memcmp(data, MAGIC, sizeof(MAGIC)) != 0) return false;
+    if (getU32(data + 4) != VERSION || getU32(data + 8) != kind) return false;
+    uint64_t rows = getU64(data + 16);
+    uint64_t tableBytes = getU64(data + 24);
+    if (tableBytes > crcOffset - HEADER_SIZE || rows > crcOffset) return false;
+    bytes = data;
+    rowCount = static_cast<size_t>(rows);
+    tableSize = static_cast<size_t>(tableBytes);
+    cursor = HEADER_SIZE + tableSize;
+    columnsEnd = crcOffset;
+    return true;
+}
+
+const unsigned char* BinarySnapshot::SnapshotView::nextColumn(size_t width) {
+    if (!bytes || rowCount > (columnsEnd - cursor) / width) return nullptr;
+    const unsigned char* start = bytes + cursor;
+    cursor += rowCount * width;
+    return start;
+}
+
+bool BinarySnapshot::SnapshotView::stringAt(const unsigned char* column, size_t row, std::string_view& value) const {
+    uint64_t offset = getU32(column + row * 8);
+    uint64_t length = getU32(column + row * 8 + 4);
+    if (offset + length > tableSize) return false;
+    value = std::string_view(reinterpret_cast<const char*>(bytes + HEADER_SIZE + offset), static_cast<size_t>(length));
+    return true;
+}
+
+int32_t BinarySnapshot::SnapshotView::int32At(const unsigned char* column, size_t row) {
+    return static_cast<int32_t>(getU32(column + row * 4));
+}
+
+int64_t BinarySnapshot::SnapshotView::int64At(const unsigned char* column, size_t row) {
+    return static_cast<int64_t>(getU64(column + row * 8));
+}
+
+bool BinarySnapshot::isBinaryPath(const std::string& path) {
+    const std::string suffix = ".bin";
+    return path.size() >= suffix.size() && path.compare(path.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+bool BinarySnapshot::saveBooks(const std::string& path, const MyVector<Book>& books) {
+    SnapshotWriter writer(books.getSize());
+    writer.stringColumn(books, [](const Book& book) -> const std::string& { return book.getIsbn(); });
+    writer.stringColumn(books, [](const Book& book) -> const std::string& { return book.getTitle(); });
+    writer.stringColumn(books, [](const Book& book) -> const std::string& { return book.getAuthor(); });
+    writer.stringColumn(books, [](const Book& book) -> const std::string& { return book.getPublisher(); });
+    writer.int32Column(books, [](const Book& book) { return book.getPublishYear(); });
+    writer.int32Column(books, [](const Book& book) { return book.getStatus(); });
+    return writer.writeFile(path, BOOKS);
+}
+
+// 字段直接从映射或修改过的副本取出，不构造 Book
+bool BinarySnapshot::saveBooks(const std::string& path, const MappedCatalog& catalog) {
+    SnapshotWriter writer(catalog.getBookCount());
+    writer.stringColumnAt([&](size_t row) { return catalog.getIsbn(row); });
+    writer.stringColumnAt([&](size_t row) { return catalog.getTitle(row); });
+    writer.stringColumnAt([&](size_t row) { return catalog.getAuthor(row); });
+    writer.stringColumnAt([&](size_t row) { return catalog.getPublisher(row); });
+    writer.int32ColumnAt([&](size_t row) { return catalog.getPublishYear(row); });
+    writer.int32ColumnAt([&](size_t row) { return catalog.getStatus(row); });
+    return writer.writeFile(path, BOOKS);
+}
+
+bool BinarySnapshot::loadBooks(const std::string& path, MyVector<Book>& books) {
+    MappedFile file;
+    SnapshotView view;
+    if (!file.open(path) || !view.open(file.getData(), file.getSize(), BOOKS, true)) return false;
+    const unsigned char* isbns = view.nextColumn(8);
+    const unsigned char* titles = view.nextColumn(8);
+    const unsigned char* authors = view.nextColumn(8);
+    const unsigned char* publishers = view.nextColumn(8);
+    const unsigned char* years = view.nextColumn(4);
+    const unsigned char* statuses = view.nextColumn(4);
+    if (!isbns || !titles || !authors || !publishers || !years || !statuses || !view.finished()) return false;
+
+    size_t count = view.getRowCount();
+    MyVector<Book> result(count);
+    std::string isbn, title, author, publisher;
+    for (size_t i = 0; i < count; ++i) {
+        if (!readString(view, isbns, i, isbn) || !readString(view, titles, i, title)
+            || !readString(view, authors, i, author) || !readString(view, publishers, i, publisher)) {
+            return false;
+        }
+        Book& book = result.emplace_back(isbn, title, author, publisher, SnapshotView::int32At(years, i));
+        book.setStatus(SnapshotView::int32At(statuses, i));
+    }
+    books = std::move(result);
+    return true;
+}
+
+bool BinarySnapshot::saveUsers(const std::string& path, const MyVector<User>& users) {
+    SnapshotWriter writer(users.getSize());
+    writer.stringColumn(users, [](const User& user) -> const std::string& { return user.username; });
+    writer.stringColumn(users, [](const User& user) -> const std::string& { return user.password; });
+    writer.int32Column(users, [](const User& user) { return static_cast<int>(user.role); });
+    return writer.writeFile(path, USERS);
+}
+
+bool BinarySnapshot::loadUsers(const std::string& path, MyVector<User>& users) {
+    MappedFile file;
+    SnapshotView view;
+    if (!file.open(path) || !view.open(file.getData(), file.getSize(), USERS, true)) return false;
+    const unsigned char* usernames = view.nextColumn(8);
+    const unsigned char* passwords = view.nextColumn(8);
+    const unsigned char* roles = view.nextColumn(4);
+    if (!usernames || !passwords || !roles || !view.finished()) return false;
+
+    size_t count = view.getRowCount();
+    MyVector<User> result(count);
+    std::string username, password;
+    for (size_t i = 0; i < count; ++i) {
+        if (!readString(view, usernames, i, username) || !readString(view, passwords, i, password)) return false;
+        result.emplace_back(username, password, static_cast<Role>(SnapshotView::int32At(roles, i)));
+    }
+    users = std::move(result);
+    return true;
+}
+
+bool BinarySnapshot::saveBorrowRecords(const std::string& path, const MyVector<BorrowRecord>& records) {
+    SnapshotWriter writer(records.getSize());
+    writer.stringColumn(records, [](const BorrowRecord& record) -> const std::string& { return record.getIsbn(); });
+    writer.stringColumn(records, [](const BorrowRecord& record) -> const std::string& { return record.getUsername(); });
+    writer.int32Column(records, [](const BorrowRecord& record) { return record.getId(); });
+    writer.int64Column(records, [](const BorrowRecord& record) { return record.getBorrowDate(); });
+    writer.int64Column(records, [](const BorrowRecord& record) { return record.getDueDate(); });
+    writer.int64Column(records, [](const BorrowRecord& record) { return record.getReturnDate(); });
+    writer.int32Column(records, [](const BorrowRecord& record) { return record.getIsReturned() ? 1 : 0; });
+    return writer.writeFile(path, BORROW_RECORDS);
+}
+
+bool BinarySnapshot::loadBorrowRecords(const std::string& path, MyVector<BorrowRecord>& records) {
+    MappedFile file;
+    SnapshotView view;
+    if (!file.open(path) || !view.open(file.getData(), file.getSize(), BORROW_RECORDS, true)) return false;
+    const unsigned char* isbns = view.nextColumn(8);
+    const unsigned char* usernames = view.nextColumn(8);
+    const unsigned char* ids = view.nextColumn(4);
+    const unsigned char* borrowDates = view.nextColumn(8);
+    const unsigned char* dueDates = view.nextColumn(8);
+    const unsigned char* returnDates = view.nextColumn(8);
+    const unsigned char* returned = view.nextColumn(4);
+    if (!isbns || !usernames || !ids || !borrowDates || !dueDates || !returnDates || !returned
+        || !view.finished()) {
+        return false;
+    }
+
+    size_t count = view.getRowCount();
+    MyVector<BorrowRecord> result(count);
+    std::string isbn, username;
+    try {
+        for (size_t i = 0; i < count; ++i) {
+            if (!readString(view, isbns, i, isbn) || !readString(view, usernames, i, username)) return false;
+            int32_t id = SnapshotView::int32At(ids, i);
+            if (!BorrowRecord::isValidId(id)) return false;
+            BorrowRecord& record = result.emplace_back(id, isbn, username,
+                                                       static_cast<time_t>(SnapshotView::int64At(borrowDates, i)),
+                                                       static_cast<time_t>(SnapshotView::int64At(dueDates, i)));
+            time_t returnDate = static_cast<time_t>(SnapshotView::int64At(returnDates, i));
+            if (returnDate != 0) {
+                record.setReturnDate(returnDate);
+            }
+            record.setIsReturned(SnapshotView::int32At(returned, i) != 0);
+        }
+    } catch (const std::invalid_argument&) {
+        // 归还日期早于借阅日期，视为文件损坏
+        return false;
+    }
+    records = std::move(result);
+    return true;
+}
@@ -1,4 +1,5 @@
 #include "../include/Book.h"
+#include "../include/JsonStream.h"
 #include <QJsonObject>
 #include <QJsonDocument>
 #include <QString>
@@ -11,19 +12,19 @@ Book::Book(const std::string& isbn, const std::string& title,
                             author(author), publisher(publisher),
                             publishYear(publishYear) {}
 
-std::string Book::getIsbn() const { 
+const std::string& Book::getIsbn() const { 
     return isbn; 
 }
 
-std::string Book::getTitle() const { 
+const std::string& Book::getTitle() const { 
     return title; 
 }
 
-std::string Book::getAuthor() const { 
+const std::string& Book::getAuthor() const { 
     return author; 
 }
 
-std::string Book::getPublisher() const { 
+const std::string& Book::getPublisher() const { 
     return publisher; 
 }
 
@@ -105,4 +106,46 @@ void Book::fromJson(const QJsonObject& json) {
     if (json.contains("status")) {
         status = json["status"].toInt();
     }
-} 
+}
+
+void Book::writeJson(JsonWriter& writer) const {
+    writer.beginObject();
+    writer.key("isbn");
+    writer.value(isbn);
+    writer.key("title");
+    writer.value(title);
+    writer.key("author");
+    writer.value(author);
+    writer.key("publisher");
+    writer.value(publisher);
+    writer.key("publishYear");
+    writer.value(publishYear);
+    writer.key("status");
+    writer.value(status);
+    writer.endObject();
+}
+
+// 与 fromJson 一致：缺少的字段保持原值，类型不符的字段忽略
+bool Book::readJson(JsonReader& reader) {
+    JsonReader::Token token;
+    while ((token = reader.next()) == JsonReader::KEY) {
+        const std::string& name = reader.getKey();
+        token = reader.next();
+        if (token == JsonReader::STRING && name == "isbn") {
+            isbn = reader.getString();
+        } else if (token == JsonReader::STRING && name == "title") {
+            title = reader.getString();
+        } else if (token == JsonReader::STRING && name == "author") {
+            author = reader.getString();
+        } else if (token == JsonReader::STRING && name == "publisher") {
+            publisher = reader.getString();
+        } else if (token == JsonReader::NUMBER && name == "publishYear") {
+            publishYear = static_cast<int>(reader.getInteger());
+        } else if (token == JsonReader::NUMBER && name == "status") {
+            status = static_cast<int>(reader.getInteger());
+        } else if (!reader.skipValue(token)) {
+            return false;
+        }
+    }
+    return token == JsonReader::END_OBJECT;
+}
@@ -0,0 +1,244 @@
+#include "../include/BookImporter.h"
+#include "../include/MappedFile.h"
+#include "../include/Mysort.h"
+#include <atomic>
+#include <cstdio>
+#include <climits>
+#include <cstring>
+
+namespace {
+    // 每个线程至少处理的字节数，文件较小时少开线程
+    const size_t MIN_CHUNK_BYTES = 256 * 1024;
+    // 每处理这么多字节汇报一次进度
+    const size_t PROGRESS_BYTES = 1024 * 1024;
+
+    const std::string_view KEY_TITLE = "书名";
+    const std::string_view KEY_AUTHOR = "作者";
+    const std::string_view KEY_PUBLISHER = "出版社";
+    const std::string_view KEY_ISBN = "ISBN";
+    const std::string_view KEY_YEAR = "出版年限";
+
+    class LineParser {
+    private:
+        const char* p;
+        const char* end;
+
+    public:
+        explicit LineParser(std::string_view line) : p(line.data()), end(line.data() + line.size()) {}
+
+        void skipSpaces() {
+            while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) ++p;
+        }
+
+        bool consume(char c) {
+            skipSpaces();
+            if (p == end || *p != c) return false;
+            ++p;
+            return true;
+        }
+
+        bool peek(char c) {
+            skipSpaces();
+            return p < end && *p == c;
+        }
+
+        // 读取引号内的原文，hasEscape 表示其中是否有反斜杠
+        bool quoted(std::string_view& raw, bool& hasEscape) {
+            skipSpaces();
+            if (p == end || (*p != '\'' && *p != '"')) return false;
+            char quote = *p++;
+            const char* start = p;
+            hasEscape = false;
+            while (p < end && *p != quote) {
+                if (*p == '\\') {
+                    hasEscape = true;
+                    if (++p == end) return false;
+                }
+                ++p;
+            }
+            if (p == end) return false;
+            raw = std::string_view(start, static_cast<size_t>(p - start));
+            ++p;
+            return true;
+        }
+
+        bool integer(long long& value) {
+            skipSpaces();
+            bool negative = p < end && *p == '-';
+            if (negative) ++p;
+            if (p == end || *p < '0' || *p > '9') return false;
+            value = 0;
+            while (p < end && *p >= '0' && *p <= '9') {
+                if (value > 100000000000LL) return false;
+                value = value * 10 + (*p++ - '0');
+            }
+            if (negative) value = -value;
+            return true;
+        }
+
+        bool atEnd() {
+            skipSpaces();
+            return p == end;
+        }
+    };
+
+    // 还原 Python 字符串中的转义
+    std::string unescape(std::string_view raw) {
+        std::string out;
+        out.reserve(raw.size());
+        for (size_t i = 0; i < raw.size(); ++i) {
+            char c = raw[i];
+            if (c != '\\' || i + 1 == raw.size()) {
+                out += c;
+                continue;
+            }
+            switch (raw[++i]) {
+            case 'n': out += '\n'; break;
+            case 't': out += '\t'; break;
+            case 'r': out += '\r'; break;
+            default: out += raw[i]; break; // \\ \' \" 及其他
+            }
+        }
+        return out;
+    }
+
+    std::string toString(std::string_view raw, bool hasEscape) {
+        return hasEscape ? unescape(raw) : std::string(raw);
+    }
+}
+
+bool BookImporter::parseLine(std::string_view line, Book& book) {
+    LineParser parser(line);
+    if (!parser.consume('{')) return false;
+    std::string_view title, author, publisher, isbn;
+    bool titleEscaped = false, authorEscaped = false, publisherEscaped = false, isbnEscaped = false;
+    long long year = 0;
+    bool hasYear = false;
+    if (!parser.peek('}')) {
+        do {
+            std::string_view key, raw;
+            bool keyEscaped = false, escaped = false;
+            if (!parser.quoted(key, keyEscaped) || !parser.consume(':')) return false;
+            if (key == KEY_YEAR) {
+                if (!parser.integer(year)) return false;
+                hasYear = true;
+            } else if (parser.quoted(raw, escaped)) {
+                if (key == KEY_TITLE) { title = raw; titleEscaped = escaped; }
+                else if (key == KEY_AUTHOR) { author = raw; authorEscaped = escaped; }
+                else if (key == KEY_PUBLISHER) { publisher = raw; publisherEscaped = escaped; }
+                else if (key == KEY_ISBN) { isbn = raw; isbnEscaped = escaped; }
+            } else {
+                // 其他字段只允许是整数
+                long long ignored = 0;
+                if (!parser.integer(ignored)) return false;
+            }
+        } while (parser.consume(','));
+    }
+    if (!parser.consume('}') || !parser.atEnd()) return false;
+    if (title.empty() || author.empty() || publisher.empty() || isbn.empty() || !hasYear || year == 0) return false;
+    if (year < INT_MIN || year > INT_MAX) return false;
+
+    book = Book(toString(isbn, isbnEscaped), toString(title, titleEscaped), toString(author, authorEscaped),
+                toString(publisher, publisherEscaped), static_cast<int>(year));
+    return true;
+}
+
+bool BookImporter::parseFile(const std::string& path, MyVector<Book>& books, Stats& stats,
+                             unsigned threadCount, const Progress& progress) {
+    stats = Stats();
+    MappedFile file;
+    if (!file.open(path)) {
+        // 空文件无法映射，视为没有图书
+        std::FILE* probe = std::fopen(path.c_str(), "rb");
+        if (!probe) return false;
+        std::fclose(probe);
+        books = MyVector<Book>();
+        return true;
+    }
+    const char* data = reinterpret_cast<const char*>(file.getData());
+    size_t size = file.getSize();
+
+    if (threadCount == 0) {
+        threadCount = std::thread::hardware_concurrency();
+    }
+    size_t chunkCount = size / MIN_CHUNK_BYTES + 1;
+    if (chunkCount > threadCount) chunkCount = threadCount > 0 ? threadCount : 1;
+
+    // 块边界落在换行符之后，每行只属于一个块
+    MyVector<size_t> bounds(chunkCount + 1);
+    bounds.push_back(0);
+    for (size_t c = 1; c < chunkCount; ++c) {
+        size_t pos = size * c / chunkCount;
+        if (pos < bounds[c - 1]) pos = bounds[c - 1];
+        while (pos > 0 && pos < size && data[pos - 1] != '\n') ++pos;
+        bounds.push_back(pos);
+    }
+    bounds.push_back(size);
+
+    struct ChunkResult {
+        MyVector<Book> books;
+        Stats stats;
+    };
+    MyVector<ChunkResult> results(chunkCount);
+    for (size_t c = 0; c < chunkCount; ++c) {
+        results.emplace_back();
+    }
+    std::atomic<size_t> doneBytes{0};
+    std::atomic<bool> cancelled{false};
+
+    auto parseChunk = [&](size_t c) {
+        ChunkResult& result = results[c];
+        size_t pos = bounds[c];
+        size_t chunkEnd = bounds[c + 1];
+        // 按平均行长预留空间
+        result.books.reserve((chunkEnd - pos) / 96 + 1);
+        size_t reported = pos;
+        while (pos < chunkEnd && !cancelled.load(std::memory_order_relaxed)) {
+            const char* lineStart = data + pos;
+            const char* newline = static_cast<const char*>(std::memchr(lineStart, '\n', chunkEnd - pos));
+            size_t lineEnd = newline ? static_cast<size_t>(newline - data) : chunkEnd;
+            std::string_view line(lineStart, lineEnd - pos);
+            pos = lineEnd + 1;
+            while (!line.empty() && (line.back() == '\r' || line.back() == ' ')) line.remove_suffix(1);
+            if (line.empty()) continue;
+            ++result.stats.lineCount;
+            Book book;
+            if (parseLine(line, book)) {
+                result.books.push_back(std::move(book));
+                ++result.stats.bookCount;
+            } else {
+                ++result.stats.skippedCount;
+            }
+            if (progress && pos - reported >= PROGRESS_BYTES) {
+                size_t total = doneBytes.fetch_add(pos - reported) + (pos - reported);
+                reported = pos;
+                if (!progress(total, size)) cancelled.store(true);
+            }
+        }
+        if (progress && pos > reported) {
+            size_t end = pos < chunkEnd ? pos : chunkEnd;
+            size_t total = doneBytes.fetch_add(end - reported) + (end - reported);
+            if (!progress(total, size)) cancelled.store(true);
+        }
+    };
+    MyAlgorithm::detail::runParallel(chunkCount, parseChunk);
+    if (cancelled.load()) return false;
+
+    // 按文件顺序拼接各块结果
+    size_t total = 0;
+    for (size_t c = 0; c < chunkCount; ++c) {
+        total += results[c].books.getSize();
+    }
+    MyVector<Book> merged(total);
+    for (size_t c = 0; c < chunkCount; ++c) {
+        MyVector<Book>& chunkBooks = results[c].books;
+        for (size_t i = 0; i < chunkBooks.getSize(); ++i) {
+            merged.push_back(std::move(chunkBooks[i]));
+        }
+        stats.lineCount += results[c].stats.lineCount;
+        stats.bookCount += results[c].stats.bookCount;
+        stats.skippedCount += results[c].stats.skippedCount;
+    }
+    books = std::move(merged);
+    return true;
+}
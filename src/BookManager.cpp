@@ -1,55 +1,263 @@
 #include "../include/BookManager.h"
 #include <iterator>
 #include "../include/Mysort.h"
+#include "../include/BinarySnapshot.h"
+#include "../include/JsonStream.h"
+#include "../include/BookImporter.h"
+#include "../include/TextTokenizer.h"
 #include <fstream>
 #include <sstream>
 #include <iomanip>
 #include <iostream>
 #include <cstring>
 #include <QFile>
-#include <QJsonArray>
-#include <QJsonDocument>
-#include <QJsonObject>
-#include <QJsonValue>
 #include <QDebug>
 
+BookManager::BookManager() : books(std::make_shared<MyVector<Book>>()), isbnIndex(IsbnOf{this}) {}
+
+int BookManager::indexOfIsbn(const std::string& isbn) const {
+    const uint32_t* index = isbnIndex.find(isbn);
+    return index ? static_cast<int>(*index) : -1;
+}
+
+// 写入前调用：当前版本仍被视图持有时复制出新版本，已发布的版本保持不变
+void BookManager::detachBooks() {
+    if (books.use_count() > 1) {
+        books = std::make_shared<MyVector<Book>>(*books);
+    }
+}
+
+void BookManager::appendBook(const Book& book) {
+    detachBooks();
+    markModified();
+    books->push_back(book);
+    isbnIndex.insert(book.getIsbn(), static_cast<uint32_t>(books->getSize() - 1));
+    indexBook(static_cast<uint32_t>(books->getSize() - 1), book);
+    addCompletions(books->getSize() - 1);
+}
+
 void BookManager::addBook(const Book& book) {
-    books.push_back(book);
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    appendBook(book);
+}
+
+void BookManager::rebuildIndex() {
+    isbnIndex.clear();
+    isbnIndex.reserve(books->getSize());
+    for (size_t f = 0; f < TEXT_FIELD_COUNT; ++f) {
+        tokenIndexes[f].clear();
+        trigramIndexes[f].clear();
+    }
+    yearIndex.clear();
+    for (size_t f = 0; f < COMPLETION_FIELD_COUNT; ++f) {
+        prefixIndexes[f].clear();
+    }
+    for (size_t i = 0; i < books->getSize(); ++i) {
+        isbnIndex.insert((*books)[i].getIsbn(), static_cast<uint32_t>(i));
+        indexBook(static_cast<uint32_t>(i), (*books)[i]);
+    }
+    addCompletions(0);
+}
+
+const std::string& BookManager::fieldText(const Book& book, TextField field) {
+    switch (field) {
+    case TextField::AUTHOR:
+        return book.getAuthor();
+    case TextField::PUBLISHER:
+        return book.getPublisher();
+    default:
+        return book.getTitle();
+    }
+}
+
+// 把字段文本的词和三元组登记到该字段的索引
+void BookManager::indexField(TextField field, uint32_t id, std::string_view text) {
+    InvertedIndex& tokens = tokenIndexes[static_cast<size_t>(field)];
+    InvertedIndex& trigrams = trigramIndexes[static_cast<size_t>(field)];
+    TextTokenizer::forEachWord(text, [&tokens, id](std::string_view word) { tokens.add(word, id); });
+    TextTokenizer::forEachTrigram(text, [&trigrams, id](std::string_view gram) { trigrams.add(gram, id); });
 }
 
-void BookManager::addBookNoRebuild(const Book& book) {
-    books.push_back_no_rebuild(book);
+void BookManager::unindexField(TextField field, uint32_t id, std::string_view text) {
+    InvertedIndex& tokens = tokenIndexes[static_cast<size_t>(field)];
+    InvertedIndex& trigrams = trigramIndexes[static_cast<size_t>(field)];
+    TextTokenizer::forEachWord(text, [&tokens, id](std::string_view word) { tokens.erase(word, id); });
+    TextTokenizer::forEachTrigram(text, [&trigrams, id](std::string_view gram) { trigrams.erase(gram, id); });
 }
 
-void BookManager::rebuildBookHashTable() {
-    books.rebuildBookHashTable();
+void BookManager::indexBook(uint32_t id, const Book& book) {
+    for (size_t f = 0; f < TEXT_FIELD_COUNT; ++f) {
+        TextField field = static_cast<TextField>(f);
+        indexField(field, id, fieldText(book, field));
+    }
+    yearIndex.add(book.getPublishYear(), id);
+}
+
+void BookManager::unindexBook(uint32_t id, const Book& book) {
+    for (size_t f = 0; f < TEXT_FIELD_COUNT; ++f) {
+        TextField field = static_cast<TextField>(f);
+        unindexField(field, id, fieldText(book, field));
+    }
+    yearIndex.erase(book.getPublishYear(), id);
+}
+
+void BookManager::reindexBook(uint32_t id, const Book& before, const Book& after) {
+    for (size_t f = 0; f < TEXT_FIELD_COUNT; ++f) {
+        TextField field = static_cast<TextField>(f);
+        if (fieldText(before, field) == fieldText(after, field)) continue;
+        unindexField(field, id, fieldText(before, field));
+        indexField(field, id, fieldText(after, field));
+    }
+    if (before.getPublishYear() != after.getPublishYear()) {
+        yearIndex.erase(before.getPublishYear(), id);
+        yearIndex.add(after.getPublishYear(), id);
+    }
+}
+
+const std::string& BookManager::completionText(const Book& book, CompletionField field) {
+    if (field == CompletionField::ISBN) {
+        return book.getIsbn();
+    }
+    return fieldText(book, static_cast<TextField>(field));
+}
+
+void BookManager::addCompletions(size_t from) {
+    size_t total = books->getSize();
+    if (from >= total) return;
+    for (size_t f = 0; f < COMPLETION_FIELD_COUNT; ++f) {
+        MyVector<std::string_view> texts(total - from);
+        for (size_t i = from; i < total; ++i) {
+            texts.push_back(completionText((*books)[i], static_cast<CompletionField>(f)));
+        }
+        prefixIndexes[f].addAll(texts);
+    }
+}
+
+void BookManager::removeCompletions(const Book& book) {
+    for (size_t f = 0; f < COMPLETION_FIELD_COUNT; ++f) {
+        prefixIndexes[f].erase(completionText(book, static_cast<CompletionField>(f)));
+    }
+}
+
+// ISBN 不会被修改，只比较文本字段
+void BookManager::updateCompletions(const Book& before, const Book& after) {
+    for (size_t f = 0; f < TEXT_FIELD_COUNT; ++f) {
+        TextField field = static_cast<TextField>(f);
+        if (fieldText(before, field) == fieldText(after, field)) continue;
+        prefixIndexes[f].erase(fieldText(before, field));
+        prefixIndexes[f].add(fieldText(after, field));
+    }
+}
+
+MyVector<std::string> BookManager::getCompletions(CompletionField field, const std::string& prefix, size_t limit) const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return prefixIndexes[static_cast<size_t>(field)].complete(prefix, limit);
+}
+
+// 有序下标表中小于 id 的个数
+static uint32_t countBelow(const MyVector<uint32_t>& sorted, uint32_t id) {
+    size_t left = 0;
+    size_t right = sorted.getSize();
+    while (left < right) {
+        size_t mid = left + (right - left) / 2;
+        if (sorted[mid] < id) {
+            left = mid + 1;
+        } else {
+            right = mid;
+        }
+    }
+    return static_cast<uint32_t>(left);
+}
+
+void BookManager::eraseBooks(const MyVector<uint32_t>& removed) {
+    if (removed.getSize() == 0) return;
+    detachBooks();
+    markModified();
+    // 先按旧下标从各索引中摘除，ISBN 索引的键取自图书数组，须在压紧前删除
+    for (size_t r = 0; r < removed.getSize(); ++r) {
+        const Book& book = (*books)[removed[r]];
+        isbnIndex.erase(book.getIsbn());
+        unindexBook(removed[r], book);
+        removeCompletions(book);
+    }
+    MyVector<Book> kept(books->getSize() - removed.getSize());
+    size_t next = 0;
+    for (size_t i = 0; i < books->getSize(); ++i) {
+        if (next < removed.getSize() && removed[next] == i) {
+            ++next;
+            continue;
+        }
+        kept.push_back(std::move((*books)[i]));
+    }
+    *books = std::move(kept);
+    // 后续图书前移，每个下标减去排在它前面的已删除图书数
+    isbnIndex.updateValues([&removed](uint32_t& i) { i -= countBelow(removed, i); });
+    for (size_t f = 0; f < TEXT_FIELD_COUNT; ++f) {
+        tokenIndexes[f].shiftDown(removed);
+        trigramIndexes[f].shiftDown(removed);
+    }
+    yearIndex.shiftDown(removed);
 }
 
 bool BookManager::removeBook(const std::string& isbn) {
-    int index = books.hashFindByIsbn(isbn);
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    int index = indexOfIsbn(isbn);
     if (index >= 0) {
-        books.removeAt(index);
+        MyVector<uint32_t> removed(1);
+        removed.push_back(static_cast<uint32_t>(index));
+        eraseBooks(removed);
         return true;
     }
     return false;
 }
 
+size_t BookManager::removeBooks(const MyVector<std::string>& isbns) {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    MyVector<uint32_t> removed(isbns.getSize());
+    for (size_t i = 0; i < isbns.getSize(); ++i) {
+        int index = indexOfIsbn(isbns[i]);
+        if (index >= 0) {
+            removed.push_back(static_cast<uint32_t>(index));
+        }
+    }
+    if (removed.getSize() == 0) return 0;
+    // 升序去重，同一 ISBN 传入多次只删一次
+    MyAlgorithm::sort(&removed[0], removed.getSize(), [](uint32_t a, uint32_t b) { return a < b; });
+    size_t unique = 1;
+    for (size_t i = 1; i < removed.getSize(); ++i) {
+        if (removed[i] != removed[unique - 1]) {
+            removed[unique++] = removed[i];
+        }
+    }
+    MyVector<uint32_t> distinct(unique);
+    for (size_t i = 0; i < unique; ++i) {
+        distinct.push_back(removed[i]);
+    }
+    eraseBooks(distinct);
+    return unique;
+}
+
 bool BookManager::updateBook(const std::string& isbn, const Book& updatedBook) {
-    int index = books.hashFindByIsbn(isbn);
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    int index = indexOfIsbn(isbn);
     if (index >= 0 && updatedBook.getIsbn() == isbn) {
-        books[index] = updatedBook;
-        if (!(updatedBook.getIsbn() == isbn)){
-            books.rebuildBookHashTable();
-        }
+        detachBooks();
+        markModified();
+        reindexBook(static_cast<uint32_t>(index), (*books)[index], updatedBook);
+        updateCompletions((*books)[index], updatedBook);
+        (*books)[index] = updatedBook;
         return true;
     }
     return false;
 }
 
 bool BookManager::updateBookStatus(const std::string& isbn,int status){
-    int index = books.hashFindByIsbn(isbn);
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    int index = indexOfIsbn(isbn);
     if (index >= 0) {
-        books[index].setStatus(status);
+        detachBooks();
+        markStatusModified();
+        (*books)[index].setStatus(status);
         return true;
     }
     return false;
@@ -57,21 +265,27 @@ bool BookManager::updateBookStatus(const std::string& isbn,int status){
 
 
 bool BookManager::updateBookField(const std::string& isbn, const std::string& field, const std::string& newValue) {
-    int index = books.hashFindByIsbn(isbn);
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    int index = indexOfIsbn(isbn);
     if (index >= 0) {
+        detachBooks();
+        Book before = (*books)[index];
         try {
             if (field == "title") {
-                books[index].setTitle(newValue);
+                (*books)[index].setTitle(newValue);
             } else if (field == "author") {
-                books[index].setAuthor(newValue);
+                (*books)[index].setAuthor(newValue);
             } else if (field == "publisher") {
-                books[index].setPublisher(newValue);
+                (*books)[index].setPublisher(newValue);
             } else if (field == "year") {
                 int year = std::stoi(newValue);
-                books[index].setPublishYear(year);
+                (*books)[index].setPublishYear(year);
             } else {
                 return false;
             }
+            reindexBook(static_cast<uint32_t>(index), before, (*books)[index]);
+            updateCompletions(before, (*books)[index]);
+            markModified();
             return true;
         } catch (const std::exception&) {
             return false;
@@ -81,102 +295,194 @@ bool BookManager::updateBookField(const std::string& isbn, const std::string& fi
 }
 
 Book* BookManager::findBookByIsbn(const std::string& isbn) {
-    auto getIsbn = [](const Book& book) -> std::string { return book.getIsbn(); };
-    auto comp = [](const std::string& a, const std::string& b) { return a < b; };
-    int index = books.hashFindByIsbn(isbn);
-    return index >= 0 ? &books[index] : nullptr;
+    int index = indexOfIsbn(isbn);
+    return index >= 0 ? &(*books)[index] : nullptr;
 }
 
-MyVector<Book> BookManager::findBooksByPublisher(const std::string& publisher) {
-    MyVector<Book> result;
-    for (size_t i = 0; i < books.getSize(); ++i) {
-        const Book& book = books[i];
-        if (book.getPublisher().find(publisher) != std::string::npos) {
-            result.add(book);
-        }
+CatalogSnapshot BookManager::snapshot() const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return currentSnapshot();
+}
+
+bool BookManager::findBook(const std::string& isbn, Book& book) const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    int index = indexOfIsbn(isbn);
+    if (index < 0) {
+        return false;
     }
-    return result;
+    book = (*books)[index];
+    return true;
+}
+
+MyVector<Book> BookManager::findBooksByPublisher(const std::string& publisher) {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return booksAt(findSubstring(TextField::PUBLISHER, publisher));
 }
 
 MyVector<Book> BookManager::findBooksByYear(int year) {
-    // 1. 拷贝一份 books
-    MyVector<Book> sortedBooks = books;
-    // 2. 排序
-    auto comp = [](const Book& a, const Book& b) { return a.getPublishYear() < b.getPublishYear(); };
-    if (sortedBooks.getSize() > 1) {
-        MyAlgorithm::sort(&sortedBooks[0], static_cast<int>(sortedBooks.getSize()), comp);
-    }
-    // 3. 二分查找
-    MyVector<Book> result;
-    auto getYear = [](const Book& book) -> int { return book.getPublishYear(); };
-    auto yearComp = [](const int a, const int b) { return a < b; };
-    int index = sortedBooks.binarySearch(year, getYear, yearComp);
-    if (index >= 0) {
-        int left = index, right = index;
-        while (left >= 0 && sortedBooks[left].getPublishYear() == year) {
-            result.push_back(sortedBooks[left]);
-            --left;
-        }
-        while (right < sortedBooks.getSize() && sortedBooks[right].getPublishYear() == year) {
-            if (right > index) {
-                result.push_back(sortedBooks[right]);
-            }
-            ++right;
-        }
-    }
-    return result;
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return booksAt(yearIndex.range(year, year));
 }
 
 MyVector<Book> BookManager::findBooksByYearRange(int startYear, int endYear) {
-    MyVector<Book> result;
-    auto getYear = [](const Book& book) -> int { return book.getPublishYear(); };
-    auto comp = [](const int a, const int b) { return a < b; };
-    int startIndex = books.binarySearch(startYear, getYear, comp);
-    if (startIndex < 0) {
-        startIndex = 0;
-    }
-    for (int i = startIndex; i < books.getSize(); ++i) {
-        int year = books[i].getPublishYear();
-        if (year > endYear) break;
-        if (year >= startYear) {
-            result.push_back(books[i]);
-        }
-    }
-    return result;
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return booksAt(yearIndex.range(startYear, endYear));
 }
 
 const MyVector<Book>& BookManager::getAllBooks() const {
-    return books;
+    return *books;
 }
 
 MyVector<Book> BookManager::findBooksByTitle(const std::string& title) {
-    MyVector<Book> result;
-    for (size_t i = 0; i < books.getSize(); ++i) {
-        const Book& book = books[i];
-        if (book.getTitle().find(title) != std::string::npos) {
-            result.add(book);
-        }
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return booksAt(findSubstring(TextField::TITLE, title));
+}
+
+MyVector<Book> BookManager::findBooksByAuthor(const std::string& author) {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return booksAt(findSubstring(TextField::AUTHOR, author));
+}
+
+MyVector<Book> BookManager::booksAt(const MyVector<uint32_t>& ids) const {
+    MyVector<Book> result(ids.getSize());
+    for (size_t i = 0; i < ids.getSize(); ++i) {
+        result.emplace_back((*books)[ids[i]]);
     }
     return result;
+}
 
+// 倒排表按长度升序排列后依次求交集
+static MyVector<uint32_t> intersectAll(MyVector<const MyVector<uint32_t>*>& lists) {
+    MyAlgorithm::sort(&lists[0], lists.getSize(), [](const MyVector<uint32_t>* a, const MyVector<uint32_t>* b) {
+        return a->getSize() < b->getSize();
+    });
+    MyVector<uint32_t> result = *lists[0];
+    for (size_t i = 1; i < lists.getSize() && result.getSize() > 0; ++i) {
+        InvertedIndex::intersect(result, *lists[i]);
+    }
+    return result;
 }
 
-MyVector<Book> BookManager::findBooksByAuthor(const std::string& author) {
-    MyVector<Book> result;
-    for (size_t i = 0; i < books.getSize(); ++i) {
-        const Book& book = books[i];
-        if (book.getAuthor().find(author) != std::string::npos) {
-            result.add(book);
+/**
+ * @brief 子串检索的候选倒排表
+ * 含 needle 的文本必然含有 needle 的每个三元组，这些三元组的倒排表之交即为候选，
+ * 候选还须逐个用 find 核对（三元组都在但不相邻的情况由核对排除）。
+ * 不足三个码点时：全为汉字等非 ASCII 字符则用分词索引中各单字的倒排表；
+ * 为空、含 ASCII 字符（分词索引按整词、小写，无法用于子串）或不是合法 UTF-8 时索引用不上。
+ * @return false 表示须逐本扫描；true 且 lists 为空表示没有图书含 needle
+ */
+bool BookManager::substringCandidates(TextField field, const std::string& needle,
+                                      MyVector<const MyVector<uint32_t>*>& lists) const {
+    if (needle.empty() || !TextTokenizer::isWellFormed(needle)) {
+        return false;
+    }
+    bool missing = false;
+    const InvertedIndex& trigrams = trigramIndexes[static_cast<size_t>(field)];
+    TextTokenizer::forEachTrigram(needle, [&](std::string_view gram) {
+        const MyVector<uint32_t>* postings = trigrams.find(gram);
+        if (postings) lists.push_back(postings);
+        else missing = true;
+    });
+    if (lists.getSize() == 0 && !missing) {
+        bool indexed = true;
+        const InvertedIndex& tokens = tokenIndexes[static_cast<size_t>(field)];
+        TextTokenizer::forEachCodePoint(needle, [&](std::string_view codePoint) {
+            if (static_cast<unsigned char>(codePoint[0]) < 0x80) {
+                indexed = false;
+                return;
+            }
+            const MyVector<uint32_t>* postings = tokens.find(codePoint);
+            if (postings) lists.push_back(postings);
+            else missing = true;
+        });
+        if (!indexed) {
+            lists.clear();
+            return false;
+        }
+    }
+    if (missing) {
+        lists.clear();
+    }
+    return true;
+}
+
+MyVector<uint32_t> BookManager::findSubstring(TextField field, const std::string& needle) const {
+    MyVector<uint32_t> result;
+    MyVector<const MyVector<uint32_t>*> lists;
+    if (!substringCandidates(field, needle, lists)) {
+        for (size_t i = 0; i < books->getSize(); ++i) {
+            if (fieldText((*books)[i], field).find(needle) != std::string::npos) {
+                result.push_back(static_cast<uint32_t>(i));
+            }
+        }
+        return result;
+    }
+    if (lists.getSize() == 0) {
+        return result;
+    }
+    MyVector<uint32_t> candidates = intersectAll(lists);
+    result.reserve(candidates.getSize());
+    for (size_t i = 0; i < candidates.getSize(); ++i) {
+        if (fieldText((*books)[candidates[i]], field).find(needle) != std::string::npos) {
+            result.push_back(candidates[i]);
         }
     }
     return result;
 }
 
+/**
+ * @brief 各检索词的倒排表求交集或并集
+ * 求交集时从最短的表开始，结果只会越来越短，其余表用倍增查找跳过不相交的部分
+ */
+MyVector<uint32_t> BookManager::searchTokens(TextField field, const std::string& query, TermMatch match) const {
+    const InvertedIndex& index = tokenIndexes[static_cast<size_t>(field)];
+    MyVector<const MyVector<uint32_t>*> lists;
+    bool missing = false;
+    TextTokenizer::forEachWord(query, [&](std::string_view word) {
+        const MyVector<uint32_t>* postings = index.find(word);
+        if (postings) {
+            lists.push_back(postings);
+        } else {
+            missing = true;
+        }
+    });
+    if (lists.getSize() == 0 || (match == TermMatch::ALL && missing)) {
+        return MyVector<uint32_t>();
+    }
+    if (match == TermMatch::ANY) {
+        MyVector<uint32_t> result = *lists[0];
+        for (size_t i = 1; i < lists.getSize(); ++i) {
+            result = InvertedIndex::unite(result, *lists[i]);
+        }
+        return result;
+    }
+    return intersectAll(lists);
+}
+
+MyVector<uint32_t> BookManager::searchBookIds(TextField field, const std::string& query, TermMatch match,
+                                              CatalogSnapshot* snapshot) const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    if (snapshot) {
+        *snapshot = currentSnapshot();
+    }
+    return searchTokens(field, query, match);
+}
+
+MyVector<Book> BookManager::searchBooks(TextField field, const std::string& query, TermMatch match) const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return booksAt(searchTokens(field, query, match));
+}
+
 size_t BookManager::getBookCount() const {
-    return books.getSize();
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return books->getSize();
 }
 
+// 降序时交换参数比较，保持严格弱序（排序算法依赖这一点）
 static bool compareBooks(const Book& a, const Book& b, SortBy sortBy, SortOrder order) {
+    if (order == SortOrder::DESCENDING) {
+        return compareBooks(b, a, sortBy, SortOrder::ASCENDING);
+    }
     bool result;
     switch (sortBy) {
         case SortBy::ISBN:
@@ -197,95 +503,468 @@ static bool compareBooks(const Book& a, const Book& b, SortBy sortBy, SortOrder
         default:
             result = false;
     }
-    return order == SortOrder::ASCENDING ? result : !result;
+    return result;
 }
 
-void BookManager::sortBooks(MyVector<Book>& bookList, SortBy sortBy, SortOrder order) const {
-    size_t length = bookList.getSize();
-    if (length <= 1) return;
-    Book* arr = new Book[length];
-    for (size_t i = 0; i < length; ++i) {
-        arr[i] = bookList[i];
-    }
-    auto comp = [sortBy, order](const Book& a, const Book& b) -> bool {
-        return compareBooks(a, b, sortBy, order);
+/**
+ * @brief 图书下标的比较函数
+ * 键相同时按下标升序，构成全序，结果顺序确定；降序是升序整体反转
+ */
+static auto bookIndexLess(const MyVector<Book>& bookList, SortBy sortBy, SortOrder order) {
+    bool descending = order == SortOrder::DESCENDING;
+    return [&bookList, sortBy, descending](uint32_t a, uint32_t b) -> bool {
+        if (descending) std::swap(a, b);
+        if (compareBooks(bookList[a], bookList[b], sortBy, SortOrder::ASCENDING)) return true;
+        if (compareBooks(bookList[b], bookList[a], sortBy, SortOrder::ASCENDING)) return false;
+        return a < b;
     };
-    MyAlgorithm::sort(arr, length, comp);
+}
+
+static MyVector<uint32_t> identityIndices(size_t length) {
+    MyVector<uint32_t> indices(length);
     for (size_t i = 0; i < length; ++i) {
-        bookList[i] = arr[i];
+        indices.push_back(static_cast<uint32_t>(i));
+    }
+    return indices;
+}
+
+/**
+ * @brief 对图书下标排序，图书本身不移动
+ * 交换的只是 4 字节下标
+ * @return bookList 的一个排列，第 i 个元素是排在第 i 位的图书下标
+ */
+MyVector<uint32_t> BookManager::sortIndices(const MyVector<Book>& bookList, SortBy sortBy, SortOrder order) {
+    size_t length = bookList.getSize();
+    MyVector<uint32_t> indices = identityIndices(length);
+    if (length <= 1) return indices;
+    // 数据量大时分块并行，小数组自动退回单线程
+    MyAlgorithm::parallelSort(&indices[0], length, bookIndexLess(bookList, sortBy, order));
+    return indices;
+}
+
+/**
+ * @brief 取某一列的升序下标，缓存失效时才重新排序
+ * 降序直接倒序遍历同一份结果，不单独缓存
+ */
+const MyVector<uint32_t>& BookManager::sortedOrder(SortBy sortBy) const {
+    SortCache& cache = sortCaches[static_cast<size_t>(sortBy)];
+    if (cache.generation != sortGeneration) {
+        cache.order = sortIndices(*books, sortBy, SortOrder::ASCENDING);
+        cache.generation = sortGeneration;
+    }
+    return cache.order;
+}
+
+/**
+ * @brief 分页取排序结果
+ * 缓存有效时直接切片；缓存失效且只要前几页时，本代数的第一次请求只做
+ * 部分排序（先 nthElement 定位 offset，再对其后做 O(N log limit) 的堆选择），
+ * 同一代数再次请求才完整排序并缓存，避免只看首页也付出 O(N log N)。
+ */
+MyVector<uint32_t> BookManager::getSortedPageIndices(SortBy sortBy, SortOrder order, size_t offset, size_t limit,
+                                                     CatalogSnapshot* snapshot) const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    if (snapshot) {
+        *snapshot = currentSnapshot();
     }
-    delete[] arr;
+    return sortedPageIndices(sortBy, order, offset, limit);
+}
+
+MyVector<uint32_t> BookManager::sortedPageIndices(SortBy sortBy, SortOrder order, size_t offset, size_t limit) const {
+    size_t total = books->getSize();
+    size_t begin = offset < total ? offset : total;
+    size_t end = limit < total - begin ? begin + limit : total;
+    MyVector<uint32_t> page(end - begin);
+    if (begin == end) return page;
+
+    // 部分排序只用本地下标，登记代数后即可放开缓存锁
+    std::unique_lock<std::mutex> cacheLock(cacheMutex);
+    SortCache& cache = sortCaches[static_cast<size_t>(sortBy)];
+    if (cache.generation != sortGeneration && cache.selectGeneration != sortGeneration
+        && end <= total / PARTIAL_SORT_RATIO) {
+        cache.selectGeneration = sortGeneration;
+        cacheLock.unlock();
+        MyVector<uint32_t> indices = identityIndices(total);
+        auto comp = bookIndexLess(*books, sortBy, order);
+        if (begin > 0) {
+            MyAlgorithm::nthElement(&indices[0], total, begin, comp);
+        }
+        MyAlgorithm::partialSort(&indices[begin], total - begin, end - begin, comp);
+        for (size_t i = begin; i < end; ++i) {
+            page.push_back(indices[i]);
+        }
+        return page;
+    }
+
+    const MyVector<uint32_t>& ascending = sortedOrder(sortBy);
+    for (size_t i = begin; i < end; ++i) {
+        page.push_back(order == SortOrder::ASCENDING ? ascending[i] : ascending[total - 1 - i]);
+    }
+    return page;
+}
+
+MyVector<Book> BookManager::getSortedPage(SortBy sortBy, SortOrder order, size_t offset, size_t limit) const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    MyVector<uint32_t> indices = sortedPageIndices(sortBy, order, offset, limit);
+    MyVector<Book> page(indices.getSize());
+    for (size_t i = 0; i < indices.getSize(); ++i) {
+        page.emplace_back((*books)[indices[i]]);
+    }
+    return page;
+}
+
+MyVector<uint32_t> BookManager::getSortedIndices(SortBy sortBy, SortOrder order) const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return sortedPageIndices(sortBy, order, 0, books->getSize());
 }
 
 MyVector<Book> BookManager::getSortedBooks(SortBy sortBy, SortOrder order) const {
-    MyVector<Book> sortedBooks = books;
-    sortBooks(sortedBooks, sortBy, order);
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    MyVector<uint32_t> indices = sortedPageIndices(sortBy, order, 0, books->getSize());
+    MyVector<Book> sortedBooks(indices.getSize());
+    for (size_t i = 0; i < indices.getSize(); ++i) {
+        sortedBooks.emplace_back((*books)[indices[i]]);
+    }
     return sortedBooks;
 }
 
 MyVector<Book> BookManager::sortSearchResults(const MyVector<Book>& searchResults, SortBy sortBy, SortOrder order) const {
-    MyVector<Book> sortedResults = searchResults;
-    sortBooks(sortedResults, sortBy, order);
+    MyVector<uint32_t> indices = sortIndices(searchResults, sortBy, order);
+    MyVector<Book> sortedResults(indices.getSize());
+    for (size_t i = 0; i < indices.getSize(); ++i) {
+        sortedResults.emplace_back(searchResults[indices[i]]);
+    }
     return sortedResults;
 }
 
-bool BookManager::importBooksFromFile(const std::string& filename) {
-    std::ifstream file(filename);
-    if (!file.is_open()) {
-        std::cerr << "无法打开文件: " << filename << std::endl;
-        return false;
+static TextField textFieldOf(QueryCondition::Field field) {
+    return static_cast<TextField>(field);
+}
+
+size_t BookManager::estimateMatches(const QueryCondition& condition) const {
+    size_t total = books->getSize();
+    const MyVector<QueryCondition>& children = condition.getChildren();
+    switch (condition.getKind()) {
+    case QueryCondition::Kind::CONTAINS:
+    case QueryCondition::Kind::EQUALS: {
+        if (condition.getField() == QueryCondition::Field::ISBN) {
+            if (condition.getKind() == QueryCondition::Kind::CONTAINS) return total;
+            return isbnIndex.find(condition.getText()) ? 1 : 0;
+        }
+        MyVector<const MyVector<uint32_t>*> lists;
+        if (!substringCandidates(textFieldOf(condition.getField()), condition.getText(), lists)) return total;
+        // 候选不超过最短的倒排表
+        size_t smallest = lists.getSize() > 0 ? lists[0]->getSize() : 0;
+        for (size_t i = 1; i < lists.getSize(); ++i) {
+            smallest = std::min(smallest, lists[i]->getSize());
+        }
+        return smallest;
+    }
+    case QueryCondition::Kind::YEAR_RANGE:
+        return yearIndex.count(condition.getLow(), condition.getHigh());
+    case QueryCondition::Kind::AND: {
+        size_t smallest = total;
+        for (size_t i = 0; i < children.getSize(); ++i) {
+            smallest = std::min(smallest, estimateMatches(children[i]));
+        }
+        return smallest;
+    }
+    case QueryCondition::Kind::OR: {
+        size_t sum = 0;
+        for (size_t i = 0; i < children.getSize() && sum < total; ++i) {
+            sum += estimateMatches(children[i]);
+        }
+        return std::min(sum, total);
+    }
+    default:
+        return total;
+    }
+}
+
+std::unique_ptr<IdStream> BookManager::planStream(const QueryCondition& condition) const {
+    size_t total = books->getSize();
+    const MyVector<Book>& list = *books;
+    // 全表扫描，逐本判断整个条件
+    auto scan = [&list, total](const QueryCondition& whole) -> std::unique_ptr<IdStream> {
+        return std::make_unique<FilterStream>(std::make_unique<RangeStream>(total),
+                                              [&list, &whole](uint32_t id) { return whole.matches(list[id]); });
+    };
+    const MyVector<QueryCondition>& children = condition.getChildren();
+    switch (condition.getKind()) {
+    case QueryCondition::Kind::ALL:
+        return std::make_unique<RangeStream>(total);
+    case QueryCondition::Kind::CONTAINS:
+    case QueryCondition::Kind::EQUALS: {
+        if (condition.getField() == QueryCondition::Field::ISBN) {
+            if (condition.getKind() == QueryCondition::Kind::CONTAINS) return scan(condition);
+            MyVector<uint32_t> ids;
+            const uint32_t* found = isbnIndex.find(condition.getText());
+            if (found) ids.push_back(*found);
+            return std::make_unique<ListStream>(std::move(ids));
+        }
+        MyVector<const MyVector<uint32_t>*> lists;
+        if (!substringCandidates(textFieldOf(condition.getField()), condition.getText(), lists)) {
+            return scan(condition);
+        }
+        if (lists.getSize() == 0) {
+            return std::make_unique<ListStream>(MyVector<uint32_t>());
+        }
+        // 直接在索引的倒排表上求交，短表在前，候选再逐个核对
+        MyAlgorithm::sort(&lists[0], lists.getSize(), [](const MyVector<uint32_t>* a, const MyVector<uint32_t>* b) {
+            return a->getSize() < b->getSize();
+        });
+        MyVector<std::unique_ptr<IdStream>> streams(lists.getSize());
+        for (size_t i = 0; i < lists.getSize(); ++i) {
+            streams.push_back(std::make_unique<ListStream>(lists[i]));
+        }
+        return std::make_unique<FilterStream>(std::make_unique<AndStream>(std::move(streams)),
+                                              [&list, &condition](uint32_t id) { return condition.matches(list[id]); });
     }
-    std::string line;
-    int successCount = 0;
-    int totalCount = 0;
-    std::getline(file, line);
-    while (std::getline(file, line)) {
-        totalCount++;
-        Book book;
-        if (parseBookLine(line, book)) {
-            try {
-                addBook(book);
-                successCount++;
-            } catch (const std::exception& e) {
-                std::cerr << "添加图书失败: " << e.what() << std::endl;
-                continue;
+    case QueryCondition::Kind::YEAR_RANGE: {
+        MyVector<const MyVector<uint32_t>*> lists;
+        if (yearIndex.bucketLists(condition.getLow(), condition.getHigh(), lists)
+            && lists.getSize() <= YEAR_MERGE_FANOUT) {
+            if (lists.getSize() == 1) {
+                return std::make_unique<ListStream>(lists[0]);
             }
+            MyVector<std::unique_ptr<IdStream>> streams(lists.getSize());
+            for (size_t i = 0; i < lists.getSize(); ++i) {
+                streams.push_back(std::make_unique<ListStream>(lists[i]));
+            }
+            return std::make_unique<OrStream>(std::move(streams));
         }
+        return std::make_unique<ListStream>(yearIndex.ids(condition.getLow(), condition.getHigh()));
+    }
+    case QueryCondition::Kind::AND: {
+        // 预估命中最少的子条件产出候选，其余按预估从少到多逐本核对，先排除的先判断
+        MyVector<size_t> order(children.getSize());
+        MyVector<size_t> estimates(children.getSize());
+        for (size_t i = 0; i < children.getSize(); ++i) {
+            order.push_back(i);
+            estimates.push_back(estimateMatches(children[i]));
+        }
+        if (order.getSize() == 0) {
+            return std::make_unique<RangeStream>(total);
+        }
+        MyAlgorithm::sort(&order[0], order.getSize(), [&estimates](size_t a, size_t b) {
+            return estimates[a] < estimates[b];
+        });
+        if (estimates[order[0]] >= total) {
+            return scan(condition);
+        }
+        MyVector<const QueryCondition*> rest(order.getSize());
+        for (size_t i = 1; i < order.getSize(); ++i) {
+            rest.push_back(&children[order[i]]);
+        }
+        std::unique_ptr<IdStream> driver = planStream(children[order[0]]);
+        if (rest.getSize() == 0) {
+            return driver;
+        }
+        return std::make_unique<FilterStream>(std::move(driver), [&list, rest](uint32_t id) {
+            for (size_t i = 0; i < rest.getSize(); ++i) {
+                if (!rest[i]->matches(list[id])) return false;
+            }
+            return true;
+        });
+    }
+    case QueryCondition::Kind::OR: {
+        if (estimateMatches(condition) >= total) {
+            return scan(condition);
+        }
+        MyVector<std::unique_ptr<IdStream>> streams(children.getSize());
+        for (size_t i = 0; i < children.getSize(); ++i) {
+            streams.push_back(planStream(children[i]));
+        }
+        return std::make_unique<OrStream>(std::move(streams));
+    }
+    default:
+        // NOT 和借阅状态没有索引
+        return scan(condition);
     }
-    file.close();
-    std::cout << "导入完成: 成功 " << successCount << "/" << totalCount << " 条记录" << std::endl;
-    return successCount > 0;
 }
 
-bool BookManager::parseBookLine(const std::string& line, Book& book) {
-    try {
-        auto getValue = [](const std::string& src, const std::string& key) -> std::string {
-            size_t keyPos = src.find(key);
-            if (keyPos == std::string::npos) return "";
-            size_t valStart = src.find("'", keyPos + key.length());
-            if (valStart == std::string::npos) return "";
-            valStart += 1;
-            size_t valEnd = src.find("'", valStart);
-            if (valEnd == std::string::npos) return "";
-            return src.substr(valStart, valEnd - valStart);
-        };
-        book.setTitle(getValue(line, "'书名': "));
-        book.setAuthor(getValue(line, "'作者': "));
-        book.setPublisher(getValue(line, "'出版社': "));
-        book.setIsbn(getValue(line, "'ISBN': "));
-        // 出版年限为数字
-        const std::string yearKeyStr = "'出版年限': ";
-        size_t yearKey = line.find(yearKeyStr);
-        if (yearKey == std::string::npos) return false;
-        size_t yearStart = yearKey + yearKeyStr.length();
-        size_t yearEnd = line.find("}", yearStart);
-        std::string yearStr = line.substr(yearStart, yearEnd - yearStart);
-        int year = std::stoi(yearStr);
-        book.setPublishYear(year);
-        return true;
-    } catch (...) {
+// 不大于 value 的最大 2 的幂的指数
+static size_t floorLog2(size_t value) {
+    size_t bits = 0;
+    while (value > 1) {
+        value >>= 1;
+        ++bits;
+    }
+    return bits;
+}
+
+MyVector<uint32_t> BookManager::runQuery(const BookQuery& query) const {
+    std::unique_ptr<IdStream> stream = planStream(query.where);
+    MyVector<uint32_t> ids;
+    size_t wanted = query.sorted ? SIZE_MAX : query.limit;
+    for (uint32_t id = stream->seek(0); id != IdStream::END && ids.getSize() < wanted; id = stream->seek(id + 1)) {
+        ids.push_back(id);
+    }
+    size_t count = ids.getSize();
+    if (!query.sorted || count <= 1) {
+        return ids;
+    }
+
+    size_t total = books->getSize();
+    size_t limit = std::min(query.limit, count);
+    std::unique_lock<std::mutex> cacheLock(cacheMutex);
+    // 命中数 K 满足 K log K > N 且整列顺序已缓存时，按缓存顺序挑出命中的图书，O(N)
+    if (sortCaches[static_cast<size_t>(query.sortBy)].generation == sortGeneration && count * floorLog2(count) > total) {
+        MyVector<bool> hit(total);
+        for (size_t i = 0; i < total; ++i) {
+            hit.push_back(false);
+        }
+        for (size_t i = 0; i < count; ++i) {
+            hit[ids[i]] = true;
+        }
+        const MyVector<uint32_t>& ascending = sortedOrder(query.sortBy);
+        MyVector<uint32_t> result(limit);
+        for (size_t i = 0; i < total && result.getSize() < limit; ++i) {
+            uint32_t id = query.order == SortOrder::ASCENDING ? ascending[i] : ascending[total - 1 - i];
+            if (hit[id]) result.push_back(id);
+        }
+        return result;
+    }
+    cacheLock.unlock();
+
+    auto comp = bookIndexLess(*books, query.sortBy, query.order);
+    if (limit == count) {
+        MyAlgorithm::parallelSort(&ids[0], count, comp);
+        return ids;
+    }
+    MyAlgorithm::partialSort(&ids[0], count, limit, comp);
+    MyVector<uint32_t> result(limit);
+    for (size_t i = 0; i < limit; ++i) {
+        result.push_back(ids[i]);
+    }
+    return result;
+}
+
+MyVector<uint32_t> BookManager::queryIds(const BookQuery& query, CatalogSnapshot* snapshot) const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    if (snapshot) {
+        *snapshot = currentSnapshot();
+    }
+    return runQuery(query);
+}
+
+MyVector<Book> BookManager::queryBooks(const BookQuery& query) const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return booksAt(runQuery(query));
+}
+
+static std::string queryKey(const BookQuery& query) {
+    std::string key;
+    query.where.appendKey(key);
+    key += '|';
+    if (query.sorted) {
+        key += std::to_string(static_cast<int>(query.sortBy));
+        key += query.order == SortOrder::ASCENDING ? 'a' : 'd';
+    }
+    key += '|';
+    key += std::to_string(query.limit);
+    return key;
+}
+
+/**
+ * @brief 取查询的完整结果，命中缓存时不再执行查询
+ * 调用方持有 mutex 的共享锁，代数在此期间不变；查询在缓存锁外执行，
+ * 两个读者同时未命中时各算一次，后写入的覆盖先写入的，结果相同
+ */
+std::shared_ptr<const MyVector<uint32_t>> BookManager::cachedQuery(const BookQuery& query) const {
+    std::string key = queryKey(query);
+    uint64_t current = generation;
+    {
+        std::lock_guard<std::mutex> cacheLock(queryCacheMutex);
+        for (size_t i = 0; i < queryCache.getSize(); ++i) {
+            QueryCacheEntry& entry = queryCache[i];
+            if (entry.generation == current && entry.key == key) {
+                entry.lastUsed = ++queryCacheTick;
+                return entry.ids;
+            }
+        }
+    }
+
+    std::shared_ptr<const MyVector<uint32_t>> ids = std::make_shared<const MyVector<uint32_t>>(runQuery(query));
+    std::lock_guard<std::mutex> cacheLock(queryCacheMutex);
+    // 先丢弃旧代数的结果，仍满时淘汰最久未用的
+    for (size_t i = queryCache.getSize(); i > 0; --i) {
+        if (queryCache[i - 1].generation != current) {
+            queryCache.removeAt(i - 1);
+        }
+    }
+    size_t slot = queryCache.getSize();
+    for (size_t i = 0; i < queryCache.getSize(); ++i) {
+        if (queryCache[i].key == key) {
+            slot = i;
+            break;
+        }
+    }
+    if (slot == queryCache.getSize() && queryCache.getSize() >= QUERY_CACHE_CAPACITY) {
+        slot = 0;
+        for (size_t i = 1; i < queryCache.getSize(); ++i) {
+            if (queryCache[i].lastUsed < queryCache[slot].lastUsed) {
+                slot = i;
+            }
+        }
+    }
+    if (slot == queryCache.getSize()) {
+        queryCache.emplace_back();
+    }
+    QueryCacheEntry& entry = queryCache[slot];
+    entry.key = std::move(key);
+    entry.generation = current;
+    entry.lastUsed = ++queryCacheTick;
+    entry.ids = ids;
+    return ids;
+}
+
+MyVector<uint32_t> BookManager::getQueryPage(const BookQuery& query, size_t offset, size_t count, size_t& total,
+                                             CatalogSnapshot* snapshot) const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    if (snapshot) {
+        *snapshot = currentSnapshot();
+    }
+    std::shared_ptr<const MyVector<uint32_t>> ids = cachedQuery(query);
+    lock.unlock();
+
+    total = ids->getSize();
+    size_t begin = offset < total ? offset : total;
+    size_t end = count < total - begin ? begin + count : total;
+    MyVector<uint32_t> page(end - begin);
+    for (size_t i = begin; i < end; ++i) {
+        page.push_back((*ids)[i]);
+    }
+    return page;
+}
+
+size_t BookManager::forEachMatch(const QueryCondition& condition,
+                                 const std::function<bool(uint32_t, const Book&)>& visit) const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    std::unique_ptr<IdStream> stream = planStream(condition);
+    size_t visited = 0;
+    for (uint32_t id = stream->seek(0); id != IdStream::END; id = stream->seek(id + 1)) {
+        ++visited;
+        if (!visit(id, (*books)[id])) break;
+    }
+    return visited;
+}
+
+bool BookManager::importBooksFromFile(const std::string& filename, DuplicatePolicy policy) {
+    MyVector<Book> imported;
+    BookImporter::Stats stats;
+    if (!BookImporter::parseFile(filename, imported, stats)) {
+        std::cerr << "无法打开文件: " << filename << std::endl;
         return false;
     }
+    ImportReport report = importBooks(std::move(imported), policy);
+    std::cout << "导入完成: 成功 " << stats.bookCount << "/" << stats.lineCount << " 条记录, 新增 "
+              << report.added << " 本, 重复 " << report.duplicates() << " 本" << std::endl;
+    return stats.bookCount > 0;
+}
+
+bool BookManager::parseBookLine(const std::string& line, Book& book) {
+    return BookImporter::parseLine(line, book);
 }
 
 bool BookManager::exportBooksToFile(const std::string& filename) const {
@@ -294,8 +973,11 @@ bool BookManager::exportBooksToFile(const std::string& filename) const {
         std::cerr << "无法创建文件: " << filename << std::endl;
         return false;
     }
-    for (size_t i = 0; i < books.getSize(); i++) {
-        const Book& book = books[i];
+    // 在视图上导出，不阻塞写入
+    const CatalogSnapshot view = snapshot();
+    const MyVector<Book>& list = view.getBooks();
+    for (size_t i = 0; i < list.getSize(); i++) {
+        const Book& book = list[i];
         file << "{'书名': '" << book.getTitle() << "', "
              << "'作者': '" << book.getAuthor() << "', "
              << "'出版社': '" << book.getPublisher() << "', "
@@ -306,90 +988,157 @@ bool BookManager::exportBooksToFile(const std::string& filename) const {
     return true;
 }
 
-void BookManager::addBooks(const MyVector<Book>& booksVec) {
-    for (size_t i = 0; i < booksVec.getSize(); ++i) {
-        try {
-            addBook(booksVec[i]);
-        } catch (...) {
-            // 忽略重复或异常
+static bool sameContent(const Book& a, const Book& b) {
+    return a.getTitle() == b.getTitle() && a.getAuthor() == b.getAuthor()
+           && a.getPublisher() == b.getPublisher() && a.getPublishYear() == b.getPublishYear();
+}
+
+static const std::string& fillEmpty(const std::string& current, const std::string& incoming) {
+    return current.empty() ? incoming : current;
+}
+
+ImportReport BookManager::importBooks(MyVector<Book>&& batch, DuplicatePolicy policy) {
+    ImportReport report;
+    report.policy = policy;
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    detachBooks();
+    size_t firstAdded = books->getSize();
+    books->reserve(books->getSize() + batch.getSize());
+    isbnIndex.reserve(books->getSize() + batch.getSize());
+    for (size_t i = 0; i < batch.getSize(); ++i) {
+        Book& incoming = batch[i];
+        const uint32_t* found = isbnIndex.find(incoming.getIsbn());
+        if (!found) {
+            books->push_back(std::move(incoming));
+            uint32_t id = static_cast<uint32_t>(books->getSize() - 1);
+            isbnIndex.insert((*books)[id].getIsbn(), id);
+            indexBook(id, (*books)[id]);
+            ++report.added;
+            continue;
+        }
+        Book& existing = (*books)[*found];
+        Book updated;
+        switch (policy) {
+        case DuplicatePolicy::SKIP:
+            ++report.skipped;
+            continue;
+        case DuplicatePolicy::OVERWRITE:
+            updated = Book(existing.getIsbn(), incoming.getTitle(), incoming.getAuthor(),
+                           incoming.getPublisher(), incoming.getPublishYear());
+            break;
+        case DuplicatePolicy::MERGE:
+            updated = Book(existing.getIsbn(), fillEmpty(existing.getTitle(), incoming.getTitle()),
+                           fillEmpty(existing.getAuthor(), incoming.getAuthor()),
+                           fillEmpty(existing.getPublisher(), incoming.getPublisher()),
+                           existing.getPublishYear() != 0 ? existing.getPublishYear() : incoming.getPublishYear());
+            break;
+        }
+        if (sameContent(existing, updated)) {
+            ++report.unchanged;
+            continue;
+        }
+        // 借阅状态属于馆内数据，不随导入改变
+        updated.setStatus(existing.getStatus());
+        reindexBook(*found, existing, updated);
+        // 本批新增的图书最后统一加入前缀索引
+        if (*found < firstAdded) {
+            updateCompletions(existing, updated);
         }
+        existing = std::move(updated);
+        if (policy == DuplicatePolicy::OVERWRITE) {
+            ++report.overwritten;
+        } else {
+            ++report.merged;
+        }
+    }
+    batch.clear();
+    // 新增的图书都在末尾，一次归并进前缀索引
+    addCompletions(firstAdded);
+    if (report.added > 0 || report.overwritten > 0 || report.merged > 0) {
+        markModified();
     }
+    return report;
 }
 
-// 数据持久化方法实现
+// 数据持久化方法实现：流式读写，不在内存中建立整份 JSON 文档；
+// 保存在当前版本的视图上进行，写文件期间不阻塞修改
 bool BookManager::saveToFile(const QString& filename) const {
-    QFile file(filename);
-    if (!file.open(QIODevice::WriteOnly)) {
+    JsonWriter writer;
+    if (!writer.open(QFile::encodeName(filename).toStdString())) {
         qDebug() << "无法打开文件进行写入:" << filename;
         return false;
     }
     
-    QJsonArray booksArray;
-    for (size_t i = 0; i < books.getSize(); ++i) {
-        booksArray.append(books[i].toJson());
+    const CatalogSnapshot view = snapshot();
+    const MyVector<Book>& list = view.getBooks();
+    writer.beginObject();
+    writer.key("books");
+    writer.beginArray();
+    for (size_t i = 0; i < list.getSize(); ++i) {
+        list[i].writeJson(writer);
     }
+    writer.endArray();
+    writer.key("count");
+    writer.value(static_cast<int>(list.getSize()));
+    writer.endObject();
     
-    QJsonObject rootObject;
-    rootObject["books"] = booksArray;
-    rootObject["count"] = static_cast<int>(books.getSize());
-    
-    QJsonDocument doc(rootObject);
-    QByteArray jsonData = doc.toJson(QJsonDocument::Indented);
-    
-    qint64 bytesWritten = file.write(jsonData);
-    file.close();
-    
-    if (bytesWritten == -1) {
+    if (!writer.commit()) {
         qDebug() << "写入文件失败:" << filename;
         return false;
     }
     
-    qDebug() << "成功保存" << books.getSize() << "本图书到文件:" << filename;
+    qDebug() << "成功保存" << list.getSize() << "本图书到文件:" << filename;
     return true;
 }
 
 bool BookManager::loadFromFile(const QString& filename) {
-    QFile file(filename);
-    if (!file.open(QIODevice::ReadOnly)) {
+    JsonReader reader;
+    if (!reader.open(QFile::encodeName(filename).toStdString())) {
         qDebug() << "无法打开文件进行读取:" << filename;
         return false;
     }
     
-    QByteArray jsonData = file.readAll();
-    file.close();
-    
-    QJsonParseError parseError;
-    QJsonDocument doc = QJsonDocument::fromJson(jsonData, &parseError);
-    
-    if (parseError.error != QJsonParseError::NoError) {
-        qDebug() << "JSON解析错误:" << parseError.errorString();
+    // 边读边构造图书，解析成功后才替换现有数据
+    MyVector<Book> tempBooks;
+    bool hasBooks = false;
+    bool parsed = reader.readRootArray("books", hasBooks, [&]() {
+        return tempBooks.emplace_back().readJson(reader);
+    });
+    if (!parsed) {
+        qDebug() << "JSON解析错误:" << filename;
         return false;
     }
-    
-    QJsonObject rootObject = doc.object();
-    if (!rootObject.contains("books")) {
+    if (!hasBooks) {
         qDebug() << "文件格式错误: 缺少books字段";
         return false;
     }
     
-    QJsonArray booksArray = rootObject["books"].toArray();
-    
-    // 清空现有数据
-    books = MyVector<Book>();
-    
-    // 加载图书数据
-    MyVector<Book> tempBooks;
-    int successCount = 0;
-    for (const QJsonValue& value : booksArray) {
-        if (value.isObject()) {
-            Book book;
-            book.fromJson(value.toObject());
-            tempBooks.push_back_no_rebuild(book);
-            successCount++;
-        }
-    }
-    tempBooks.rebuildBookHashTable();
-    books = tempBooks; // 只重建一次哈希表
-    qDebug() << "成功加载" << successCount << "本图书从文件:" << filename;
-    return successCount > 0;
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    markModified();
+    books = std::make_shared<MyVector<Book>>(std::move(tempBooks));
+    rebuildIndex(); // 只重建一次哈希表
+    qDebug() << "成功加载" << books->getSize() << "本图书从文件:" << filename;
+    return books->getSize() > 0;
+}
+
+bool BookManager::saveToBinaryFile(const std::string& filename) const {
+    if (!BinarySnapshot::saveBooks(filename, snapshot().getBooks())) {
+        qDebug() << "写入二进制快照失败:" << QString::fromLocal8Bit(filename.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool BookManager::loadFromBinaryFile(const std::string& filename) {
+    MyVector<Book> loaded;
+    if (!BinarySnapshot::loadBooks(filename, loaded)) {
+        qDebug() << "二进制快照损坏或无法读取:" << QString::fromLocal8Bit(filename.c_str());
+        return false;
+    }
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    markModified();
+    books = std::make_shared<MyVector<Book>>(std::move(loaded));
+    rebuildIndex();
+    qDebug() << "成功加载" << books->getSize() << "本图书从文件:" << QString::fromLocal8Bit(filename.c_str());
+    return true;
 } 
@@ -0,0 +1,118 @@
+#include "../include/BookQuery.h"
+
+QueryCondition QueryCondition::contains(Field field, const std::string& text) {
+    QueryCondition condition;
+    condition.kind = Kind::CONTAINS;
+    condition.field = field;
+    condition.text = text;
+    return condition;
+}
+
+QueryCondition QueryCondition::equals(Field field, const std::string& text) {
+    QueryCondition condition;
+    condition.kind = Kind::EQUALS;
+    condition.field = field;
+    condition.text = text;
+    return condition;
+}
+
+QueryCondition QueryCondition::yearBetween(int from, int to) {
+    QueryCondition condition;
+    condition.kind = Kind::YEAR_RANGE;
+    condition.low = from;
+    condition.high = to;
+    return condition;
+}
+
+QueryCondition QueryCondition::statusIs(int status) {
+    QueryCondition condition;
+    condition.kind = Kind::STATUS;
+    condition.low = status;
+    return condition;
+}
+
+QueryCondition QueryCondition::combine(Kind kind, QueryCondition a, QueryCondition b) {
+    QueryCondition condition;
+    condition.kind = kind;
+    QueryCondition* parts[] = {&a, &b};
+    for (QueryCondition* part : parts) {
+        if (part->kind == kind) {
+            for (size_t i = 0; i < part->children.getSize(); ++i) {
+                condition.children.push_back(std::move(part->children[i]));
+            }
+        } else {
+            condition.children.push_back(std::move(*part));
+        }
+    }
+    return condition;
+}
+
+QueryCondition operator!(QueryCondition a) {
+    // 双重否定直接还原
+    if (a.kind == QueryCondition::Kind::NOT) {
+        return std::move(a.children[0]);
+    }
+    QueryCondition condition;
+    condition.kind = QueryCondition::Kind::NOT;
+    condition.children.push_back(std::move(a));
+    return condition;
+}
+
+const std::string& QueryCondition::fieldValue(const Book& book, Field field) {
+    switch (field) {
+    case Field::AUTHOR:
+        return book.getAuthor();
+    case Field::PUBLISHER:
+        return book.getPublisher();
+    case Field::ISBN:
+        return book.getIsbn();
+    default:
+        return book.getTitle();
+    }
+}
+
+void QueryCondition::appendKey(std::string& out) const {
+    out += std::to_string(static_cast<int>(kind));
+    out += ',';
+    out += std::to_string(static_cast<int>(field));
+    out += ',';
+    // 文本前写长度，任意内容都不会与分隔符混淆
+    out += std::to_string(text.size());
+    out += ':';
+    out += text;
+    out += std::to_string(low);
+    out += ',';
+    out += std::to_string(high);
+    out += '(';
+    for (size_t i = 0; i < children.getSize(); ++i) {
+        children[i].appendKey(out);
+    }
+    out += ')';
+}
+
+bool QueryCondition::matches(const Book& book) const {
+    switch (kind) {
+    case Kind::CONTAINS:
+        return fieldValue(book, field).find(text) != std::string::npos;
+    case Kind::EQUALS:
+        return fieldValue(book, field) == text;
+    case Kind::YEAR_RANGE:
+        return book.getPublishYear() >= low && book.getPublishYear() <= high;
+    case Kind::STATUS:
+        return book.getStatus() == low;
+    case Kind::AND:
+        for (size_t i = 0; i < children.getSize(); ++i) {
+            if (!children[i].matches(book)) return false;
+        }
+        return true;
+    case Kind::OR:
+        for (size_t i = 0; i < children.getSize(); ++i) {
+            if (children[i].matches(book)) return true;
+        }
+        return false;
+    case Kind::NOT:
+        return !children[0].matches(book);
+    default:
+        return true;
+    }
+}
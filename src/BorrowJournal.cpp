@@ -0,0 +1,203 @@
+#include "../include/BorrowJournal.h"
+#include "../include/Checksum.h"
+#include "../include/BorrowRecord.h"
+#include <cstdlib>
+#include <filesystem>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+// 条目格式：类型\t记录编号\tISBN\t用户名\t时间1\t时间2\t校验和\n
+// 字符串字段中的 \ 制表符 换行 回车 转义为 \\ \t \n \r
+
+static void appendEscaped(std::string& out, const std::string& value) {
+    for (char c : value) {
+        switch (c) {
+        case '\\': out += "\\\\"; break;
+        case '\t': out += "\\t"; break;
+        case '\n': out += "\\n"; break;
+        case '\r': out += "\\r"; break;
+        default: out += c; break;
+        }
+    }
+}
+
+static bool unescape(const char* begin, const char* end, std::string& out) {
+    out.clear();
+    for (const char* p = begin; p < end; ++p) {
+        if (*p != '\\') {
+            out += *p;
+            continue;
+        }
+        if (++p == end) return false;
+        switch (*p) {
+        case '\\': out += '\\'; break;
+        case 't': out += '\t'; break;
+        case 'n': out += '\n'; break;
+        case 'r': out += '\r'; break;
+        default: return false;
+        }
+    }
+    return true;
+}
+
+static bool parseInteger(const char* begin, const char* end, long long& value) {
+    if (begin == end) return false;
+    std::string text(begin, end);
+    char* stop = nullptr;
+    value = std::strtoll(text.c_str(), &stop, 10);
+    return stop == text.c_str() + text.size();
+}
+
+// 解析一行（不含换行符），校验失败或格式错误返回 false
+static bool parseLine(const char* begin, const char* end, JournalEntry& entry) {
+    const char* fields[8];
+    const char* fieldEnds[7];
+    int count = 0;
+    fields[0] = begin;
+    for (const char* p = begin; p < end; ++p) {
+        if (*p == '\t') {
+            if (count == 6) return false;
+            fieldEnds[count++] = p;
+            fields[count] = p + 1;
+        }
+    }
+    if (count != 6) return false;
+    fieldEnds[6] = end;
+
+    long long crc = 0;
+    if (!parseInteger(fields[6], fieldEnds[6], crc)) return false;
+    size_t payloadLength = static_cast<size_t>(fieldEnds[5] - begin);
+    if (Checksum::crc32(begin, payloadLength) != static_cast<uint32_t>(crc)) return false;
+
+    if (fieldEnds[0] - fields[0] != 1) return false;
+    char type = *fields[0];
+    if (type != JournalEntry::BORROW && type != JournalEntry::RETURN && type != JournalEntry::RENEW
+        && type != JournalEntry::ENQUEUE && type != JournalEntry::DEQUEUE) {
+        return false;
+    }
+    entry.type = static_cast<JournalEntry::Type>(type);
+    long long recordId = 0, time1 = 0, time2 = 0;
+    if (!parseInteger(fields[1], fieldEnds[1], recordId)
+        || !unescape(fields[2], fieldEnds[2], entry.isbn)
+        || !unescape(fields[3], fieldEnds[3], entry.username)
+        || !parseInteger(fields[4], fieldEnds[4], time1)
+        || !parseInteger(fields[5], fieldEnds[5], time2)
+        || !BorrowRecord::isValidId(recordId)) {
+        return false;
+    }
+    entry.recordId = static_cast<int>(recordId);
+    entry.time1 = static_cast<time_t>(time1);
+    entry.time2 = static_cast<time_t>(time2);
+    return true;
+}
+
+// 刷新 C 库缓冲并让操作系统把数据写入磁盘
+static bool syncFile(std::FILE* file) {
+    if (std::fflush(file) != 0) return false;
+#ifdef _WIN32
+    return _commit(_fileno(file)) == 0;
+#else
+    return fsync(fileno(file)) == 0;
+#endif
+}
+
+BorrowJournal::~BorrowJournal() {
+    close();
+}
+
+bool BorrowJournal::readAll(const std::string& path, MyVector<JournalEntry>& entries, size_t& validBytes) {
+    entries.clear();
+    validBytes = 0;
+    std::FILE* in = std::fopen(path.c_str(), "rb");
+    if (!in) {
+        // 还没有日志
+        return !std::filesystem::exists(path);
+    }
+    std::string content;
+    char chunk[65536];
+    size_t n;
+    while ((n = std::fread(chunk, 1, sizeof(chunk), in)) > 0) {
+        content.append(chunk, n);
+    }
+    bool ok = !std::ferror(in);
+    std::fclose(in);
+    if (!ok) return false;
+
+    const char* data = content.data();
+    size_t pos = 0;
+    while (pos < content.size()) {
+        size_t lineEnd = content.find('\n', pos);
+        if (lineEnd == std::string::npos) break; // 没写完的最后一行
+        JournalEntry entry;
+        if (!parseLine(data + pos, data + lineEnd, entry)) break;
+        entries.push_back(std::move(entry));
+        pos = lineEnd + 1;
+    }
+    validBytes = pos;
+    return true;
+}
+
+bool BorrowJournal::open(const std::string& journalPath, size_t validBytes, size_t existingEntries) {
+    close();
+    path = journalPath;
+    std::error_code error;
+    if (std::filesystem::exists(path, error) && std::filesystem::file_size(path, error) > validBytes) {
+        // 截掉崩溃留下的残尾，否则之后追加的条目读不到
+        std::filesystem::resize_file(path, validBytes, error);
+        if (error) return false;
+    }
+    file = std::fopen(path.c_str(), "ab");
+    if (!file) return false;
+    entryCount = existingEntries;
+    buffer.clear();
+    return true;
+}
+
+void BorrowJournal::close() {
+    if (file) {
+        commit();
+        std::fclose(file);
+        file = nullptr;
+    }
+}
+
+void BorrowJournal::append(const JournalEntry& entry) {
+    size_t lineStart = buffer.size();
+    buffer += static_cast<char>(entry.type);
+    buffer += '\t';
+    buffer += std::to_string(entry.recordId);
+    buffer += '\t';
+    appendEscaped(buffer, entry.isbn);
+    buffer += '\t';
+    appendEscaped(buffer, entry.username);
+    buffer += '\t';
+    buffer += std::to_string(static_cast<long long>(entry.time1));
+    buffer += '\t';
+    buffer += std::to_string(static_cast<long long>(entry.time2));
+    uint32_t crc = Checksum::crc32(buffer.data() + lineStart, buffer.size() - lineStart);
+    buffer += '\t';
+    buffer += std::to_string(crc);
+    buffer += '\n';
+    ++entryCount;
+}
+
+bool BorrowJournal::commit() {
+    if (!file || buffer.empty()) return true;
+    bool ok = std::fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size();
+    ok = syncFile(file) && ok;
+    buffer.clear();
+    return ok;
+}
+
+bool BorrowJournal::reset() {
+    if (!file) return false;
+    buffer.clear();
+    std::fclose(file);
+    file = std::fopen(path.c_str(), "wb");
+    if (!file) return false;
+    entryCount = 0;
+    return syncFile(file);
+}
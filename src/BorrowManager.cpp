@@ -2,37 +2,260 @@
 #include <stdexcept>
 #include <ctime>
 #include <QFile>
-#include <QJsonArray>
-#include <QJsonDocument>
-#include <QJsonObject>
-#include <QJsonValue>
 #include <QDebug>
 #include "../include/Mysort.h"
 #include "../include/MyQueue.h"
+#include "../include/BinarySnapshot.h"
+#include "../include/JsonStream.h"
 #include <map>
+#include <mutex>
+#include <algorithm>
 
 BorrowManager::BorrowManager(BookManager* bookManager, UserManager* userManager)
-    : bookManager(bookManager), userManager(userManager) {}
+    : sparseIdIndex(RecordIdOf{this}),
+      activeLoanIndex(LoanKeyOf{this}),
+      activeIsbnIndex(RecordIsbnOf{this}),
+      isbnGroups(RecordIsbnOf{this}),
+      usernameGroups(RecordUsernameOf{this}),
+      bookManager(bookManager), userManager(userManager) {}
+
+// 追加借阅记录并登记到各索引
+void BorrowManager::addRecord(const BorrowRecord& record) {
+    records.add(record);
+    indexRecord(static_cast<uint32_t>(records.getSize() - 1));
+}
+
+// 将第 index 条记录登记到各索引；同一键有多条未归还记录时以最新一条为准
+void BorrowManager::indexRecord(uint32_t index) {
+    const BorrowRecord& record = records[index];
+    int id = record.getId();
+    if (id >= 0) {
+        size_t denseLimit = records.getSize() * DENSE_ID_FACTOR + DENSE_ID_SLACK;
+        if (static_cast<size_t>(id) < denseLimit) {
+            // 编号之间可能有空洞（如手工编辑过的文件），空位记为 NO_SLOT
+            if (slotOfId.getSize() <= static_cast<size_t>(id)) {
+                slotOfId.reserve(std::min(denseLimit, std::max(static_cast<size_t>(id) + 1, slotOfId.getSize() * 2)));
+                while (slotOfId.getSize() <= static_cast<size_t>(id)) {
+                    slotOfId.push_back(NO_SLOT);
+                }
+            }
+            slotOfId[id] = index;
+        } else {
+            sparseIdIndex.insert(id, index);
+        }
+    }
+    isbnGroups.add(record.getIsbn(), index);
+    usernameGroups.add(record.getUsername(), index);
+    if (!record.getIsReturned()) {
+        activeLoanIndex.insert(LoanKey{record.getIsbn(), record.getUsername()}, index);
+        activeIsbnIndex.insert(record.getIsbn(), index);
+    }
+}
+
+// 按当前记录重建全部索引
+void BorrowManager::rebuildIndex() {
+    slotOfId.clear();
+    sparseIdIndex.clear();
+    activeLoanIndex.clear();
+    activeIsbnIndex.clear();
+    isbnGroups.clear();
+    usernameGroups.clear();
+    for (size_t i = 0; i < records.getSize(); ++i) {
+        indexRecord(static_cast<uint32_t>(i));
+    }
+}
+
+// 由记录编号取下标，未找到返回 -1
+int BorrowManager::slotOfRecordId(int recordId) const {
+    if (recordId < 0) {
+        return -1;
+    }
+    if (static_cast<size_t>(recordId) < slotOfId.getSize() && slotOfId[recordId] != NO_SLOT) {
+        return static_cast<int>(slotOfId[recordId]);
+    }
+    const uint32_t* slot = sparseIdIndex.find(recordId);
+    return slot ? static_cast<int>(*slot) : -1;
+}
+
+// 查找 (isbn, username) 未归还的记录下标，未找到返回 -1
+int BorrowManager::findActiveLoan(const std::string& isbn, const std::string& username) const {
+    const uint32_t* index = activeLoanIndex.find(LoanKey{isbn, username});
+    return index ? static_cast<int>(*index) : -1;
+}
+
+/**
+ * @brief 将记录标记为已归还，并从未归还索引中移除
+ * 旧数据中同一键可能有多条未归还记录，此时在该书的分组里找回剩下的一条
+ */
+void BorrowManager::markReturned(uint32_t index, time_t returnDate) {
+    BorrowRecord& record = records[index];
+    record.setReturnDate(returnDate);
+    record.setIsReturned(true);
+
+    LoanKey key{record.getIsbn(), record.getUsername()};
+    const uint32_t* loan = activeLoanIndex.find(key);
+    bool loanMapped = loan && *loan == index;
+    const uint32_t* active = activeIsbnIndex.find(record.getIsbn());
+    bool isbnMapped = active && *active == index;
+    if (loanMapped) activeLoanIndex.erase(key);
+    if (isbnMapped) activeIsbnIndex.erase(record.getIsbn());
+    if (!loanMapped && !isbnMapped) return;
+
+    const MyVector<uint32_t>* group = isbnGroups.find(record.getIsbn());
+    for (size_t i = 0; group && i < group->getSize(); ++i) {
+        uint32_t other = (*group)[i];
+        const BorrowRecord& candidate = records[other];
+        if (candidate.getIsReturned()) continue;
+        if (isbnMapped) activeIsbnIndex.insert(candidate.getIsbn(), other);
+        if (loanMapped && candidate.getUsername() == record.getUsername()) {
+            activeLoanIndex.insert(LoanKey{candidate.getIsbn(), candidate.getUsername()}, other);
+        }
+    }
+}
+
+// 按下标列表取出记录副本
+MyVector<BorrowRecord> BorrowManager::collect(const MyVector<uint32_t>* indices) const {
+    if (!indices) {
+        return MyVector<BorrowRecord>();
+    }
+    MyVector<BorrowRecord> result(indices->getSize());
+    for (size_t i = 0; i < indices->getSize(); ++i) {
+        result.emplace_back(records[(*indices)[i]]);
+    }
+    return result;
+}
+
+/**
+ * @brief 一次对外操作的范围
+ * 操作中产生的日志条目在最外层范围结束时一并提交。正常返回前调用 commit 取得保存结果；
+ * 抛出异常离开时由析构函数提交已发生的变动，失败只能记录
+ */
+class BorrowManager::ChangeScope {
+public:
+    explicit ChangeScope(BorrowManager* owner) : owner(owner) { ++owner->changeDepth; }
+    ~ChangeScope() {
+        if (!committed) {
+            commit();
+        }
+    }
+    ChangeScope(const ChangeScope&) = delete;
+    ChangeScope& operator=(const ChangeScope&) = delete;
+
+    // 结束本范围，返回变动是否已保存；内层范围由最外层统一提交，直接返回 true
+    bool commit() {
+        committed = true;
+        if (--owner->changeDepth > 0) {
+            return true;
+        }
+        return owner->commitChanges();
+    }
+private:
+    BorrowManager* owner;
+    bool committed = false;
+};
+
+// 提交本次操作的变动，返回是否已保存：有日志时追加并落盘，否则按旧方式整体保存。
+// 日志写入失败时文件末尾可能残缺，之后追加的条目重放时读不到，因此改为写快照并清空日志；
+// 快照也写不成时返回 false，内存中的变动保留，之后每次提交都先重试写快照
+bool BorrowManager::commitChanges() {
+    if (!journal.isOpen()) {
+        bool recordsSaved = writeRecords("borrow_records.json"); // 实时保存借阅记录
+        bool queuesSaved = writeQueues("waiting_queues.json"); // 实时保存队列
+        return recordsSaved && queuesSaved;
+    }
+    if (!journalBroken && journal.commit()) {
+        // 变动已在日志中，快照写不成只是推迟清空日志
+        if (journal.getEntryCount() >= COMPACT_THRESHOLD && !compactUnlocked()) {
+            qDebug() << "借阅快照写入失败，日志暂不清空:" << QString::fromStdString(snapshotPath);
+        }
+        return true;
+    }
+    if (!journalBroken) {
+        qDebug() << "借阅日志写入失败:" << QString::fromStdString(journalPath);
+        journalBroken = true;
+    }
+    if (!compactUnlocked()) {
+        qDebug() << "借阅快照写入失败，本次变动未保存:" << QString::fromStdString(snapshotPath);
+        return false;
+    }
+    return true;
+}
+
+// 归还第 index 条记录并写入日志，图书改为在馆后处理等待队列；
+// 各归还入口都经过这里，与日志重放对 RETURN 的处理一致
+void BorrowManager::returnRecord(uint32_t index) {
+    time_t now = std::time(nullptr);
+    markReturned(index, now);
+    JournalEntry entry;
+    entry.type = JournalEntry::RETURN;
+    entry.recordId = records[index].getId();
+    entry.time1 = now;
+    journal.append(entry);
+    // 自动借阅会追加记录，先复制 ISBN
+    std::string isbn = records[index].getBookIsbn();
+    bookManager->updateBookStatus(isbn, 0); //归还
+    serveWaitingQueue(isbn);
+}
+
+// 续借第 index 条记录并写入日志
+void BorrowManager::renewRecord(uint32_t index) {
+    time_t newDueDate = std::time(nullptr) + (DEFAULT_BORROW_DAYS * 24 * 60 * 60);
+    records[index].setDueDate(newDueDate);
+    JournalEntry entry;
+    entry.type = JournalEntry::RENEW;
+    entry.recordId = records[index].getId();
+    entry.time1 = newDueDate;
+    journal.append(entry);
+}
+
+// 图书归还后，自动为等待队列的队首用户借阅
+void BorrowManager::serveWaitingQueue(const std::string& isbn) {
+    auto it = waitingQueues.find(isbn);
+    if (it == waitingQueues.end()) {
+        return;
+    }
+    MyQueue<std::string>& queue = it->second;
+    if (!queue.isEmpty()) {
+        std::string nextUser = queue.front();
+        queue.dequeue();
+        JournalEntry entry;
+        entry.type = JournalEntry::DEQUEUE;
+        entry.isbn = isbn;
+        entry.username = nextUser;
+        journal.append(entry);
+        try {
+            borrowUnlocked(isbn, nextUser);
+        } catch (const std::exception& e) {
+            // 如果自动借阅失败（如用户已借阅等），忽略
+        }
+    }
+    // 如果队列空了，移除队列
+    if (queue.isEmpty()) {
+        waitingQueues.erase(it);
+    }
+}
 
 bool BorrowManager::borrowBook(const std::string& isbn, const std::string& username) {
-    const User* user = userManager->findUser(username);
-    if (!user) {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    return borrowUnlocked(isbn, username);
+}
+
+bool BorrowManager::borrowUnlocked(const std::string& isbn, const std::string& username) {
+    ChangeScope scope(this);
+    // 取图书副本，不长期持有另外两个管理器的锁
+    if (!userManager->hasUser(username)) {
         throw std::runtime_error("用户不存在");
     }
-    Book* book = bookManager->findBookByIsbn(isbn);
-    if (!book) {
+    Book book;
+    if (!bookManager->findBook(isbn, book)) {
         throw std::runtime_error("图书不存在");
     }
     // 检查用户是否已借阅此书
-    for (size_t i = 0; i < records.getSize(); i++) {
-        if (records[i].getBookIsbn() == isbn && 
-            records[i].getUsername() == username && 
-            !records[i].getIsReturned()) {
-            throw std::runtime_error("不可多次借阅同一本书");
-        }
+    if (findActiveLoan(isbn, username) >= 0) {
+        throw std::runtime_error("不可多次借阅同一本书");
     }
     // 书已被借出，处理等待队列
-    if (book->getStatus() == 1) {
+    if (book.getStatus() == 1) {
         // 队列不存在则创建
         if (waitingQueues.find(isbn) == waitingQueues.end()) {
             waitingQueues[isbn] = MyQueue<std::string>();
@@ -42,7 +265,14 @@ bool BorrowManager::borrowBook(const std::string& isbn, const std::string& usern
             throw std::runtime_error("已在排队之中");
         } else {
             queue.enqueue(username);
-            saveWaitingQueues("waiting_queues.json"); // 实时保存队列
+            JournalEntry entry;
+            entry.type = JournalEntry::ENQUEUE;
+            entry.isbn = isbn;
+            entry.username = username;
+            journal.append(entry);
+            if (!scope.commit()) {
+                throw std::runtime_error("借阅记录保存失败");
+            }
             int pos = static_cast<int>(queue.size()) - 1;
             throw std::runtime_error(("已添加到等待队列，前方还有" + std::to_string(pos) + "人在排队").c_str());
         }
@@ -51,162 +281,115 @@ bool BorrowManager::borrowBook(const std::string& isbn, const std::string& usern
     time_t now = std::time(nullptr);
     time_t dueDate = now + (DEFAULT_BORROW_DAYS * 24 * 60 * 60);
     BorrowRecord record(isbn, username, now, dueDate);
-    records.add(record);
+    addRecord(record);
     bookManager->updateBookStatus(isbn,1); //借出
-    saveToFile("borrow_records.json"); // 实时保存借阅记录
-    return true;
+    JournalEntry entry;
+    entry.type = JournalEntry::BORROW;
+    entry.recordId = record.getId();
+    entry.isbn = isbn;
+    entry.username = username;
+    entry.time1 = now;
+    entry.time2 = dueDate;
+    journal.append(entry);
+    return scope.commit();
 }
 
 bool BorrowManager::returnBook(const std::string& isbn, const std::string& username) {
-    for (size_t i = 0; i < records.getSize(); i++) {
-        if (records[i].getBookIsbn() == isbn && 
-            records[i].getUsername() == username && 
-            !records[i].getIsReturned()) {
-            records[i].setReturnDate(std::time(nullptr));
-            records[i].setIsReturned(true);
-            bookManager->updateBookStatus(isbn,0); //归还
-            // 检查等待队列
-            auto it = waitingQueues.find(isbn);
-            if (it != waitingQueues.end()) {
-                MyQueue<std::string>& queue = it->second;
-                if (!queue.isEmpty()) {
-                    std::string nextUser = queue.front();
-                    queue.dequeue();
-                    saveWaitingQueues("waiting_queues.json"); // 实时保存队列
-                    // 自动为队首用户借阅
-                    try {
-                        borrowBook(isbn, nextUser);
-                        saveToFile("borrow_records.json"); // 自动借阅后保存记录
-                    } catch (const std::exception& e) {
-                        // 如果自动借阅失败（如用户已借阅等），忽略
-                    }
-                    // 如果队列空了，移除队列
-                    if (queue.isEmpty()) {
-                        waitingQueues.erase(it);
-                        saveWaitingQueues("waiting_queues.json");
-                    }
-                }
-            }
-            saveToFile("borrow_records.json");
-            saveWaitingQueues("waiting_queues.json");
-            return true;
-        }
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    ChangeScope scope(this);
+    int i = findActiveLoan(isbn, username);
+    if (i >= 0) {
+        returnRecord(static_cast<uint32_t>(i));
+        return scope.commit();
     }
     return false;
 }
 
 bool BorrowManager::renewBook(const std::string& isbn, const std::string& username) {
-    for (size_t i = 0; i < records.getSize(); i++) {
-        if (records[i].getBookIsbn() == isbn && 
-            records[i].getUsername() == username && 
-            !records[i].getIsReturned()) {
-            time_t newDueDate = std::time(nullptr) + (DEFAULT_BORROW_DAYS * 24 * 60 * 60);
-            records[i].setDueDate(newDueDate);
-            return true;
-        }
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    ChangeScope scope(this);
+    int i = findActiveLoan(isbn, username);
+    if (i < 0) {
+        return false;
     }
-    return false;
+    renewRecord(static_cast<uint32_t>(i));
+    return scope.commit();
 }
 
 // 通过ID操作的方法
 void BorrowManager::returnBook(int recordId) {
-    for (size_t i = 0; i < records.getSize(); i++) {
-        if (records[i].getId() == recordId) {
-            if (records[i].getIsReturned()) {
-                throw std::runtime_error("该记录已归还");
-            }
-            records[i].setReturnDate(std::time(nullptr));
-            records[i].setIsReturned(true);
-            return;
-        }
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    ChangeScope scope(this);
+    int i = slotOfRecordId(recordId);
+    if (i < 0) {
+        throw std::runtime_error("未找到指定的借阅记录");
+    }
+    if (records[i].getIsReturned()) {
+        throw std::runtime_error("该记录已归还");
+    }
+    returnRecord(static_cast<uint32_t>(i));
+    if (!scope.commit()) {
+        throw std::runtime_error("借阅记录保存失败");
     }
-    throw std::runtime_error("未找到指定的借阅记录");
 }
 
 void BorrowManager::renewBook(int recordId) {
-    for (size_t i = 0; i < records.getSize(); i++) {
-        if (records[i].getId() == recordId) {
-            if (records[i].getIsReturned()) {
-                throw std::runtime_error("已归还的图书无法续借");
-            }
-            time_t newDueDate = std::time(nullptr) + (DEFAULT_BORROW_DAYS * 24 * 60 * 60);
-            records[i].setDueDate(newDueDate);
-            return;
-        }
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    ChangeScope scope(this);
+    int i = slotOfRecordId(recordId);
+    if (i < 0) {
+        throw std::runtime_error("未找到指定的借阅记录");
+    }
+    if (records[i].getIsReturned()) {
+        throw std::runtime_error("已归还的图书无法续借");
+    }
+    renewRecord(static_cast<uint32_t>(i));
+    if (!scope.commit()) {
+        throw std::runtime_error("借阅记录保存失败");
     }
-    throw std::runtime_error("未找到指定的借阅记录");
 }
 
-bool BorrowManager::returnBookByRecordId(const std::string& recordId) {
-    for (size_t i = 0; i < records.getSize(); i++) {
-        if (records[i].getRecordId() == recordId && !records[i].getIsReturned()) {
-            records[i].setReturnDate(std::time(nullptr));
-            records[i].setIsReturned(true);
-            bookManager->updateBookStatus(records[i].getBookIsbn(), 0);
-            // 自动处理等待队列
-            std::string isbn = records[i].getBookIsbn();
-            auto it = waitingQueues.find(isbn);
-            if (it != waitingQueues.end()) {
-                MyQueue<std::string>& queue = it->second;
-                if (!queue.isEmpty()) {
-                    std::string nextUser = queue.front();
-                    queue.dequeue();
-                    saveWaitingQueues("waiting_queues.json"); // 实时保存队列
-                    try {
-                        borrowBook(isbn, nextUser);
-                        saveToFile("borrow_records.json"); // 自动借阅后保存记录
-                    } catch (const std::exception& e) {
-                        // 自动借阅失败忽略
-                    }
-                    if (queue.isEmpty()) {
-                        waitingQueues.erase(it);
-                        saveWaitingQueues("waiting_queues.json");
-                    }
-                }
-            }
-            saveToFile("borrow_records.json");
-            saveWaitingQueues("waiting_queues.json");
-            return true;
-        }
+bool BorrowManager::returnBookByRecordId(int recordId) {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    ChangeScope scope(this);
+    int i = slotOfRecordId(recordId);
+    if (i >= 0 && !records[i].getIsReturned()) {
+        returnRecord(static_cast<uint32_t>(i));
+        return scope.commit();
     }
     return false;
 }
 
 MyVector<BorrowRecord> BorrowManager::getUserBorrowRecords(const std::string& username) {
-    MyVector<BorrowRecord> userRecords;
-    for (size_t i = 0; i < records.getSize(); i++) {
-        if (records[i].getUsername() == username) {
-            userRecords.add(records[i]);
-        }
-    }
-    return userRecords;
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return collect(usernameGroups.find(username));
 }
 
 MyVector<BorrowRecord> BorrowManager::getBookBorrowRecords(const std::string& isbn) {
-    MyVector<BorrowRecord> bookRecords;
-    for (size_t i = 0; i < records.getSize(); i++) {
-        if (records[i].getBookIsbn() == isbn) {
-            bookRecords.add(records[i]);
-        }
-    }
-    return bookRecords;
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return collect(isbnGroups.find(isbn));
+}
+
+const BorrowRecord* BorrowManager::findActiveLoanByIsbn(const std::string& isbn) const {
+    const uint32_t* index = activeIsbnIndex.find(isbn);
+    return index ? &records[*index] : nullptr;
 }
 
 MyVector<BorrowRecord> BorrowManager::getOverdueRecords() {
-    MyVector<BorrowRecord> overdueRecords;
     time_t now = std::time(nullptr);
-    for (size_t i = 0; i < records.getSize(); i++) {
-        if (!records[i].getIsReturned() && records[i].getDueDate() < now) {
-            overdueRecords.add(records[i]);
-        }
-    }
-    return overdueRecords;
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return records.filter([now](const BorrowRecord& record) {
+        return !record.getIsReturned() && record.getDueDate() < now;
+    });
 }
 
+// 只遍历该用户自己的记录
 size_t BorrowManager::getBorrowCount(const std::string& username) const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
     size_t count = 0;
-    for (size_t i = 0; i < records.getSize(); i++) {
-        if (records[i].getUsername() == username && !records[i].getIsReturned()) {
+    const MyVector<uint32_t>* group = usernameGroups.find(username);
+    for (size_t i = 0; group && i < group->getSize(); i++) {
+        if (!records[(*group)[i]].getIsReturned()) {
             count++;
         }
     }
@@ -214,44 +397,45 @@ size_t BorrowManager::getBorrowCount(const std::string& username) const {
 }
 
 size_t BorrowManager::getOverdueCount(const std::string& username) const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
     size_t count = 0;
     time_t now = std::time(nullptr);
-    for (size_t i = 0; i < records.getSize(); i++) {
-        if (records[i].getUsername() == username && 
-            !records[i].getIsReturned() && 
-            records[i].getDueDate() < now) {
+    const MyVector<uint32_t>* group = usernameGroups.find(username);
+    for (size_t i = 0; group && i < group->getSize(); i++) {
+        const BorrowRecord& record = records[(*group)[i]];
+        if (!record.getIsReturned() && record.getDueDate() < now) {
             count++;
         }
     }
     return count;
 }
 
-//查找方法实现
-BorrowRecord* BorrowManager::findByRecordId(MyVector<BorrowRecord> &record, const std::string& recordId){
-    int index = record.hashFindByRecordId(recordId);
-    return index >= 0 ? &record[index] : nullptr;
+const BorrowRecord* BorrowManager::findRecordById(int recordId) const {
+    int i = slotOfRecordId(recordId);
+    return i >= 0 ? &records[i] : nullptr;
 }
 
-MyVector<BorrowRecord> BorrowManager::findByISBN(MyVector<BorrowRecord> &record, const std::string& ISBN){
-    MyVector<BorrowRecord> result;
+//查找方法实现
+BorrowRecord* BorrowManager::findByRecordId(MyVector<BorrowRecord> &record, int recordId){
+    // 传入的记录集可能是筛选或排序后的副本，按整数编号逐条比对
     for (size_t i = 0; i < record.getSize(); ++i) {
-        const BorrowRecord& borrowRecord = record[i];
-        if (borrowRecord.getIsbn() == ISBN) {
-            result.add(borrowRecord);
+        if (record[i].getId() == recordId) {
+            return &record[i];
         }
     }
-    return result;
+    return nullptr;
+}
+
+MyVector<BorrowRecord> BorrowManager::findByISBN(MyVector<BorrowRecord> &record, const std::string& ISBN){
+    return record.filter([&ISBN](const BorrowRecord& borrowRecord) {
+        return borrowRecord.getIsbn() == ISBN;
+    });
 }
 
 MyVector<BorrowRecord> BorrowManager::findByUsername(MyVector<BorrowRecord> &record, const std::string& username){
-    MyVector<BorrowRecord> result;
-    for (size_t i = 0; i < record.getSize(); ++i) {
-        const BorrowRecord& borrowRecord = record[i];
-        if (borrowRecord.getUsername().find(username) != std::string::npos) {
-            result.add(borrowRecord);
-        }
-    }
-    return result;
+    return record.filter([&username](const BorrowRecord& borrowRecord) {
+        return borrowRecord.getUsername().find(username) != std::string::npos;
+    });
 }
 
 MyVector<BorrowRecord> BorrowManager::findByBorrowDate(MyVector<BorrowRecord> &record, const std::string& borrowDate){
@@ -319,40 +503,37 @@ MyVector<BorrowRecord> BorrowManager::findByDueDate(MyVector<BorrowRecord> &reco
 }
 
 MyVector<BorrowRecord> BorrowManager::findByStatus(MyVector<BorrowRecord> &record, const std::string& status){
-    MyVector<BorrowRecord> result;
-    for (size_t i = 0; i < record.getSize(); ++i) {
-        const BorrowRecord& borrowRecord = record[i];
-        if (borrowRecord.getStatus() == status) {
-            result.add(borrowRecord);
-        }
-    }
-    return result;
+    return record.filter([&status](const BorrowRecord& borrowRecord) {
+        return borrowRecord.getStatus() == status;
+    });
 }
 
 // 数据持久化方法实现
+// 先写临时文件再替换，写到一半崩溃不会损坏原快照
 bool BorrowManager::saveToFile(const QString& filename) const {
-    QFile file(filename);
-    if (!file.open(QIODevice::WriteOnly)) {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return writeRecords(filename);
+}
+
+bool BorrowManager::writeRecords(const QString& filename) const {
+    JsonWriter writer;
+    if (!writer.open(QFile::encodeName(filename).toStdString())) {
         qDebug() << "无法打开文件进行写入:" << filename;
         return false;
     }
     
-    QJsonArray recordsArray;
+    writer.beginObject();
+    writer.key("records");
+    writer.beginArray();
     for (size_t i = 0; i < records.getSize(); ++i) {
-        recordsArray.append(records[i].toJson());
+        records[i].writeJson(writer);
     }
+    writer.endArray();
+    writer.key("count");
+    writer.value(static_cast<int>(records.getSize()));
+    writer.endObject();
     
-    QJsonObject rootObject;
-    rootObject["records"] = recordsArray;
-    rootObject["count"] = static_cast<int>(records.getSize());
-    
-    QJsonDocument doc(rootObject);
-    QByteArray jsonData = doc.toJson(QJsonDocument::Indented);
-    
-    qint64 bytesWritten = file.write(jsonData);
-    file.close();
-    
-    if (bytesWritten == -1) {
+    if (!writer.commit()) {
         qDebug() << "写入文件失败:" << filename;
         return false;
     }
@@ -362,108 +543,299 @@ bool BorrowManager::saveToFile(const QString& filename) const {
 }
 
 bool BorrowManager::loadFromFile(const QString& filename) {
-    QFile file(filename);
-    if (!file.open(QIODevice::ReadOnly)) {
+    // 解析不持锁，成功后才替换现有数据
+    MyVector<BorrowRecord> loaded;
+    if (!readRecords(filename, loaded)) {
+        return false;
+    }
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    records = std::move(loaded);
+    rebuildIndex();
+    qDebug() << "成功加载" << records.getSize() << "条借阅记录从文件:" << filename;
+    return records.getSize() > 0;
+}
+
+bool BorrowManager::readRecords(const QString& filename, MyVector<BorrowRecord>& loaded) {
+    JsonReader reader;
+    if (!reader.open(QFile::encodeName(filename).toStdString())) {
         qDebug() << "无法打开文件进行读取:" << filename;
         return false;
     }
     
-    QByteArray jsonData = file.readAll();
-    file.close();
-    
-    QJsonParseError parseError;
-    QJsonDocument doc = QJsonDocument::fromJson(jsonData, &parseError);
-    
-    if (parseError.error != QJsonParseError::NoError) {
-        qDebug() << "JSON解析错误:" << parseError.errorString();
+    // 边读边构造借阅记录
+    bool hasRecords = false;
+    bool parsed = reader.readRootArray("records", hasRecords, [&]() {
+        return loaded.emplace_back().readJson(reader);
+    });
+    if (!parsed) {
+        qDebug() << "JSON解析错误:" << filename;
         return false;
     }
-    
-    QJsonObject rootObject = doc.object();
-    if (!rootObject.contains("records")) {
+    if (!hasRecords) {
         qDebug() << "文件格式错误: 缺少records字段";
         return false;
     }
-    
-    QJsonArray recordsArray = rootObject["records"].toArray();
-    
-    // 清空现有数据
-    records = MyVector<BorrowRecord>();
-    
-    // 加载借阅记录数据
-    int successCount = 0;
-    for (const QJsonValue& value : recordsArray) {
-        if (value.isObject()) {
-            BorrowRecord record;
-            record.fromJson(value.toObject());
-            try {
-                records.add(record);
-                successCount++;
-            } catch (const std::exception& e) {
-                qDebug() << "加载借阅记录失败:" << e.what();
-                continue;
-            }
-        }
+    return true;
+}
+
+bool BorrowManager::saveToBinaryFile(const std::string& filename) const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return writeBinaryRecords(filename);
+}
+
+bool BorrowManager::writeBinaryRecords(const std::string& filename) const {
+    if (!BinarySnapshot::saveBorrowRecords(filename, records)) {
+        qDebug() << "写入二进制快照失败:" << QString::fromLocal8Bit(filename.c_str());
+        return false;
     }
-    
-    qDebug() << "成功加载" << successCount << "条借阅记录从文件:" << filename;
-    return successCount > 0;
+    return true;
+}
+
+bool BorrowManager::loadFromBinaryFile(const std::string& filename) {
+    MyVector<BorrowRecord> loaded;
+    if (!readBinaryRecords(filename, loaded)) {
+        return false;
+    }
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    records = std::move(loaded);
+    rebuildIndex();
+    qDebug() << "成功加载" << records.getSize() << "条借阅记录从文件:" << QString::fromLocal8Bit(filename.c_str());
+    return true;
+}
+
+bool BorrowManager::readBinaryRecords(const std::string& filename, MyVector<BorrowRecord>& loaded) {
+    if (!BinarySnapshot::loadBorrowRecords(filename, loaded)) {
+        qDebug() << "二进制快照损坏或无法读取:" << QString::fromLocal8Bit(filename.c_str());
+        return false;
+    }
+    return true;
 }
 
 int BorrowManager::getWaitingCount(const std::string& isbn) const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
     auto it = waitingQueues.find(isbn);
     if (it == waitingQueues.end()) return 0;
     return static_cast<int>(it->second.size());
 }
 
 bool BorrowManager::isUserInQueue(const std::string& isbn, const std::string& username) const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
     auto it = waitingQueues.find(isbn);
     if (it == waitingQueues.end()) return false;
     return it->second.contains(username);
 }
 
-void BorrowManager::saveWaitingQueues(const QString& filename) const {
-    QFile file(filename);
-    if (!file.open(QIODevice::WriteOnly)) {
+bool BorrowManager::saveWaitingQueues(const QString& filename) const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return writeQueues(filename);
+}
+
+bool BorrowManager::writeQueues(const QString& filename) const {
+    JsonWriter writer;
+    if (!writer.open(QFile::encodeName(filename).toStdString())) {
         qDebug() << "无法打开队列文件进行写入:" << filename;
-        return;
+        return false;
     }
-    QJsonObject rootObj;
+    writer.beginObject();
     for (const auto& pair : waitingQueues) {
-        rootObj[QString::fromStdString(pair.first)] = pair.second.toJsonArray();
+        writer.key(pair.first);
+        writer.beginArray();
+        pair.second.forEach([&](const std::string& username) { writer.value(username); });
+        writer.endArray();
+    }
+    writer.endObject();
+    if (!writer.commit()) {
+        qDebug() << "写入队列文件失败:" << filename;
+        return false;
     }
-    QJsonDocument doc(rootObj);
-    file.write(doc.toJson(QJsonDocument::Indented));
-    file.close();
+    return true;
 }
 
 bool BorrowManager::loadWaitingQueues(const QString& filename) {
-    QFile file(filename);
-    if (!file.open(QIODevice::ReadOnly)) {
+    std::map<std::string, MyQueue<std::string>> queues;
+    if (!readQueues(filename, queues)) {
+        return false;
+    }
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    waitingQueues = std::move(queues);
+    return true;
+}
+
+bool BorrowManager::readQueues(const QString& filename, std::map<std::string, MyQueue<std::string>>& queues) {
+    JsonReader reader;
+    if (!reader.open(QFile::encodeName(filename).toStdString())) {
         qDebug() << "无法打开队列文件进行读取:" << filename;
         return false;
     }
-    QByteArray jsonData = file.readAll();
-    file.close();
-    QJsonParseError parseError;
-    QJsonDocument doc = QJsonDocument::fromJson(jsonData, &parseError);
-    if (parseError.error != QJsonParseError::NoError) {
-        qDebug() << "队列JSON解析错误:" << parseError.errorString();
+    // 文件格式：{"ISBN": ["用户名", ...], ...}
+    JsonReader::Token token = reader.next();
+    bool ok = token == JsonReader::BEGIN_OBJECT;
+    while (ok && (token = reader.next()) == JsonReader::KEY) {
+        MyQueue<std::string>& queue = queues[reader.getKey()];
+        token = reader.next();
+        if (token != JsonReader::BEGIN_ARRAY) {
+            ok = reader.skipValue(token);
+            continue;
+        }
+        while (ok && (token = reader.next()) != JsonReader::END_ARRAY) {
+            if (token == JsonReader::STRING) {
+                queue.enqueue(reader.getString());
+            } else {
+                ok = reader.skipValue(token);
+            }
+        }
+    }
+    if (!ok || token != JsonReader::END_OBJECT || reader.next() != JsonReader::END) {
+        qDebug() << "队列JSON解析错误:" << filename;
         return false;
     }
-    QJsonObject rootObj = doc.object();
+    return true;
+}
+
+// 重放一条日志；快照可能已包含该变动（写完快照、清空日志前崩溃），因此每种变动都按幂等方式处理
+void BorrowManager::applyJournalEntry(const JournalEntry& entry) {
+    switch (entry.type) {
+    case JournalEntry::BORROW:
+        if (slotOfRecordId(entry.recordId) < 0) {
+            addRecord(BorrowRecord(entry.recordId, entry.isbn, entry.username, entry.time1, entry.time2));
+            bookManager->updateBookStatus(entry.isbn, 1);
+        }
+        break;
+    case JournalEntry::RETURN: {
+        int i = slotOfRecordId(entry.recordId);
+        if (i >= 0 && !records[i].getIsReturned()) {
+            markReturned(static_cast<uint32_t>(i), entry.time1);
+            bookManager->updateBookStatus(records[i].getBookIsbn(), 0);
+        }
+        break;
+    }
+    case JournalEntry::RENEW: {
+        int i = slotOfRecordId(entry.recordId);
+        if (i >= 0) {
+            records[i].setDueDate(entry.time1);
+        }
+        break;
+    }
+    case JournalEntry::ENQUEUE: {
+        MyQueue<std::string>& queue = waitingQueues[entry.isbn];
+        if (!queue.contains(entry.username)) {
+            queue.enqueue(entry.username);
+        }
+        break;
+    }
+    case JournalEntry::DEQUEUE: {
+        auto it = waitingQueues.find(entry.isbn);
+        if (it != waitingQueues.end()) {
+            if (!it->second.isEmpty() && it->second.front() == entry.username) {
+                it->second.dequeue();
+            }
+            if (it->second.isEmpty()) {
+                waitingQueues.erase(it);
+            }
+        }
+        break;
+    }
+    }
+}
+
+bool BorrowManager::openJournal(const QString& snapshotFile, const QString& queueFile, const QString& journalFile) {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    journal.close();
+    snapshotPath = snapshotFile.toStdString();
+    queuePath = queueFile.toStdString();
+    journalPath = QFile::encodeName(journalFile).toStdString();
+    return reloadUnlocked();
+}
+
+bool BorrowManager::reloadFromJournal() {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    return reloadUnlocked();
+}
+
+// 按文件名选择格式载入快照，失败时保留现有记录
+bool BorrowManager::loadSnapshot() {
+    QString snapshotFile = QString::fromStdString(snapshotPath);
+    MyVector<BorrowRecord> loaded;
+    bool ok = BinarySnapshot::isBinaryPath(snapshotPath)
+                  ? readBinaryRecords(QFile::encodeName(snapshotFile).toStdString(), loaded)
+                  : readRecords(snapshotFile, loaded);
+    if (!ok) {
+        return false;
+    }
+    records = std::move(loaded);
+    rebuildIndex();
+    qDebug() << "成功加载" << records.getSize() << "条借阅记录从文件:" << snapshotFile;
+    return true;
+}
+
+bool BorrowManager::reloadUnlocked() {
+    journal.close();
+    journalBroken = false;
+    QString snapshotFile = QString::fromStdString(snapshotPath);
+    QString queueFile = QString::fromStdString(queuePath);
+    if (QFile::exists(snapshotFile)) {
+        loadSnapshot();
+    } else {
+        records = MyVector<BorrowRecord>();
+        rebuildIndex();
+    }
     waitingQueues.clear();
-    for (auto it = rootObj.begin(); it != rootObj.end(); ++it) {
-        std::string isbn = it.key().toStdString();
-        MyQueue<std::string> queue;
-        queue.fromJsonArray(it.value().toArray());
-        waitingQueues[isbn] = queue;
+    std::map<std::string, MyQueue<std::string>> queues;
+    if (QFile::exists(queueFile) && readQueues(queueFile, queues)) {
+        waitingQueues = std::move(queues);
+    }
+
+    MyVector<JournalEntry> entries;
+    size_t validBytes = 0;
+    if (!BorrowJournal::readAll(journalPath, entries, validBytes)) {
+        qDebug() << "借阅日志读取失败:" << QString::fromStdString(journalPath);
+        return false;
+    }
+    for (size_t i = 0; i < entries.getSize(); ++i) {
+        applyJournalEntry(entries[i]);
+    }
+    if (!journal.open(journalPath, validBytes, entries.getSize())) {
+        qDebug() << "借阅日志打开失败:" << QString::fromStdString(journalPath);
+        return false;
+    }
+    qDebug() << "借阅日志重放" << entries.getSize() << "条变动";
+    // 日志已完整载入，快照写不成只是推迟清空日志
+    if (journal.getEntryCount() >= COMPACT_THRESHOLD && !compactUnlocked()) {
+        qDebug() << "借阅快照写入失败，日志暂不清空:" << QString::fromStdString(snapshotPath);
+    }
+    return true;
+}
+
+bool BorrowManager::compact() {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    return compactUnlocked();
+}
+
+bool BorrowManager::compactUnlocked() {
+    if (!journal.isOpen()) {
+        return false;
+    }
+    // 快照和队列都写成功后才能清空日志
+    QString snapshotFile = QString::fromStdString(snapshotPath);
+    bool saved = BinarySnapshot::isBinaryPath(snapshotPath)
+                     ? writeBinaryRecords(QFile::encodeName(snapshotFile).toStdString())
+                     : writeRecords(snapshotFile);
+    if (!saved || !writeQueues(QString::fromStdString(queuePath))) {
+        return false;
     }
+    if (!journal.reset()) {
+        return false;
+    }
+    // 残缺的日志已随清空一并丢弃
+    journalBroken = false;
     return true;
 }
 
-// 排序功能实现
+// 排序功能实现，降序时交换参数比较，保持严格弱序
 static bool compareBorrowRecords(const BorrowRecord& a, const BorrowRecord& b, BorrowSortBy sortBy, BorrowSortOrder order) {
+    if (order == BorrowSortOrder::DESCENDING) {
+        return compareBorrowRecords(b, a, sortBy, BorrowSortOrder::ASCENDING);
+    }
     bool result = false;
     
     switch (sortBy) {
@@ -490,31 +862,84 @@ static bool compareBorrowRecords(const BorrowRecord& a, const BorrowRecord& b, B
         break;
     }
     
-    return order == BorrowSortOrder::ASCENDING ? result : !result;
+    return result;
 }
 
-void BorrowManager::sortBorrowRecords(MyVector<BorrowRecord> &recordList, BorrowSortBy sortBy, BorrowSortOrder order) const {
-    if (recordList.getSize() <= 1) {
-        return;
+// 记录下标的比较函数：键相同时按下标升序，降序是升序整体反转
+static auto recordIndexLess(const MyVector<BorrowRecord> &recordList, BorrowSortBy sortBy, BorrowSortOrder order) {
+    bool descending = order == BorrowSortOrder::DESCENDING;
+    return [&recordList, sortBy, descending](uint32_t a, uint32_t b) -> bool {
+        if (descending) std::swap(a, b);
+        if (compareBorrowRecords(recordList[a], recordList[b], sortBy, BorrowSortOrder::ASCENDING)) return true;
+        if (compareBorrowRecords(recordList[b], recordList[a], sortBy, BorrowSortOrder::ASCENDING)) return false;
+        return a < b;
+    };
+}
+
+static MyVector<uint32_t> identityIndices(size_t length) {
+    MyVector<uint32_t> indices(length);
+    for (size_t i = 0; i < length; ++i) {
+        indices.push_back(static_cast<uint32_t>(i));
+    }
+    return indices;
+}
+
+// 对记录下标排序，记录本身不移动
+MyVector<uint32_t> BorrowManager::sortIndices(const MyVector<BorrowRecord> &recordList, BorrowSortBy sortBy, BorrowSortOrder order) {
+    size_t length = recordList.getSize();
+    MyVector<uint32_t> indices = identityIndices(length);
+    if (length <= 1) {
+        return indices;
     }
     
-    auto comp = [sortBy, order](const BorrowRecord& a, const BorrowRecord& b) -> bool {
-        return compareBorrowRecords(a, b, sortBy, order);
-    };
+    // 数据量大时分块并行排序，小数组自动退回单线程
+    MyAlgorithm::parallelSort(&indices[0], length, recordIndexLess(recordList, sortBy, order));
+    return indices;
+}
+
+MyVector<BorrowRecord> BorrowManager::getSortedPage(BorrowSortBy sortBy, BorrowSortOrder order, size_t offset, size_t limit) const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    size_t total = records.getSize();
+    size_t begin = offset < total ? offset : total;
+    size_t end = limit < total - begin ? begin + limit : total;
+    MyVector<BorrowRecord> page(end - begin);
+    if (begin == end) {
+        return page;
+    }
     
-    BorrowRecord* arr = &recordList[0];
-    int length = static_cast<int>(recordList.getSize());
-    MyAlgorithm::sort(arr, length, comp);
+    // 先定位第 offset 位，再从其后堆选出 limit 个，不排序整张表
+    MyVector<uint32_t> indices = identityIndices(total);
+    auto comp = recordIndexLess(records, sortBy, order);
+    if (begin > 0) {
+        MyAlgorithm::nthElement(&indices[0], total, begin, comp);
+    }
+    MyAlgorithm::partialSort(&indices[begin], total - begin, end - begin, comp);
+    for (size_t i = begin; i < end; ++i) {
+        page.emplace_back(records[indices[i]]);
+    }
+    return page;
+}
+
+MyVector<uint32_t> BorrowManager::getSortedRecordIndices(BorrowSortBy sortBy, BorrowSortOrder order) const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return sortIndices(records, sortBy, order);
 }
 
 MyVector<BorrowRecord> BorrowManager::getSortedBorrowRecords(BorrowSortBy sortBy, BorrowSortOrder order) const {
-    MyVector<BorrowRecord> sortedRecords = records;
-    sortBorrowRecords(sortedRecords, sortBy, order);
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    MyVector<uint32_t> indices = sortIndices(records, sortBy, order);
+    MyVector<BorrowRecord> sortedRecords(indices.getSize());
+    for (size_t i = 0; i < indices.getSize(); ++i) {
+        sortedRecords.emplace_back(records[indices[i]]);
+    }
     return sortedRecords;
 }
 
 MyVector<BorrowRecord> BorrowManager::sortSearchResults(const MyVector<BorrowRecord> &searchResults, BorrowSortBy sortBy, BorrowSortOrder order) const {
-    MyVector<BorrowRecord> sortedResults = searchResults;
-    sortBorrowRecords(sortedResults, sortBy, order);
+    MyVector<uint32_t> indices = sortIndices(searchResults, sortBy, order);
+    MyVector<BorrowRecord> sortedResults(indices.getSize());
+    for (size_t i = 0; i < indices.getSize(); ++i) {
+        sortedResults.emplace_back(searchResults[indices[i]]);
+    }
     return sortedResults;
 } 
@@ -1,8 +1,11 @@
 #include "../include/BorrowRecord.h"
+#include "../include/JsonStream.h"
 #include <sstream>
 #include <iomanip>
 #include <chrono>
 #include <ctime>
+#include <cstdio>
+#include <climits>
 #include <QJsonObject>
 #include <QJsonDocument>
 #include <QString>
@@ -24,26 +27,70 @@ BorrowRecord::BorrowRecord(const std::string& bookIsbn,
     , isReturned(false) {
 }
 
+BorrowRecord::BorrowRecord(int id,
+                         const std::string& bookIsbn,
+                         const std::string& username,
+                         time_t borrowDate,
+                         time_t dueDate)
+    : id(id)
+    , bookIsbn(bookIsbn)
+    , username(username)
+    , borrowDate(borrowDate)
+    , dueDate(dueDate)
+    , returnDate(0)
+    , isReturned(false) {
+    if (id >= nextId) {
+        nextId = id + 1;
+    }
+}
+
 // getter 方法实现
 int BorrowRecord::getId() const {
     return id;
 }
 
 std::string BorrowRecord::getRecordId() const {
-    std::stringstream ss;
-    ss << "REC" << std::setfill('0') << std::setw(6) << id;
-    return ss.str();
+    return formatRecordId(id);
+}
+
+std::string BorrowRecord::formatRecordId(int id) {
+    char buffer[24];
+    std::snprintf(buffer, sizeof(buffer), "REC%06d", id);
+    return buffer;
+}
+
+int BorrowRecord::parseRecordId(const std::string& recordId) {
+    size_t pos = 0;
+    if (recordId.size() >= 3 && (recordId[0] == 'R' || recordId[0] == 'r')
+        && (recordId[1] == 'E' || recordId[1] == 'e') && (recordId[2] == 'C' || recordId[2] == 'c')) {
+        pos = 3;
+    }
+    if (pos == recordId.size()) {
+        return -1;
+    }
+    long long value = 0;
+    for (; pos < recordId.size(); ++pos) {
+        char c = recordId[pos];
+        if (c < '0' || c > '9') {
+            return -1;
+        }
+        value = value * 10 + (c - '0');
+        if (value > INT_MAX) {
+            return -1;
+        }
+    }
+    return static_cast<int>(value);
 }
 
-std::string BorrowRecord::getIsbn() const {
+const std::string& BorrowRecord::getIsbn() const {
     return bookIsbn;
 }
 
-std::string BorrowRecord::getBookIsbn() const {
+const std::string& BorrowRecord::getBookIsbn() const {
     return bookIsbn;
 }
 
-std::string BorrowRecord::getUsername() const {
+const std::string& BorrowRecord::getUsername() const {
     return username;
 }
 
@@ -165,4 +212,57 @@ void BorrowRecord::fromJson(const QJsonObject& json) {
     if (json.contains("isReturned")) {
         isReturned = json["isReturned"].toBool();
     }
-}
\ No newline at end of file
+}
+
+void BorrowRecord::writeJson(JsonWriter& writer) const {
+    writer.beginObject();
+    writer.key("id");
+    writer.value(id);
+    writer.key("bookIsbn");
+    writer.value(bookIsbn);
+    writer.key("username");
+    writer.value(username);
+    writer.key("borrowDate");
+    writer.value(static_cast<long long>(borrowDate));
+    writer.key("dueDate");
+    writer.value(static_cast<long long>(dueDate));
+    writer.key("returnDate");
+    writer.value(static_cast<long long>(returnDate));
+    writer.key("isReturned");
+    writer.value(isReturned);
+    writer.endObject();
+}
+
+// 与 fromJson 一致：缺少的字段保持原值，类型不符的字段忽略
+bool BorrowRecord::readJson(JsonReader& reader) {
+    JsonReader::Token token;
+    while ((token = reader.next()) == JsonReader::KEY) {
+        const std::string& name = reader.getKey();
+        token = reader.next();
+        if (token == JsonReader::NUMBER && name == "id") {
+            if (!isValidId(reader.getInteger())) {
+                return false;
+            }
+            id = static_cast<int>(reader.getInteger());
+            // 更新nextId以确保ID唯一性
+            if (id >= nextId) {
+                nextId = id + 1;
+            }
+        } else if (token == JsonReader::STRING && name == "bookIsbn") {
+            bookIsbn = reader.getString();
+        } else if (token == JsonReader::STRING && name == "username") {
+            username = reader.getString();
+        } else if (token == JsonReader::NUMBER && name == "borrowDate") {
+            borrowDate = static_cast<time_t>(reader.getInteger());
+        } else if (token == JsonReader::NUMBER && name == "dueDate") {
+            dueDate = static_cast<time_t>(reader.getInteger());
+        } else if (token == JsonReader::NUMBER && name == "returnDate") {
+            returnDate = static_cast<time_t>(reader.getInteger());
+        } else if (token == JsonReader::BOOL && name == "isReturned") {
+            isReturned = reader.getBool();
+        } else if (!reader.skipValue(token)) {
+            return false;
+        }
+    }
+    return token == JsonReader::END_OBJECT;
+}
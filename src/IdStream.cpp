@@ -0,0 +1,53 @@
+#include "../include/IdStream.h"
+#include "../include/InvertedIndex.h"
+
+uint32_t ListStream::seek(uint32_t target) {
+    position = InvertedIndex::gallop(*list, position, target);
+    return position < list->getSize() ? (*list)[position] : END;
+}
+
+uint32_t AndStream::seek(uint32_t target) {
+    uint32_t candidate = streams[0]->seek(target);
+    size_t agreed = 1;
+    size_t i = 1;
+    // 轮流跳到当前最大的候选，直到所有子流都停在同一下标
+    while (candidate != END && agreed < streams.getSize()) {
+        uint32_t id = streams[i]->seek(candidate);
+        if (id == candidate) {
+            ++agreed;
+        } else {
+            candidate = id;
+            agreed = 1;
+        }
+        i = (i + 1) % streams.getSize();
+    }
+    return candidate;
+}
+
+OrStream::OrStream(MyVector<std::unique_ptr<IdStream>>&& streams)
+    : streams(std::move(streams)), heads(this->streams.getSize()) {
+    for (size_t i = 0; i < this->streams.getSize(); ++i) {
+        heads.push_back(this->streams[i]->seek(0));
+    }
+}
+
+uint32_t OrStream::seek(uint32_t target) {
+    uint32_t smallest = END;
+    for (size_t i = 0; i < streams.getSize(); ++i) {
+        if (heads[i] < target) {
+            heads[i] = streams[i]->seek(target);
+        }
+        if (heads[i] < smallest) {
+            smallest = heads[i];
+        }
+    }
+    return smallest;
+}
+
+uint32_t FilterStream::seek(uint32_t target) {
+    uint32_t id = source->seek(target);
+    while (id != END && !keep(id)) {
+        id = source->seek(id + 1);
+    }
+    return id;
+}
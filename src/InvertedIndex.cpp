@@ -0,0 +1,143 @@
+#include "../include/InvertedIndex.h"
+
+InvertedIndex::InvertedIndex() : termIndex(TermTextOf{this}) {}
+
+void InvertedIndex::clear() {
+    terms.clear();
+    termIndex.clear();
+    postingCount = 0;
+}
+
+// 第一个不小于 target 的位置
+static size_t lowerBound(const MyVector<uint32_t>& list, uint32_t target) {
+    size_t left = 0;
+    size_t right = list.getSize();
+    while (left < right) {
+        size_t mid = left + (right - left) / 2;
+        if (list[mid] < target) {
+            left = mid + 1;
+        } else {
+            right = mid;
+        }
+    }
+    return left;
+}
+
+void InvertedIndex::add(std::string_view term, uint32_t id) {
+    const uint32_t* slot = termIndex.find(term);
+    if (!slot) {
+        Term& created = terms.emplace_back();
+        created.text = std::string(term);
+        created.postings.push_back(id);
+        termIndex.insert(created.text, static_cast<uint32_t>(terms.getSize() - 1));
+        ++postingCount;
+        return;
+    }
+    MyVector<uint32_t>& postings = terms[*slot].postings;
+    size_t size = postings.getSize();
+    // 建索引时下标递增，通常直接追加
+    if (size == 0 || postings[size - 1] < id) {
+        postings.push_back(id);
+        ++postingCount;
+        return;
+    }
+    size_t pos = lowerBound(postings, id);
+    if (postings[pos] == id) {
+        return;
+    }
+    postings.push_back(postings[size - 1]);
+    for (size_t i = size - 1; i > pos; --i) {
+        postings[i] = postings[i - 1];
+    }
+    postings[pos] = id;
+    ++postingCount;
+}
+
+void InvertedIndex::erase(std::string_view term, uint32_t id) {
+    const uint32_t* slot = termIndex.find(term);
+    if (!slot) {
+        return;
+    }
+    MyVector<uint32_t>& postings = terms[*slot].postings;
+    size_t pos = lowerBound(postings, id);
+    if (pos < postings.getSize() && postings[pos] == id) {
+        postings.removeAt(pos);
+        --postingCount;
+    }
+}
+
+void InvertedIndex::shiftDown(const MyVector<uint32_t>& removed) {
+    if (removed.getSize() == 0) return;
+    for (size_t t = 0; t < terms.getSize(); ++t) {
+        MyVector<uint32_t>& postings = terms[t].postings;
+        // 倒排表与 removed 都升序，同向推进，比当前下标小的已删除下标个数即减量
+        size_t below = 0;
+        for (size_t i = lowerBound(postings, removed[0]); i < postings.getSize(); ++i) {
+            while (below < removed.getSize() && removed[below] < postings[i]) {
+                ++below;
+            }
+            postings[i] -= static_cast<uint32_t>(below);
+        }
+    }
+}
+
+const MyVector<uint32_t>* InvertedIndex::find(std::string_view term) const {
+    const uint32_t* slot = termIndex.find(term);
+    return slot ? &terms[*slot].postings : nullptr;
+}
+
+size_t InvertedIndex::gallop(const MyVector<uint32_t>& list, size_t from, uint32_t target) {
+    size_t size = list.getSize();
+    size_t step = 1;
+    size_t high = from;
+    while (high < size && list[high] < target) {
+        from = high + 1;
+        high += step;
+        step <<= 1;
+    }
+    if (high > size) {
+        high = size;
+    }
+    while (from < high) {
+        size_t mid = from + (high - from) / 2;
+        if (list[mid] < target) {
+            from = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return from;
+}
+
+void InvertedIndex::intersect(MyVector<uint32_t>& result, const MyVector<uint32_t>& other) {
+    size_t kept = 0;
+    size_t pos = 0;
+    for (size_t i = 0; i < result.getSize() && pos < other.getSize(); ++i) {
+        uint32_t target = result[i];
+        pos = gallop(other, pos, target);
+        if (pos < other.getSize() && other[pos] == target) {
+            result[kept++] = target;
+        }
+    }
+    while (result.getSize() > kept) {
+        result.removeAt(result.getSize() - 1);
+    }
+}
+
+MyVector<uint32_t> InvertedIndex::unite(const MyVector<uint32_t>& a, const MyVector<uint32_t>& b) {
+    MyVector<uint32_t> merged(a.getSize() + b.getSize());
+    size_t i = 0;
+    size_t j = 0;
+    while (i < a.getSize() || j < b.getSize()) {
+        if (j >= b.getSize() || (i < a.getSize() && a[i] < b[j])) {
+            merged.push_back(a[i++]);
+        } else if (i >= a.getSize() || b[j] < a[i]) {
+            merged.push_back(b[j++]);
+        } else {
+            merged.push_back(a[i]);
+            ++i;
+            ++j;
+        }
+    }
+    return merged;
+}
@@ -0,0 +1,424 @@
+#include "../include/JsonStream.h"
+#include <cstdlib>
+#include <filesystem>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+// ---------------- JsonReader ----------------
+
+JsonReader::JsonReader() : buffer(new char[BUFFER_SIZE]) {}
+
+JsonReader::~JsonReader() {
+    close();
+    delete[] buffer;
+}
+
+bool JsonReader::open(const std::string& path) {
+    close();
+    file = std::fopen(path.c_str(), "rb");
+    return file != nullptr;
+}
+
+void JsonReader::close() {
+    if (file) {
+        std::fclose(file);
+        file = nullptr;
+    }
+    position = 0;
+    length = 0;
+    containers.clear();
+    state = EXPECT_VALUE;
+    failed = false;
+}
+
+// 缓冲读完时读入下一块，文件结束返回 EOF
+int JsonReader::peek() {
+    if (position == length) {
+        if (!file) return EOF;
+        length = std::fread(buffer, 1, BUFFER_SIZE, file);
+        position = 0;
+        if (length == 0) return EOF;
+    }
+    return static_cast<unsigned char>(buffer[position]);
+}
+
+int JsonReader::get() {
+    int c = peek();
+    if (c != EOF) ++position;
+    return c;
+}
+
+void JsonReader::skipWhitespace() {
+    for (int c = peek(); c == ' ' || c == '\t' || c == '\n' || c == '\r'; c = peek()) {
+        ++position;
+    }
+}
+
+JsonReader::Token JsonReader::fail() {
+    failed = true;
+    return ERROR;
+}
+
+JsonReader::Token JsonReader::closeContainer(char open) {
+    size_t depth = containers.getSize();
+    if (depth == 0 || containers[depth - 1] != open) return fail();
+    containers.removeAt(depth - 1);
+    ++position;
+    state = AFTER_VALUE;
+    return open == '{' ? END_OBJECT : END_ARRAY;
+}
+
+JsonReader::Token JsonReader::next() {
+    if (failed) return ERROR;
+    skipWhitespace();
+    int c = peek();
+    switch (state) {
+    case AFTER_VALUE:
+        if (containers.getSize() == 0) {
+            // 顶层值之后只允许空白
+            return c == EOF ? END : fail();
+        }
+        if (c == ',') {
+            ++position;
+            state = containers[containers.getSize() - 1] == '{' ? EXPECT_KEY : EXPECT_VALUE;
+            return next();
+        }
+        if (c == '}') return closeContainer('{');
+        if (c == ']') return closeContainer('[');
+        return fail();
+    case OBJECT_START:
+        if (c == '}') return closeContainer('{');
+        [[fallthrough]];
+    case EXPECT_KEY:
+        if (c != '"') return fail();
+        ++position;
+        if (!readString(key)) return fail();
+        skipWhitespace();
+        if (get() != ':') return fail();
+        state = EXPECT_VALUE;
+        return KEY;
+    case ARRAY_START:
+        if (c == ']') return closeContainer('[');
+        [[fallthrough]];
+    case EXPECT_VALUE:
+        return readValue(c);
+    }
+    return fail();
+}
+
+JsonReader::Token JsonReader::readValue(int c) {
+    switch (c) {
+    case '{':
+    case '[':
+        if (containers.getSize() >= MAX_DEPTH) return fail();
+        ++position;
+        containers.push_back(static_cast<char>(c));
+        state = c == '{' ? OBJECT_START : ARRAY_START;
+        return c == '{' ? BEGIN_OBJECT : BEGIN_ARRAY;
+    case '"':
+        ++position;
+        if (!readString(text)) return fail();
+        state = AFTER_VALUE;
+        return STRING;
+    case 't':
+    case 'f':
+        boolValue = c == 't';
+        if (!readLiteral(boolValue ? "true" : "false")) return fail();
+        state = AFTER_VALUE;
+        return BOOL;
+    case 'n':
+        if (!readLiteral("null")) return fail();
+        state = AFTER_VALUE;
+        return NULL_VALUE;
+    default:
+        if (c != '-' && (c < '0' || c > '9')) return fail();
+        if (!readNumber()) return fail();
+        state = AFTER_VALUE;
+        return NUMBER;
+    }
+}
+
+// 读取引号内的字符串（开头的引号已读过），不含转义的片段整段复制
+bool JsonReader::readString(std::string& out) {
+    out.clear();
+    for (;;) {
+        if (peek() == EOF) return false;
+        size_t start = position;
+        while (position < length) {
+            unsigned char c = static_cast<unsigned char>(buffer[position]);
+            if (c == '"' || c == '\\' || c < 0x20) break;
+            ++position;
+        }
+        out.append(buffer + start, position - start);
+        if (position == length) continue;
+
+        unsigned char c = static_cast<unsigned char>(buffer[position++]);
+        if (c == '"') return true;
+        if (c < 0x20) return false;
+        switch (get()) {
+        case '"': out += '"'; break;
+        case '\\': out += '\\'; break;
+        case '/': out += '/'; break;
+        case 'b': out += '\b'; break;
+        case 'f': out += '\f'; break;
+        case 'n': out += '\n'; break;
+        case 'r': out += '\r'; break;
+        case 't': out += '\t'; break;
+        case 'u': {
+            unsigned code = 0;
+            if (!readHex4(code)) return false;
+            if (code >= 0xD800 && code <= 0xDBFF) {
+                // 代理对
+                unsigned low = 0;
+                if (get() != '\\' || get() != 'u' || !readHex4(low) || low < 0xDC00 || low > 0xDFFF) return false;
+                code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+            } else if (code >= 0xDC00 && code <= 0xDFFF) {
+                return false;
+            }
+            // 编码为 UTF-8
+            if (code < 0x80) {
+                out += static_cast<char>(code);
+            } else if (code < 0x800) {
+                out += static_cast<char>(0xC0 | (code >> 6));
+                out += static_cast<char>(0x80 | (code & 0x3F));
+            } else if (code < 0x10000) {
+                out += static_cast<char>(0xE0 | (code >> 12));
+                out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                out += static_cast<char>(0x80 | (code & 0x3F));
+            } else {
+                out += static_cast<char>(0xF0 | (code >> 18));
+                out += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+                out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                out += static_cast<char>(0x80 | (code & 0x3F));
+            }
+            break;
+        }
+        default:
+            return false;
+        }
+    }
+}
+
+bool JsonReader::readHex4(unsigned& value) {
+    value = 0;
+    for (int i = 0; i < 4; ++i) {
+        int c = get();
+        value <<= 4;
+        if (c >= '0' && c <= '9') value |= c - '0';
+        else if (c >= 'a' && c <= 'f') value |= c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F') value |= c - 'A' + 10;
+        else return false;
+    }
+    return true;
+}
+
+bool JsonReader::readLiteral(const char* literal) {
+    for (const char* p = literal; *p; ++p) {
+        if (get() != *p) return false;
+    }
+    return true;
+}
+
+// 按 JSON 数字语法读取，原文保存在 text 中
+bool JsonReader::readNumber() {
+    text.clear();
+    auto isDigit = [](int c) { return c >= '0' && c <= '9'; };
+    if (peek() == '-') text += static_cast<char>(get());
+    if (peek() == '0') {
+        text += static_cast<char>(get());
+    } else if (isDigit(peek())) {
+        while (isDigit(peek())) text += static_cast<char>(get());
+    } else {
+        return false;
+    }
+    if (peek() == '.') {
+        text += static_cast<char>(get());
+        if (!isDigit(peek())) return false;
+        while (isDigit(peek())) text += static_cast<char>(get());
+    }
+    if (peek() == 'e' || peek() == 'E') {
+        text += static_cast<char>(get());
+        if (peek() == '+' || peek() == '-') text += static_cast<char>(get());
+        if (!isDigit(peek())) return false;
+        while (isDigit(peek())) text += static_cast<char>(get());
+    }
+    return true;
+}
+
+long long JsonReader::getInteger() const {
+    if (text.find_first_of(".eE") != std::string::npos) {
+        return static_cast<long long>(std::strtod(text.c_str(), nullptr));
+    }
+    return std::strtoll(text.c_str(), nullptr, 10);
+}
+
+bool JsonReader::skipValue(Token first) {
+    if (first == BEGIN_OBJECT || first == BEGIN_ARRAY) {
+        size_t depth = 1;
+        while (depth > 0) {
+            Token token = next();
+            if (token == BEGIN_OBJECT || token == BEGIN_ARRAY) {
+                ++depth;
+            } else if (token == END_OBJECT || token == END_ARRAY) {
+                --depth;
+            } else if (token == ERROR || token == END) {
+                return false;
+            }
+        }
+        return true;
+    }
+    return first == STRING || first == NUMBER || first == BOOL || first == NULL_VALUE;
+}
+
+// ---------------- JsonWriter ----------------
+
+JsonWriter::~JsonWriter() {
+    if (file) {
+        // 没有 commit，丢弃临时文件
+        std::fclose(file);
+        std::error_code error;
+        std::filesystem::remove(tempPath, error);
+    }
+}
+
+bool JsonWriter::open(const std::string& targetPath) {
+    path = targetPath;
+    tempPath = targetPath + ".tmp";
+    buffer.clear();
+    hasElements.clear();
+    afterKey = false;
+    failed = false;
+    file = std::fopen(tempPath.c_str(), "wb");
+    return file != nullptr;
+}
+
+void JsonWriter::newline() {
+    buffer += '\n';
+    buffer.append(hasElements.getSize() * 4, ' ');
+}
+
+// 写值之前补上逗号和换行缩进；紧跟在键之后的值不需要
+void JsonWriter::beginValue() {
+    if (afterKey) {
+        afterKey = false;
+        return;
+    }
+    size_t depth = hasElements.getSize();
+    if (depth > 0) {
+        if (hasElements[depth - 1]) buffer += ',';
+        hasElements[depth - 1] = true;
+        newline();
+    }
+}
+
+void JsonWriter::writeQuoted(std::string_view value) {
+    static const char HEX[] = "0123456789abcdef";
+    buffer += '"';
+    for (char c : value) {
+        switch (c) {
+        case '"': buffer += "\\\""; break;
+        case '\\': buffer += "\\\\"; break;
+        case '\b': buffer += "\\b"; break;
+        case '\f': buffer += "\\f"; break;
+        case '\n': buffer += "\\n"; break;
+        case '\r': buffer += "\\r"; break;
+        case '\t': buffer += "\\t"; break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                buffer += "\\u00";
+                buffer += HEX[(c >> 4) & 0xF];
+                buffer += HEX[c & 0xF];
+            } else {
+                buffer += c;
+            }
+            break;
+        }
+    }
+    buffer += '"';
+}
+
+void JsonWriter::flushIfFull() {
+    if (buffer.size() < FLUSH_SIZE || !file) return;
+    if (std::fwrite(buffer.data(), 1, buffer.size(), file) != buffer.size()) failed = true;
+    buffer.clear();
+}
+
+void JsonWriter::beginObject() {
+    beginValue();
+    buffer += '{';
+    hasElements.push_back(false);
+}
+
+void JsonWriter::endObject() {
+    size_t depth = hasElements.getSize();
+    bool hadElements = hasElements[depth - 1];
+    hasElements.removeAt(depth - 1);
+    if (hadElements) newline();
+    buffer += '}';
+    flushIfFull();
+}
+
+void JsonWriter::beginArray() {
+    beginValue();
+    buffer += '[';
+    hasElements.push_back(false);
+}
+
+void JsonWriter::endArray() {
+    size_t depth = hasElements.getSize();
+    bool hadElements = hasElements[depth - 1];
+    hasElements.removeAt(depth - 1);
+    if (hadElements) newline();
+    buffer += ']';
+    flushIfFull();
+}
+
+void JsonWriter::key(std::string_view name) {
+    beginValue();
+    writeQuoted(name);
+    buffer += ": ";
+    afterKey = true;
+}
+
+void JsonWriter::value(std::string_view text) {
+    beginValue();
+    writeQuoted(text);
+    flushIfFull();
+}
+
+void JsonWriter::value(long long number) {
+    beginValue();
+    buffer += std::to_string(number);
+}
+
+void JsonWriter::value(bool flag) {
+    beginValue();
+    buffer += flag ? "true" : "false";
+}
+
+bool JsonWriter::commit() {
+    if (!file) return false;
+    buffer += '\n';
+    bool ok = !failed && std::fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size();
+    buffer.clear();
+    ok = std::fflush(file) == 0 && ok;
+#ifdef _WIN32
+    ok = _commit(_fileno(file)) == 0 && ok;
+#else
+    ok = fsync(fileno(file)) == 0 && ok;
+#endif
+    ok = std::fclose(file) == 0 && ok;
+    file = nullptr;
+    std::error_code error;
+    if (ok) {
+        std::filesystem::rename(tempPath, path, error);
+    }
+    if (!ok || error) {
+        std::filesystem::remove(tempPath, error);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,112 @@
+#include "../include/MappedCatalog.h"
+#include "../include/Checksum.h"
+
+MappedCatalog::MappedCatalog() : editedIndex(EditedRowOf{this}) {}
+
+bool MappedCatalog::open(const std::string& path) {
+    close();
+    if (!file.open(path)) return false;
+    // 只检查文件头，不读遍文件
+    if (!view.open(file.getData(), file.getSize(), BinarySnapshot::BOOKS, false)) {
+        close();
+        return false;
+    }
+    isbns = view.nextColumn(8);
+    titles = view.nextColumn(8);
+    authors = view.nextColumn(8);
+    publishers = view.nextColumn(8);
+    years = view.nextColumn(4);
+    statuses = view.nextColumn(4);
+    if (!isbns || !titles || !authors || !publishers || !years || !statuses || !view.finished()) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void MappedCatalog::close() {
+    file.close();
+    view = BinarySnapshot::SnapshotView();
+    isbns = titles = authors = publishers = years = statuses = nullptr;
+    editedBooks.clear();
+    editedRows.clear();
+    editedIndex.clear();
+}
+
+bool MappedCatalog::verifyChecksum() const {
+    if (!file.isOpen()) return false;
+    size_t crcOffset = file.getSize() - 4;
+    const unsigned char* footer = file.getData() + crcOffset;
+    uint32_t stored = static_cast<uint32_t>(footer[0]) | (static_cast<uint32_t>(footer[1]) << 8)
+                      | (static_cast<uint32_t>(footer[2]) << 16) | (static_cast<uint32_t>(footer[3]) << 24);
+    return Checksum::crc32(file.getData(), crcOffset) == stored;
+}
+
+const Book* MappedCatalog::editedBook(size_t row) const {
+    const uint32_t* slot = editedIndex.find(static_cast<uint32_t>(row));
+    return slot ? &editedBooks[*slot] : nullptr;
+}
+
+// 越出字符串表的引用说明文件已损坏，按空字符串处理
+std::string_view MappedCatalog::field(const unsigned char* column, size_t row) const {
+    std::string_view value;
+    view.stringAt(column, row, value);
+    return value;
+}
+
+std::string_view MappedCatalog::getIsbn(size_t row) const {
+    const Book* edited = editedBook(row);
+    return edited ? std::string_view(edited->getIsbn()) : field(isbns, row);
+}
+
+std::string_view MappedCatalog::getTitle(size_t row) const {
+    const Book* edited = editedBook(row);
+    return edited ? std::string_view(edited->getTitle()) : field(titles, row);
+}
+
+std::string_view MappedCatalog::getAuthor(size_t row) const {
+    const Book* edited = editedBook(row);
+    return edited ? std::string_view(edited->getAuthor()) : field(authors, row);
+}
+
+std::string_view MappedCatalog::getPublisher(size_t row) const {
+    const Book* edited = editedBook(row);
+    return edited ? std::string_view(edited->getPublisher()) : field(publishers, row);
+}
+
+int MappedCatalog::getPublishYear(size_t row) const {
+    const Book* edited = editedBook(row);
+    return edited ? edited->getPublishYear() : BinarySnapshot::SnapshotView::int32At(years, row);
+}
+
+int MappedCatalog::getStatus(size_t row) const {
+    const Book* edited = editedBook(row);
+    return edited ? edited->getStatus() : BinarySnapshot::SnapshotView::int32At(statuses, row);
+}
+
+bool MappedCatalog::isMapped(std::string_view text) const {
+    const char* begin = reinterpret_cast<const char*>(file.getData());
+    return file.isOpen() && text.data() >= begin && text.data() + text.size() <= begin + file.getSize();
+}
+
+Book MappedCatalog::getBook(size_t row) const {
+    const Book* edited = editedBook(row);
+    if (edited) return *edited;
+    Book book(std::string(field(isbns, row)), std::string(field(titles, row)), std::string(field(authors, row)),
+              std::string(field(publishers, row)), BinarySnapshot::SnapshotView::int32At(years, row));
+    book.setStatus(BinarySnapshot::SnapshotView::int32At(statuses, row));
+    return book;
+}
+
+Book& MappedCatalog::editBook(size_t row) {
+    const uint32_t* slot = editedIndex.find(static_cast<uint32_t>(row));
+    if (slot) return editedBooks[*slot];
+    editedBooks.push_back(getBook(row));
+    editedRows.push_back(static_cast<uint32_t>(row));
+    editedIndex.insert(static_cast<uint32_t>(row), static_cast<uint32_t>(editedBooks.getSize() - 1));
+    return editedBooks[editedBooks.getSize() - 1];
+}
+
+bool MappedCatalog::saveToBinaryFile(const std::string& path) const {
+    return isOpen() && BinarySnapshot::saveBooks(path, *this);
+}
@@ -6,6 +6,7 @@ bool PermissionManager::login(const std::string& username, const std::string& pa
     if (!userManager){
         return false;
     }
+    auto lock = userManager->readLock();
     const User* user = userManager->findUser(username);
     if (user && user->password.compare(password) == 0) {
         currentUser = user;
@@ -27,7 +28,7 @@ void PermissionManager::logout() {
 //注册
 bool PermissionManager::registerUser(const std::string& username, const std::string& password, Role role) {
     if (!userManager) return false;
-    if (userManager->findUser(username)) {
+    if (userManager->hasUser(username)) {
         std::cout << "用户名已存在！" << std::endl;
         return false;
     }
@@ -0,0 +1,116 @@
+#include "../include/PrefixIndex.h"
+#include <algorithm>
+#include "../include/Mysort.h"
+
+static unsigned char foldCase(char c) {
+    unsigned char u = static_cast<unsigned char>(c);
+    return (u >= 'A' && u <= 'Z') ? static_cast<unsigned char>(u - 'A' + 'a') : u;
+}
+
+// 忽略 ASCII 大小写比较，返回负数、0 或正数
+static int compareFolded(std::string_view a, std::string_view b) {
+    size_t n = std::min(a.size(), b.size());
+    for (size_t i = 0; i < n; ++i) {
+        unsigned char x = foldCase(a[i]);
+        unsigned char y = foldCase(b[i]);
+        if (x != y) return x < y ? -1 : 1;
+    }
+    if (a.size() == b.size()) return 0;
+    return a.size() < b.size() ? -1 : 1;
+}
+
+// 索引中的顺序：先忽略大小写，再按原文
+static bool textLess(std::string_view a, std::string_view b) {
+    int c = compareFolded(a, b);
+    return c != 0 ? c < 0 : a < b;
+}
+
+size_t PrefixIndex::lowerBound(std::string_view text) const {
+    size_t left = 0;
+    size_t right = entries.getSize();
+    while (left < right) {
+        size_t mid = left + (right - left) / 2;
+        if (textLess(entries[mid].text, text)) {
+            left = mid + 1;
+        } else {
+            right = mid;
+        }
+    }
+    return left;
+}
+
+void PrefixIndex::add(std::string_view text) {
+    if (text.empty()) return;
+    size_t pos = lowerBound(text);
+    size_t size = entries.getSize();
+    if (pos < size && entries[pos].text == text) {
+        ++entries[pos].count;
+        return;
+    }
+    entries.push_back(Entry{std::string(text), 1});
+    for (size_t i = size; i > pos; --i) {
+        std::swap(entries[i], entries[i - 1]);
+    }
+}
+
+void PrefixIndex::erase(std::string_view text) {
+    if (text.empty()) return;
+    size_t pos = lowerBound(text);
+    if (pos < entries.getSize() && entries[pos].text == text) {
+        if (--entries[pos].count == 0) {
+            entries.removeAt(pos);
+        }
+    }
+}
+
+void PrefixIndex::addAll(MyVector<std::string_view>& texts) {
+    if (texts.getSize() == 0) return;
+    if (texts.getSize() == 1) {
+        add(texts[0]);
+        return;
+    }
+    MyAlgorithm::sort(&texts[0], texts.getSize(), textLess);
+    MyVector<Entry> merged(entries.getSize() + texts.getSize());
+    size_t i = 0;
+    size_t j = 0;
+    while (i < entries.getSize() || j < texts.getSize()) {
+        if (j < texts.getSize() && texts[j].empty()) {
+            ++j;
+            continue;
+        }
+        bool takeOld = j >= texts.getSize() || (i < entries.getSize() && !textLess(texts[j], entries[i].text));
+        if (takeOld) {
+            merged.push_back(std::move(entries[i++]));
+        } else {
+            merged.push_back(Entry{std::string(texts[j++]), 1});
+        }
+        // 批中与刚放入的取值相同的项并入计数
+        Entry& last = merged[merged.getSize() - 1];
+        while (j < texts.getSize() && texts[j] == last.text) {
+            ++last.count;
+            ++j;
+        }
+    }
+    entries = std::move(merged);
+}
+
+MyVector<std::string> PrefixIndex::complete(std::string_view prefix, size_t limit) const {
+    MyVector<std::string> result;
+    // 按忽略大小写的顺序，以 prefix 开头的取值从第一个不小于 prefix 的位置起连续排列
+    size_t left = 0;
+    size_t right = entries.getSize();
+    while (left < right) {
+        size_t mid = left + (right - left) / 2;
+        if (compareFolded(entries[mid].text, prefix) < 0) {
+            left = mid + 1;
+        } else {
+            right = mid;
+        }
+    }
+    for (size_t i = left; i < entries.getSize() && result.getSize() < limit; ++i) {
+        std::string_view text = entries[i].text;
+        if (text.size() < prefix.size() || compareFolded(text.substr(0, prefix.size()), prefix) != 0) break;
+        result.push_back(entries[i].text);
+    }
+    return result;
+}
@@ -0,0 +1,47 @@
+#include "../include/SnapshotConverter.h"
+#include "../include/BookManager.h"
+#include "../include/User.h"
+#include "../include/BorrowManager.h"
+#include <QFile>
+#include <QDebug>
+
+bool SnapshotConverter::jsonToBinary(BinarySnapshot::Kind kind, const QString& jsonFile, const QString& binaryFile) {
+    std::string binaryPath = QFile::encodeName(binaryFile).toStdString();
+    switch (kind) {
+    case BinarySnapshot::BOOKS: {
+        BookManager books;
+        return books.loadFromFile(jsonFile) && books.saveToBinaryFile(binaryPath);
+    }
+    case BinarySnapshot::USERS: {
+        UserManager users;
+        return users.loadFromFile(jsonFile.toStdString()) && users.saveToBinaryFile(binaryPath);
+    }
+    case BinarySnapshot::BORROW_RECORDS: {
+        // 只转换记录，不涉及图书和用户
+        BorrowManager borrows(nullptr, nullptr);
+        return borrows.loadFromFile(jsonFile) && borrows.saveToBinaryFile(binaryPath);
+    }
+    }
+    qDebug() << "未知的快照类型:" << static_cast<int>(kind);
+    return false;
+}
+
+bool SnapshotConverter::binaryToJson(BinarySnapshot::Kind kind, const QString& binaryFile, const QString& jsonFile) {
+    std::string binaryPath = QFile::encodeName(binaryFile).toStdString();
+    switch (kind) {
+    case BinarySnapshot::BOOKS: {
+        BookManager books;
+        return books.loadFromBinaryFile(binaryPath) && books.saveToFile(jsonFile);
+    }
+    case BinarySnapshot::USERS: {
+        UserManager users;
+        return users.loadFromBinaryFile(binaryPath) && users.saveToFile(jsonFile.toStdString());
+    }
+    case BinarySnapshot::BORROW_RECORDS: {
+        BorrowManager borrows(nullptr, nullptr);
+        return borrows.loadFromBinaryFile(binaryPath) && borrows.saveToFile(jsonFile);
+    }
+    }
+    qDebug() << "未知的快照类型:" << static_cast<int>(kind);
+    return false;
+}
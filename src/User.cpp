@@ -1,33 +1,59 @@
 #include "../include/User.h"
 #include "../include/Mysort.h"
+#include "../include/BinarySnapshot.h"
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <mutex>
 #include <QJsonDocument>
 #include <QJsonObject>
 
+UserManager::UserManager() : usernameIndex(UsernameOf{this}) {}
+
+// 按当前用户列表重建用户名索引
+void UserManager::rebuildIndex() {
+    usernameIndex.clear();
+    usernameIndex.reserve(users.getSize());
+    for (size_t i = 0; i < users.getSize(); ++i) {
+        usernameIndex.insert(users[i].username, static_cast<uint32_t>(i));
+    }
+}
+
+// 由用户名取下标，未找到返回 -1
+int UserManager::indexOfUser(const std::string& username) const {
+    const uint32_t* idx = usernameIndex.find(username);
+    return idx ? static_cast<int>(*idx) : -1;
+}
+
 // 添加用户
 void UserManager::addUser(const User &user){
-    auto getUsername = [](const User& user) -> std::string { return user.username; };
-    auto comparator = [](const std::string& a, const std::string& b) -> bool { return a < b; };
-    // 使用二分查找检查用户是否已存在
-    int index = users.binarySearch<std::string>(user.username, getUsername, comparator);
-    if (index >= 0) {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    // 使用哈希索引检查用户是否已存在
+    if (usernameIndex.contains(user.username)) {
         std::cout << "用户已存在，无法添加。" << std::endl;
         return;
     }
 
     users.add(user);
+    usernameIndex.insert(user.username, static_cast<uint32_t>(users.getSize() - 1));
 }
 
 // 删除用户
 bool UserManager::removeUser(const std::string &username){
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    return removeUnlocked(username);
+}
+
+bool UserManager::removeUnlocked(const std::string &username){
     //哈希查找用户
-    const User* userPtr = findUser(username);
-    if (userPtr) {
+    int found = indexOfUser(username);
+    if (found >= 0) {
         // 找到用户，获取其索引并删除
-        int index = static_cast<int>(userPtr - &users[0]);
+        uint32_t index = static_cast<uint32_t>(found);
+        usernameIndex.erase(username);
         users.removeAt(index);
+        // 后续用户前移一位，修正索引中的下标
+        usernameIndex.updateValues([index](uint32_t& i) { if (i > index) --i; });
         return true;
     }
     return false;
@@ -35,13 +61,14 @@ bool UserManager::removeUser(const std::string &username){
 
 // 更新用户信息
 bool UserManager::updateUser(const std::string &oldUsername, const User &newUser) {
+    std::unique_lock<std::shared_mutex> lock(mutex);
     //哈希查找用户
-    const User* userPtr = findUser(oldUsername);
-    if (userPtr) {
-        int idx = static_cast<int>(userPtr - &users[0]);
+    int found = indexOfUser(oldUsername);
+    if (found >= 0) {
+        uint32_t idx = static_cast<uint32_t>(found);
+        usernameIndex.erase(oldUsername);
         users[idx] = newUser; // 更新用户信息
-        // 重新计算哈希表
-        users.rebuildHashTable();
+        usernameIndex.insert(newUser.username, idx);
         return true;
     }
     return false;
@@ -49,6 +76,7 @@ bool UserManager::updateUser(const std::string &oldUsername, const User &newUser
 
 // 打印所有用户信息
 void UserManager::printAllUsers() const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
     for (size_t i = 0; i < users.getSize(); ++i) {
         const User& user = users[i];
         std::cout << "用户名: " << user.username
@@ -56,17 +84,33 @@ void UserManager::printAllUsers() const {
     }
 }
 
-// 哈希查找用户
+// 哈希查找用户，调用方须持有 readLock
 const User* UserManager::findUser(const std::string &username) const {
-    int idx = users.hashFindByUsername(username);
+    int idx = indexOfUser(username);
     if (idx >= 0) {
         return &users[idx];
     }
     return nullptr;
 }
 
+bool UserManager::hasUser(const std::string &username) const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return indexOfUser(username) >= 0;
+}
+
+bool UserManager::getUser(const std::string &username, User &user) const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    int idx = indexOfUser(username);
+    if (idx < 0) {
+        return false;
+    }
+    user = users[idx];
+    return true;
+}
+
 // 按用户名模糊查找用户
 MyVector<User> UserManager::fuzzyFindUsers(const std::string& keyword)const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
     MyVector<User> result;
     for (size_t i = 0; i < users.getSize(); ++i) {
         const User& user = users[i];
@@ -80,6 +124,7 @@ MyVector<User> UserManager::fuzzyFindUsers(const std::string& keyword)const {
 // 按用户名模糊查找并排序用户
 MyVector<User> UserManager::findAndSortUsers(const std::string& keyword, bool ascending) const {
     MyVector<User> result = fuzzyFindUsers(keyword);
+    // 结果已是副本，排序不需要持锁
     // 排序，按用户名
     auto comp = [ascending](const User& a, const User& b) {
         return ascending ? (a.username < b.username) : (a.username > b.username);
@@ -92,9 +137,10 @@ MyVector<User> UserManager::findAndSortUsers(const std::string& keyword, bool as
 
 // 管理员批量删除用户
 bool UserManager::adminRemoveUsers(const MyVector<std::string>& usernames){
+    std::unique_lock<std::shared_mutex> lock(mutex);
     bool allRemoved = true;
     for (size_t i = 0; i < usernames.getSize(); ++i) {
-        bool removed = removeUser(usernames[i]);
+        bool removed = removeUnlocked(usernames[i]);
         if (!removed) {
             allRemoved = false;
         }
@@ -106,6 +152,7 @@ bool UserManager::adminRemoveUsers(const MyVector<std::string>& usernames){
 bool UserManager::saveToFile(const std::string& filename) const {
     std::ofstream ofs(filename, std::ios::out | std::ios::trunc);
     if (!ofs.is_open()) return false;
+    std::shared_lock<std::shared_mutex> lock(mutex);
     for (size_t i = 0; i < users.getSize(); ++i) {
         const User& user = users[i];
         QJsonObject obj;
@@ -123,7 +170,8 @@ bool UserManager::saveToFile(const std::string& filename) const {
 bool UserManager::loadFromFile(const std::string& filename) {
     std::ifstream ifs(filename);
     if (!ifs.is_open()) return false;
-    users.clear();
+    // 读文件时不持锁，读完后一次替换
+    MyVector<User> loaded;
     std::string line;
     while (std::getline(ifs, line)) {
         if (line.empty()) continue;
@@ -134,8 +182,25 @@ bool UserManager::loadFromFile(const std::string& filename) {
         std::string username = obj.value("username").toString().toStdString();
         std::string password = obj.value("password").toString().toStdString();
         Role role = static_cast<Role>(obj.value("role").toInt());
-        users.add(User(username, password, role));
+        loaded.add(User(username, password, role));
     }
     ifs.close();
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    users = std::move(loaded);
+    rebuildIndex();
+    return true;
+}
+
+bool UserManager::saveToBinaryFile(const std::string& filename) const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return BinarySnapshot::saveUsers(filename, users);
+}
+
+bool UserManager::loadFromBinaryFile(const std::string& filename) {
+    MyVector<User> loaded;
+    if (!BinarySnapshot::loadUsers(filename, loaded)) return false;
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    users = std::move(loaded);
+    rebuildIndex();
     return true;
 }
\ No newline at end of file
@@ -0,0 +1,167 @@
+#include "../include/YearIndex.h"
+#include "../include/Mysort.h"
+
+static bool inBuckets(int year) {
+    return year >= YearIndex::MIN_YEAR && year <= YearIndex::MAX_YEAR;
+}
+
+// 有序表中第一个不小于 id 的位置
+static size_t lowerBoundId(const MyVector<uint32_t>& list, uint32_t id) {
+    size_t left = 0;
+    size_t right = list.getSize();
+    while (left < right) {
+        size_t mid = left + (right - left) / 2;
+        if (list[mid] < id) {
+            left = mid + 1;
+        } else {
+            right = mid;
+        }
+    }
+    return left;
+}
+
+void YearIndex::clear() {
+    for (size_t b = 0; b < BUCKET_COUNT; ++b) {
+        buckets[b].clear();
+    }
+    others.clear();
+}
+
+size_t YearIndex::lowerBound(int year, uint32_t id) const {
+    size_t left = 0;
+    size_t right = others.getSize();
+    while (left < right) {
+        size_t mid = left + (right - left) / 2;
+        const Entry& entry = others[mid];
+        if (entry.year < year || (entry.year == year && entry.id < id)) {
+            left = mid + 1;
+        } else {
+            right = mid;
+        }
+    }
+    return left;
+}
+
+void YearIndex::add(int year, uint32_t id) {
+    if (inBuckets(year)) {
+        MyVector<uint32_t>& bucket = buckets[year - MIN_YEAR];
+        size_t size = bucket.getSize();
+        // 建索引时下标递增，通常直接追加
+        if (size == 0 || bucket[size - 1] < id) {
+            bucket.push_back(id);
+            return;
+        }
+        size_t pos = lowerBoundId(bucket, id);
+        if (bucket[pos] == id) return;
+        bucket.push_back(bucket[size - 1]);
+        for (size_t i = size - 1; i > pos; --i) {
+            bucket[i] = bucket[i - 1];
+        }
+        bucket[pos] = id;
+        return;
+    }
+    size_t pos = lowerBound(year, id);
+    size_t size = others.getSize();
+    if (pos < size && others[pos].year == year && others[pos].id == id) return;
+    others.push_back(Entry{year, id});
+    for (size_t i = size; i > pos; --i) {
+        others[i] = others[i - 1];
+    }
+    others[pos] = Entry{year, id};
+}
+
+void YearIndex::erase(int year, uint32_t id) {
+    if (inBuckets(year)) {
+        MyVector<uint32_t>& bucket = buckets[year - MIN_YEAR];
+        size_t pos = lowerBoundId(bucket, id);
+        if (pos < bucket.getSize() && bucket[pos] == id) {
+            bucket.removeAt(pos);
+        }
+        return;
+    }
+    size_t pos = lowerBound(year, id);
+    if (pos < others.getSize() && others[pos].year == year && others[pos].id == id) {
+        others.removeAt(pos);
+    }
+}
+
+void YearIndex::shiftDown(const MyVector<uint32_t>& removed) {
+    if (removed.getSize() == 0) return;
+    for (size_t b = 0; b < BUCKET_COUNT; ++b) {
+        MyVector<uint32_t>& bucket = buckets[b];
+        size_t below = 0;
+        for (size_t i = lowerBoundId(bucket, removed[0]); i < bucket.getSize(); ++i) {
+            while (below < removed.getSize() && removed[below] < bucket[i]) {
+                ++below;
+            }
+            bucket[i] -= static_cast<uint32_t>(below);
+        }
+    }
+    // others 按年份排序，下标不连续，逐个二分求减量；减量随下标单调，同年内顺序不变
+    for (size_t i = 0; i < others.getSize(); ++i) {
+        others[i].id -= static_cast<uint32_t>(lowerBoundId(removed, others[i].id));
+    }
+}
+
+MyVector<uint32_t> YearIndex::range(int from, int to) const {
+    MyVector<uint32_t> result;
+    if (from > to) return result;
+    int low = from > MIN_YEAR ? from : MIN_YEAR;
+    int high = to < MAX_YEAR ? to : MAX_YEAR;
+    size_t total = 0;
+    for (int year = low; year <= high; ++year) {
+        total += buckets[year - MIN_YEAR].getSize();
+    }
+    size_t first = lowerBound(from, 0);
+    size_t last = first;
+    while (last < others.getSize() && others[last].year <= to) {
+        ++last;
+    }
+    result.reserve(total + (last - first));
+    // others 中早于 MIN_YEAR 的排在各桶之前，晚于 MAX_YEAR 的排在之后
+    size_t i = first;
+    for (; i < last && others[i].year < MIN_YEAR; ++i) {
+        result.push_back(others[i].id);
+    }
+    for (int year = low; year <= high; ++year) {
+        const MyVector<uint32_t>& bucket = buckets[year - MIN_YEAR];
+        for (size_t k = 0; k < bucket.getSize(); ++k) {
+            result.push_back(bucket[k]);
+        }
+    }
+    for (; i < last; ++i) {
+        result.push_back(others[i].id);
+    }
+    return result;
+}
+
+MyVector<uint32_t> YearIndex::ids(int from, int to) const {
+    MyVector<uint32_t> result = range(from, to);
+    // 单个年份的桶本身按下标有序
+    if (from != to && result.getSize() > 1) {
+        MyAlgorithm::sort(&result[0], result.getSize());
+    }
+    return result;
+}
+
+bool YearIndex::bucketLists(int from, int to, MyVector<const MyVector<uint32_t>*>& lists) const {
+    for (int year = from > MIN_YEAR ? from : MIN_YEAR; year <= (to < MAX_YEAR ? to : MAX_YEAR); ++year) {
+        if (buckets[year - MIN_YEAR].getSize() > 0) {
+            lists.push_back(&buckets[year - MIN_YEAR]);
+        }
+    }
+    size_t first = lowerBound(from, 0);
+    return !(first < others.getSize() && others[first].year <= to);
+}
+
+size_t YearIndex::count(int from, int to) const {
+    if (from > to) return 0;
+    size_t total = 0;
+    for (int year = from > MIN_YEAR ? from : MIN_YEAR; year <= (to < MAX_YEAR ? to : MAX_YEAR); ++year) {
+        total += buckets[year - MIN_YEAR].getSize();
+    }
+    for (size_t i = lowerBound(from, 0); i < others.getSize() && others[i].year <= to; ++i) {
+        ++total;
+    }
+    return total;
+}
@@ -0,0 +1,154 @@
+#include "TestSupport.h"
+#include "../include/BinarySnapshot.h"
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+/**
+ * @brief 二进制快照的往返与损坏检测测试
+ * 三种快照写出后读回须逐字段相同；任意一个字节被改动、文件被截断或多出内容、
+ * 魔数或类型不符时，读取都应失败且不修改输出参数。
+ * @author 陈子涵
+ */
+
+namespace {
+    std::string readBytes(const std::string& path) {
+        std::ifstream file(path, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    void writeBytes(const std::string& path, const std::string& bytes) {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    }
+
+    MyVector<Book> sampleBooks() {
+        MyVector<Book> books;
+        books.emplace_back("978-7-111", "数据结构", "严蔚敏", "清华大学出版社", 1997);
+        books.emplace_back("978-7-222", "算法导论", "Cormen", "机械工业出版社", 2013);
+        // 与第一本共享作者和出版社，写入时去重
+        books.emplace_back("978-7-333", "数据结构（C 语言版）", "严蔚敏", "清华大学出版社", 2011);
+        books[1].setStatus(1);
+        return books;
+    }
+
+    void testRoundTrip(const TestSupport::TempDir& dir) {
+        MyVector<Book> books = sampleBooks();
+        std::string bookPath = dir.path("books.bin");
+        CHECK(BinarySnapshot::saveBooks(bookPath, books));
+        MyVector<Book> loadedBooks;
+        CHECK(BinarySnapshot::loadBooks(bookPath, loadedBooks));
+        CHECK(loadedBooks.getSize() == books.getSize());
+        for (size_t i = 0; i < books.getSize() && i < loadedBooks.getSize(); ++i) {
+            CHECK(loadedBooks[i].getIsbn() == books[i].getIsbn());
+            CHECK(loadedBooks[i].getTitle() == books[i].getTitle());
+            CHECK(loadedBooks[i].getAuthor() == books[i].getAuthor());
+            CHECK(loadedBooks[i].getPublisher() == books[i].getPublisher());
+            CHECK(loadedBooks[i].getPublishYear() == books[i].getPublishYear());
+            CHECK(loadedBooks[i].getStatus() == books[i].getStatus());
+        }
+        CHECK(!std::filesystem::exists(bookPath + ".tmp"));
+
+        MyVector<User> users;
+        users.emplace_back("admin", "secret", ADMIN);
+        users.emplace_back("reader", "", USER);
+        std::string userPath = dir.path("users.bin");
+        CHECK(BinarySnapshot::saveUsers(userPath, users));
+        MyVector<User> loadedUsers;
+        CHECK(BinarySnapshot::loadUsers(userPath, loadedUsers));
+        CHECK(loadedUsers.getSize() == 2);
+        if (loadedUsers.getSize() == 2) {
+            CHECK(loadedUsers[0].username == "admin" && loadedUsers[0].password == "secret" && loadedUsers[0].role == ADMIN);
+            CHECK(loadedUsers[1].username == "reader" && loadedUsers[1].password.empty() && loadedUsers[1].role == USER);
+        }
+
+        MyVector<BorrowRecord> records;
+        records.emplace_back(7, "978-7-111", "reader", 1000, 2000);
+        records.emplace_back(9, "978-7-222", "reader", 1500, 2500);
+        records[0].setReturnDate(1800);
+        records[0].setIsReturned(true);
+        std::string recordPath = dir.path("borrow_records.bin");
+        CHECK(BinarySnapshot::saveBorrowRecords(recordPath, records));
+        MyVector<BorrowRecord> loadedRecords;
+        CHECK(BinarySnapshot::loadBorrowRecords(recordPath, loadedRecords));
+        CHECK(loadedRecords.getSize() == 2);
+        if (loadedRecords.getSize() == 2) {
+            CHECK(loadedRecords[0].getId() == 7 && loadedRecords[0].getIsReturned());
+            CHECK(loadedRecords[0].getReturnDate() == 1800 && loadedRecords[0].getDueDate() == 2000);
+            CHECK(loadedRecords[1].getId() == 9 && !loadedRecords[1].getIsReturned());
+            CHECK(loadedRecords[1].getBorrowDate() == 1500 && loadedRecords[1].getUsername() == "reader");
+        }
+
+        // 空表同样可以往返
+        std::string emptyPath = dir.path("empty.bin");
+        CHECK(BinarySnapshot::saveBooks(emptyPath, MyVector<Book>()));
+        MyVector<Book> emptyBooks;
+        CHECK(BinarySnapshot::loadBooks(emptyPath, emptyBooks) && emptyBooks.getSize() == 0);
+    }
+
+    // 改动任意一个字节都应被校验发现
+    void testEveryByteIsChecked(const TestSupport::TempDir& dir) {
+        std::string path = dir.path("books.bin");
+        CHECK(BinarySnapshot::saveBooks(path, sampleBooks()));
+        const std::string original = readBytes(path);
+        CHECK(!original.empty());
+        std::string corruptPath = dir.path("corrupt.bin");
+        size_t accepted = 0;
+        for (size_t i = 0; i < original.size(); ++i) {
+            std::string bytes = original;
+            bytes[i] = static_cast<char>(bytes[i] ^ 0x01);
+            writeBytes(corruptPath, bytes);
+            MyVector<Book> loaded;
+            loaded.emplace_back("keep", "keep", "keep", "keep", 2000);
+            if (BinarySnapshot::loadBooks(corruptPath, loaded)) {
+                ++accepted;
+            } else {
+                // 失败时保留调用方原有内容
+                CHECK(loaded.getSize() == 1 && loaded[0].getIsbn() == "keep");
+            }
+        }
+        CHECK(accepted == 0);
+    }
+
+    void testTruncatedAndMismatchedFiles(const TestSupport::TempDir& dir) {
+        std::string path = dir.path("books.bin");
+        CHECK(BinarySnapshot::saveBooks(path, sampleBooks()));
+        const std::string original = readBytes(path);
+        std::string corruptPath = dir.path("corrupt.bin");
+        MyVector<Book> loaded;
+
+        writeBytes(corruptPath, original.substr(0, original.size() - 1));
+        CHECK(!BinarySnapshot::loadBooks(corruptPath, loaded));
+        writeBytes(corruptPath, original.substr(0, 8));
+        CHECK(!BinarySnapshot::loadBooks(corruptPath, loaded));
+        writeBytes(corruptPath, "");
+        CHECK(!BinarySnapshot::loadBooks(corruptPath, loaded));
+        writeBytes(corruptPath, original + '\0');
+        CHECK(!BinarySnapshot::loadBooks(corruptPath, loaded));
+        CHECK(!BinarySnapshot::loadBooks(dir.path("missing.bin"), loaded));
+
+        // 图书快照不能当作用户或借阅记录读取
+        MyVector<User> users;
+        CHECK(!BinarySnapshot::loadUsers(path, users));
+        MyVector<BorrowRecord> records;
+        CHECK(!BinarySnapshot::loadBorrowRecords(path, records));
+    }
+
+    // 目标目录不存在时写入失败，不留下临时文件
+    void testWriteFailure(const TestSupport::TempDir& dir) {
+        std::string path = dir.path("no_such_dir/books.bin");
+        CHECK(!BinarySnapshot::saveBooks(path, sampleBooks()));
+        CHECK(!std::filesystem::exists(path));
+        CHECK(!std::filesystem::exists(path + ".tmp"));
+    }
+}
+
+int main() {
+    TestSupport::TempDir dir("bms_binary_snapshot_test");
+    testRoundTrip(dir);
+    testEveryByteIsChecked(dir);
+    testTruncatedAndMismatchedFiles(dir);
+    testWriteFailure(dir);
+    return TestSupport::result();
+}
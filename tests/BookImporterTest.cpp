@@ -0,0 +1,145 @@
+#include "TestSupport.h"
+#include "../include/BookImporter.h"
+#include <atomic>
+#include <fstream>
+#include <string>
+
+/**
+ * @brief BookImporter 的逐行解析与分块并行解析测试
+ * 逐行解析覆盖两种引号、转义、字段顺序和各种格式错误；
+ * 整个文件按不同线程数切块解析，结果须与逐行解析一致且保持文件顺序，
+ * 块边界无论落在哪里都不能丢行、重复或把一行拆开。
+ * @author 陈子涵
+ */
+
+namespace {
+    bool parse(const std::string& line, Book& book) {
+        return BookImporter::parseLine(line, book);
+    }
+
+    void testParseLine() {
+        Book book;
+        CHECK(parse("{'书名': '活着', '作者': '余华', '出版社': '作家出版社', 'ISBN': '978-7-5063', '出版年限': 1993}", book));
+        CHECK(book.getTitle() == "活着" && book.getAuthor() == "余华" && book.getPublisher() == "作家出版社");
+        CHECK(book.getIsbn() == "978-7-5063" && book.getPublishYear() == 1993);
+
+        // Python repr 在值含单引号时改用双引号；反斜杠转义按 Python 规则还原
+        CHECK(parse("{'书名': \"It's\", '作者': 'O\\'Brien', '出版社': 'a\\\\b', 'ISBN': 'x\\ty', '出版年限': 2001}", book));
+        CHECK(book.getTitle() == "It's");
+        CHECK(book.getAuthor() == "O'Brien");
+        CHECK(book.getPublisher() == "a\\b");
+        CHECK(book.getIsbn() == "x\ty");
+        CHECK(parse("{'书名': 'line\\nbreak', '作者': 'q\\\"d', '出版社': 'p', 'ISBN': 'i', '出版年限': 1}", book));
+        CHECK(book.getTitle() == "line\nbreak" && book.getAuthor() == "q\"d");
+
+        // 字段顺序任意，多余的整数字段和空白被忽略，负年份可以解析
+        CHECK(parse("  { 'ISBN':'9' ,'页数': 320, '出版年限' : -200, '出版社':'p','作者':'a','书名':'t' }  ", book));
+        CHECK(book.getIsbn() == "9" && book.getPublishYear() == -200 && book.getTitle() == "t");
+
+        const char* invalid[] = {
+            "",
+            "{}",
+            "{'书名': '活着', '作者': '余华', '出版社': '作家出版社', 'ISBN': '978'}",                     // 缺年份
+            "{'书名': '', '作者': '余华', '出版社': '作家出版社', 'ISBN': '978', '出版年限': 1993}",        // 空书名
+            "{'书名': '活着', '作者': '余华', '出版社': '作家出版社', 'ISBN': '978', '出版年限': 0}",       // 年份为 0
+            "{'书名': '活着', '作者': '余华', '出版社': '作家出版社', 'ISBN': '978', '出版年限': 99999999999}",
+            "{'书名': '活着', '作者': '余华', '出版社': '作家出版社', 'ISBN': '978', '出版年限': 1993} x", // 多余内容
+            "{'书名': '活着, '作者': '余华', '出版社': '作家出版社', 'ISBN': '978', '出版年限': 1993}",   // 引号未闭合
+            "{'书名': '活着', '作者': '余华', '出版社': '作家出版社', 'ISBN': '978', '出版年限': 1993",    // 缺右括号
+            "{'书名': '活着', '作者': '余华', '出版社': '作家出版社', 'ISBN': '978', '出版年限': '1993'}", // 年份是字符串
+            "{'书名': 'abc\\",
+        };
+        for (const char* line : invalid) {
+            CHECK(!parse(line, book));
+        }
+    }
+
+    std::string bookLine(size_t i) {
+        // 书名长度随编号变化，使行边界落在文件各处；部分行带转义
+        std::string title = "title" + std::to_string(i) + std::string(i % 37, 'x');
+        if (i % 11 == 0) title += "\\'quoted\\'";
+        return "{'书名': '" + title + "', '作者': 'author" + std::to_string(i % 13)
+               + "', '出版社': 'publisher', 'ISBN': 'isbn" + std::to_string(i)
+               + "', '出版年限': " + std::to_string(1900 + i % 120) + "}";
+    }
+
+    void testParseFileChunks(const TestSupport::TempDir& dir) {
+        // 约 2MB，按最小块 256KB 计可以切成多块
+        const size_t LINE_COUNT = 20000;
+        std::string path = dir.path("books.txt");
+        MyVector<Book> expected(LINE_COUNT);
+        size_t expectedLines = 0;
+        size_t expectedSkipped = 0;
+        {
+            std::ofstream file(path, std::ios::binary);
+            for (size_t i = 0; i < LINE_COUNT; ++i) {
+                if (i % 97 == 0) {
+                    file << "not a book\n";
+                    ++expectedLines;
+                    ++expectedSkipped;
+                }
+                if (i % 89 == 0) {
+                    file << "\n";
+                }
+                std::string line = bookLine(i);
+                Book book;
+                CHECK(BookImporter::parseLine(line, book));
+                expected.push_back(book);
+                ++expectedLines;
+                file << line;
+                // 混用 CRLF，最后一行没有换行符
+                if (i + 1 < LINE_COUNT) file << (i % 3 == 0 ? "\r\n" : "\n");
+            }
+        }
+
+        for (unsigned threads : {1u, 2u, 3u, 4u, 7u, 16u}) {
+            MyVector<Book> books;
+            BookImporter::Stats stats;
+            CHECK(BookImporter::parseFile(path, books, stats, threads));
+            CHECK(stats.lineCount == expectedLines);
+            CHECK(stats.bookCount == LINE_COUNT);
+            CHECK(stats.skippedCount == expectedSkipped);
+            CHECK(books.getSize() == LINE_COUNT);
+            bool same = books.getSize() == LINE_COUNT;
+            for (size_t i = 0; i < books.getSize() && same; ++i) {
+                same = books[i].getIsbn() == expected[i].getIsbn() && books[i].getTitle() == expected[i].getTitle()
+                       && books[i].getPublishYear() == expected[i].getPublishYear();
+            }
+            CHECK(same);
+        }
+
+        // 进度最终达到文件大小；回调返回 false 时取消
+        std::atomic<size_t> lastDone{0};
+        std::atomic<size_t> lastTotal{0};
+        MyVector<Book> books;
+        BookImporter::Stats stats;
+        CHECK(BookImporter::parseFile(path, books, stats, 4, [&](size_t done, size_t total) {
+            size_t previous = lastDone.load();
+            while (done > previous && !lastDone.compare_exchange_weak(previous, done)) {
+            }
+            lastTotal = total;
+            return true;
+        }));
+        CHECK(lastTotal.load() > 0 && lastDone.load() == lastTotal.load());
+        CHECK(!BookImporter::parseFile(path, books, stats, 4, [](size_t, size_t) { return false; }));
+    }
+
+    void testEmptyAndMissingFiles(const TestSupport::TempDir& dir) {
+        std::string path = dir.path("empty.txt");
+        { std::ofstream file(path); }
+        MyVector<Book> books;
+        books.emplace_back("keep", "keep", "keep", "keep", 2000);
+        BookImporter::Stats stats;
+        CHECK(BookImporter::parseFile(path, books, stats));
+        CHECK(books.getSize() == 0 && stats.lineCount == 0);
+        CHECK(!BookImporter::parseFile(dir.path("missing.txt"), books, stats));
+    }
+}
+
+int main() {
+    TestSupport::TempDir dir("bms_book_importer_test");
+    testParseLine();
+    testParseFileChunks(dir);
+    testEmptyAndMissingFiles(dir);
+    return TestSupport::result();
+}
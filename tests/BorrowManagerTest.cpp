@@ -0,0 +1,135 @@
+#include "TestSupport.h"
+#include "../include/BookManager.h"
+#include "../include/BorrowManager.h"
+#include "../include/User.h"
+#include <QString>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#ifndef _WIN32
+#include <csignal>
+#include <sys/resource.h>
+#endif
+
+/**
+ * @brief 借阅变动保存失败时的测试
+ * 没有日志时借阅记录或等待队列文件写不成，借还、续借须返回 false 或抛出异常；
+ * 有日志时日志写入失败改为写快照，快照也写不成才报告失败，
+ * 恢复后下一次提交把积压的变动一并写入，重新载入后与内存一致。
+ * @author 陈子涵
+ */
+
+namespace {
+    void addFixtures(BookManager& books, UserManager& users) {
+        for (int i = 0; i < 3; ++i) {
+            books.addBook(Book("b" + std::to_string(i), "title", "author", "publisher", 2000));
+        }
+        users.addUser(User("u0", "p", USER));
+        users.addUser(User("u1", "p", USER));
+    }
+
+    int lastRecordId(const BorrowManager& borrows) {
+        auto lock = borrows.readLock();
+        const MyVector<BorrowRecord>& records = borrows.getAllBorrowRecords();
+        return records.getSize() > 0 ? records[records.getSize() - 1].getId() : -1;
+    }
+
+    bool throwsSaveFailure(BorrowManager& borrows, int recordId) {
+        try {
+            borrows.renewBook(recordId);
+        } catch (const std::runtime_error& e) {
+            return std::string(e.what()) == "借阅记录保存失败";
+        }
+        return false;
+    }
+
+    // 没有日志时每次操作整体写出当前目录下的 JSON 文件
+    void testWithoutJournal(const TestSupport::TempDir& dir) {
+        std::filesystem::path previous = std::filesystem::current_path();
+        std::filesystem::create_directories(dir.path("plain"));
+        std::filesystem::current_path(dir.path("plain"));
+
+        BookManager books;
+        UserManager users;
+        addFixtures(books, users);
+        BorrowManager borrows(&books, &users);
+        // 同名目录使记录文件无法写入
+        std::filesystem::create_directory("borrow_records.json");
+        CHECK(!borrows.borrowBook("b0", "u0"));
+        CHECK(throwsSaveFailure(borrows, lastRecordId(borrows)));
+        CHECK(!borrows.returnBook("b0", "u0"));
+
+        std::filesystem::remove("borrow_records.json");
+        CHECK(borrows.borrowBook("b1", "u0"));
+        CHECK(borrows.returnBook("b1", "u0"));
+
+        BookManager reloadedBooks;
+        UserManager reloadedUsers;
+        addFixtures(reloadedBooks, reloadedUsers);
+        BorrowManager reloaded(&reloadedBooks, &reloadedUsers);
+        CHECK(reloaded.openJournal("borrow_records.json", "waiting_queues.json", "borrow_journal.log"));
+        {
+            auto lock = reloaded.readLock();
+            CHECK(reloaded.getAllBorrowRecords().getSize() == 2);
+            CHECK(reloaded.findActiveLoanByIsbn("b0") == nullptr && reloaded.findActiveLoanByIsbn("b1") == nullptr);
+        }
+        std::filesystem::current_path(previous);
+    }
+
+#ifndef _WIN32
+    // 用文件大小上限让日志只写进一部分，留下残缺的末尾
+    void testJournalWriteFailure(const TestSupport::TempDir& dir) {
+        std::string recordsPath = dir.path("borrow_records.bin");
+        std::string queuesPath = dir.path("waiting_queues.json");
+        std::string journalPath = dir.path("borrow_journal.log");
+
+        BookManager books;
+        UserManager users;
+        addFixtures(books, users);
+        BorrowManager borrows(&books, &users);
+        CHECK(borrows.openJournal(QString::fromStdString(recordsPath), QString::fromStdString(queuesPath),
+                                  QString::fromStdString(journalPath)));
+        CHECK(borrows.borrowBook("b0", "u0"));
+
+        std::filesystem::create_directory(recordsPath);
+        std::signal(SIGXFSZ, SIG_IGN);
+        rlimit original{};
+        getrlimit(RLIMIT_FSIZE, &original);
+        rlimit limited = original;
+        limited.rlim_cur = static_cast<rlim_t>(std::filesystem::file_size(journalPath) + 10);
+        setrlimit(RLIMIT_FSIZE, &limited);
+        bool borrowed = borrows.borrowBook("b1", "u1");
+        setrlimit(RLIMIT_FSIZE, &original);
+        CHECK(!borrowed);
+
+        // 快照恢复可写后，下一次提交写出全部记录并清空残缺的日志
+        std::filesystem::remove(recordsPath);
+        CHECK(borrows.returnBook("b0", "u0"));
+        CHECK(std::filesystem::file_size(journalPath) == 0);
+        CHECK(borrows.renewBook("b1", "u1"));
+
+        BookManager reloadedBooks;
+        UserManager reloadedUsers;
+        addFixtures(reloadedBooks, reloadedUsers);
+        BorrowManager reloaded(&reloadedBooks, &reloadedUsers);
+        CHECK(reloaded.openJournal(QString::fromStdString(recordsPath), QString::fromStdString(queuesPath),
+                                   QString::fromStdString(journalPath)));
+        {
+            auto lock = reloaded.readLock();
+            CHECK(reloaded.getAllBorrowRecords().getSize() == 2);
+            CHECK(reloaded.findActiveLoanByIsbn("b0") == nullptr);
+            const BorrowRecord* loan = reloaded.findActiveLoanByIsbn("b1");
+            CHECK(loan && loan->getUsername() == "u1");
+        }
+    }
+#endif
+}
+
+int main() {
+    TestSupport::TempDir dir("bms_borrow_manager_test");
+    testWithoutJournal(dir);
+#ifndef _WIN32
+    testJournalWriteFailure(dir);
+#endif
+    return TestSupport::result();
+}
@@ -0,0 +1,224 @@
+#include "TestSupport.h"
+#include "../include/BookManager.h"
+#include "../include/BorrowManager.h"
+#include "../include/User.h"
+#include <QString>
+#include <atomic>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief BookManager、UserManager、BorrowManager 的并发读写压力测试
+ * 读线程不停地分页、检索、补全、遍历快照并写出二进制快照（模拟自动保存），
+ * 写线程同时借还、续借、增删改图书、后台导入、增加用户并压缩借阅日志。
+ * 结束后检查图书数量、借阅状态与未归还记录一致，并从日志重新载入比对。
+ * 应以 ThreadSanitizer 构建运行（cmake -DBMS_BUILD_TESTS=ON -DBMS_TSAN=ON），无数据竞争报告才算通过。
+ * @author 陈子涵
+ */
+
+namespace {
+    const int POOL_BOOKS = 2000; //可借阅的图书
+    const int SHARED_ISBNS = 50; //写线程争用的图书
+    const int USER_COUNT = 8;
+    const int READERS = 4;
+    const int WRITERS = 4;
+    const int WRITER_ROUNDS = 100;
+    const int IMPORT_BOOKS = 500;
+
+    std::string poolIsbn(int i) { return "isbn" + std::to_string(i); }
+
+    void readerLoop(BookManager& books, BorrowManager& borrows, const UserManager& users,
+                    const std::atomic<bool>& stop, const std::string& snapshotPath, int seed) {
+        std::mt19937 rng(seed);
+        size_t sink = 0;
+        while (!stop.load()) {
+            SortBy sortBy = static_cast<SortBy>(rng() % 5);
+            sink += books.getSortedPage(sortBy, SortOrder::DESCENDING, rng() % 100, 20).getSize();
+            sink += books.findBooksByTitle("title" + std::to_string(rng() % 97)).getSize();
+            sink += books.getCompletions(CompletionField::TITLE, "title1", 10).getSize();
+
+            BookQuery query(QueryCondition::statusIs(1) || QueryCondition::yearBetween(1995, 2000));
+            query.orderBy(SortBy::TITLE);
+            size_t total = 0;
+            CatalogSnapshot view;
+            MyVector<uint32_t> page = books.getQueryPage(query, 0, 20, total, &view);
+            for (size_t i = 0; i < page.getSize(); ++i) {
+                sink += view.getBookAt(page[i]).getTitle().size();
+            }
+
+            CatalogSnapshot snapshot = books.snapshot();
+            for (size_t i = 0; i < snapshot.getBookCount(); i += 97) {
+                sink += snapshot.getBookAt(i).getIsbn().size();
+            }
+            Book book;
+            sink += books.findBook(poolIsbn(rng() % POOL_BOOKS), book) ? 1 : 0;
+            if (rng() % 32 == 0) {
+                books.saveToBinaryFile(snapshotPath);
+            }
+
+            std::string username = "u" + std::to_string(rng() % USER_COUNT);
+            sink += borrows.getBorrowCount(username);
+            sink += borrows.getUserBorrowRecords(username).getSize();
+            sink += borrows.getSortedRecordIndices(BorrowSortBy::ISBN).getSize();
+            {
+                auto lock = borrows.readLock();
+                sink += borrows.getAllBorrowRecords().getSize();
+                sink += borrows.findActiveLoanByIsbn(poolIsbn(rng() % SHARED_ISBNS)) ? 1 : 0;
+            }
+            sink += users.fuzzyFindUsers("u").getSize();
+            sink += users.hasUser(username) ? 1 : 0;
+        }
+        (void)sink;
+    }
+
+    void writerLoop(BookManager& books, BorrowManager& borrows, UserManager& users, int writer) {
+        std::string username = "u" + std::to_string(writer);
+        for (int k = 0; k < WRITER_ROUNDS; ++k) {
+            std::string isbn = poolIsbn((writer * 37 + k) % SHARED_ISBNS);
+            try {
+                borrows.borrowBook(isbn, username);
+            } catch (const std::runtime_error&) {
+                // 已被借走时进入等待队列，或已在队列中
+            }
+            if (k % 3 == 0) {
+                try {
+                    borrows.renewBook(isbn, username);
+                } catch (const std::runtime_error&) {
+                }
+            }
+            if (k % 2 == 1) {
+                // 按记录号归还，须与按 ISBN 归还一样释放图书并处理等待队列
+                int recordId = -1;
+                {
+                    auto lock = borrows.readLock();
+                    const BorrowRecord* loan = borrows.findActiveLoanByIsbn(isbn);
+                    if (loan && loan->getUsername() == username) recordId = loan->getId();
+                }
+                if (recordId >= 0) {
+                    try {
+                        borrows.returnBook(recordId);
+                    } catch (const std::runtime_error&) {
+                    }
+                }
+            }
+            try {
+                borrows.returnBook(isbn, username);
+            } catch (const std::runtime_error&) {
+            }
+
+            std::string extra = "x" + std::to_string(writer) + "_" + std::to_string(k);
+            books.addBook(Book(extra, "title" + std::to_string(k % 97), "author", "publisher", 2000));
+            books.updateBookField(poolIsbn(SHARED_ISBNS + writer * WRITER_ROUNDS + k), "title",
+                                  "renamed" + std::to_string(k));
+            if (k % 2 == 0) {
+                books.removeBook(extra);
+            }
+            if (k % 25 == 0) {
+                borrows.compact();
+                users.addUser(User("n" + std::to_string(writer * 1000 + k), "p", USER));
+            }
+        }
+    }
+}
+
+int main() {
+    TestSupport::TempDir dir("bms_concurrency_stress");
+    std::string recordsPath = dir.path("borrow_records.bin");
+    std::string queuesPath = dir.path("waiting_queues.json");
+    std::string journalPath = dir.path("borrow_journal.log");
+
+    BookManager books;
+    UserManager users;
+    BorrowManager borrows(&books, &users);
+    MyVector<Book> initial(POOL_BOOKS);
+    for (int i = 0; i < POOL_BOOKS; ++i) {
+        initial.emplace_back(poolIsbn(i), "title" + std::to_string(i % 97), "author" + std::to_string(i % 13),
+                             "publisher", 1990 + i % 30);
+    }
+    books.importBooks(std::move(initial), DuplicatePolicy::SKIP);
+    for (int u = 0; u < USER_COUNT; ++u) {
+        users.addUser(User("u" + std::to_string(u), "p", USER));
+    }
+    CHECK(borrows.openJournal(QString::fromStdString(recordsPath), QString::fromStdString(queuesPath),
+                              QString::fromStdString(journalPath)));
+
+    std::atomic<bool> stop{false};
+    std::vector<std::thread> readers;
+    for (int r = 0; r < READERS; ++r) {
+        std::string snapshotPath = dir.path("books_" + std::to_string(r) + ".bin");
+        readers.emplace_back([&, snapshotPath, r] { readerLoop(books, borrows, users, stop, snapshotPath, r); });
+    }
+    std::vector<std::thread> writers;
+    for (int w = 0; w < WRITERS; ++w) {
+        writers.emplace_back([&, w] { writerLoop(books, borrows, users, w); });
+    }
+    // 后台导入，与界面中 QtConcurrent 导入线程的用法相同
+    writers.emplace_back([&] {
+        MyVector<Book> batch(IMPORT_BOOKS);
+        for (int i = 0; i < IMPORT_BOOKS; ++i) {
+            batch.emplace_back("imp" + std::to_string(i), "imported", "author", "publisher", 2010);
+        }
+        books.importBooks(std::move(batch), DuplicatePolicy::SKIP);
+    });
+    for (std::thread& writer : writers) {
+        writer.join();
+    }
+    stop = true;
+    for (std::thread& reader : readers) {
+        reader.join();
+    }
+
+    CHECK(books.getBookCount() == static_cast<size_t>(POOL_BOOKS + IMPORT_BOOKS + WRITERS * WRITER_ROUNDS / 2));
+    CHECK(users.getAllUsers().getSize() == static_cast<size_t>(USER_COUNT + WRITERS * (WRITER_ROUNDS / 25)));
+
+    // 每本争用图书的借阅状态都与是否有未归还记录一致
+    size_t activeLoans = 0;
+    {
+        auto lock = borrows.readLock();
+        for (int i = 0; i < SHARED_ISBNS; ++i) {
+            Book book;
+            CHECK(books.findBook(poolIsbn(i), book));
+            bool onLoan = borrows.findActiveLoanByIsbn(poolIsbn(i)) != nullptr;
+            CHECK(book.getStatus() == (onLoan ? 1 : 0));
+            activeLoans += onLoan ? 1 : 0;
+        }
+        const MyVector<BorrowRecord>& records = borrows.getAllBorrowRecords();
+        size_t unreturned = 0;
+        size_t misplaced = 0;
+        for (size_t i = 0; i < records.getSize(); ++i) {
+            unreturned += records[i].getIsReturned() ? 0 : 1;
+            misplaced += borrows.findRecordById(records[i].getId()) == &records[i] ? 0 : 1;
+        }
+        CHECK(unreturned == activeLoans);
+        CHECK(misplaced == 0);
+        CHECK(borrows.findRecordById(-1) == nullptr && borrows.findRecordById(BorrowRecord::MAX_ID) == nullptr);
+    }
+
+    // 快照加日志重新载入后，借阅记录与未归还的图书都和内存中一致
+    BookManager reloadedBooks;
+    UserManager reloadedUsers;
+    for (int i = 0; i < SHARED_ISBNS; ++i) {
+        reloadedBooks.addBook(Book(poolIsbn(i), "title", "author", "publisher", 2000));
+    }
+    for (int u = 0; u < USER_COUNT; ++u) {
+        reloadedUsers.addUser(User("u" + std::to_string(u), "p", USER));
+    }
+    BorrowManager reloaded(&reloadedBooks, &reloadedUsers);
+    CHECK(reloaded.openJournal(QString::fromStdString(recordsPath), QString::fromStdString(queuesPath),
+                               QString::fromStdString(journalPath)));
+    {
+        auto lock = borrows.readLock();
+        auto reloadedLock = reloaded.readLock();
+        CHECK(reloaded.getAllBorrowRecords().getSize() == borrows.getAllBorrowRecords().getSize());
+        for (int i = 0; i < SHARED_ISBNS; ++i) {
+            const BorrowRecord* expected = borrows.findActiveLoanByIsbn(poolIsbn(i));
+            const BorrowRecord* actual = reloaded.findActiveLoanByIsbn(poolIsbn(i));
+            CHECK((expected == nullptr) == (actual == nullptr));
+            CHECK(!expected || !actual || expected->getId() == actual->getId());
+        }
+    }
+    return TestSupport::result();
+}
@@ -0,0 +1,253 @@
+#include "TestSupport.h"
+#include "../include/BookManager.h"
+#include "../include/IdStream.h"
+#include <algorithm>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+/**
+ * @brief 下标流与查询规划的测试
+ * 各种流的 seek 须返回第一个不小于 target 的下标：重复 seek 当前下标不前进，
+ * 越过末尾后一直返回 END，空流直接返回 END；And / Or / Filter 嵌套后与集合运算一致。
+ * BookManager::queryIds 对随机条件树（含排序与条数上限）须与逐本 matches 的结果一致。
+ * @author 陈子涵
+ */
+
+namespace {
+    using Ids = std::vector<uint32_t>;
+
+    MyVector<uint32_t> toList(const Ids& ids) {
+        MyVector<uint32_t> list;
+        for (uint32_t id : ids) list.push_back(id);
+        return list;
+    }
+
+    std::unique_ptr<IdStream> listOf(const Ids& ids) {
+        return std::make_unique<ListStream>(toList(ids));
+    }
+
+    MyVector<std::unique_ptr<IdStream>> streamsOf(std::initializer_list<Ids> lists) {
+        MyVector<std::unique_ptr<IdStream>> streams;
+        for (const Ids& ids : lists) streams.push_back(listOf(ids));
+        return streams;
+    }
+
+    // 每次 seek 到上一个结果加一，取出全部下标
+    Ids drain(IdStream& stream) {
+        Ids out;
+        for (uint32_t id = stream.seek(0); id != IdStream::END; id = stream.seek(id + 1)) {
+            out.push_back(id);
+        }
+        return out;
+    }
+
+    void testListAndRange() {
+        ListStream list(toList({2, 5, 9}));
+        CHECK(list.seek(0) == 2);
+        CHECK(list.seek(2) == 2); // 停在当前下标
+        CHECK(list.seek(3) == 5);
+        CHECK(list.seek(5) == 5);
+        CHECK(list.seek(9) == 9);
+        CHECK(list.seek(10) == IdStream::END);
+        CHECK(list.seek(10) == IdStream::END);
+
+        MyVector<uint32_t> borrowed = toList({1, 4});
+        ListStream view(&borrowed);
+        CHECK(view.seek(4) == 4 && view.seek(5) == IdStream::END);
+
+        ListStream empty{MyVector<uint32_t>()};
+        CHECK(empty.seek(0) == IdStream::END);
+
+        RangeStream range(3);
+        CHECK(range.seek(0) == 0 && range.seek(2) == 2 && range.seek(3) == IdStream::END);
+        RangeStream none(0);
+        CHECK(none.seek(0) == IdStream::END);
+    }
+
+    void testCombinators() {
+        AndStream both(streamsOf({{1, 3, 5, 7, 9, 11}, {0, 3, 4, 9, 11, 12}, {3, 9, 10, 11}}));
+        CHECK(both.seek(0) == 3);
+        CHECK(both.seek(3) == 3);
+        CHECK(both.seek(4) == 9);
+        CHECK(both.seek(10) == 11);
+        CHECK(both.seek(12) == IdStream::END);
+
+        AndStream disjoint(streamsOf({{1, 3}, {2, 4}}));
+        CHECK(disjoint.seek(0) == IdStream::END);
+        AndStream withEmpty(streamsOf({{1, 2, 3}, {}}));
+        CHECK(withEmpty.seek(0) == IdStream::END);
+        AndStream single(streamsOf({{4, 8}}));
+        CHECK(drain(single) == Ids({4, 8}));
+
+        OrStream either(streamsOf({{1, 5, 9}, {}, {2, 5, 6}, {9, 20}}));
+        CHECK(either.seek(0) == 1);
+        CHECK(either.seek(1) == 1);
+        CHECK(either.seek(2) == 2);
+        CHECK(either.seek(3) == 5); // 两个子流都有 5，只产出一次
+        CHECK(either.seek(6) == 6);
+        CHECK(either.seek(7) == 9);
+        CHECK(either.seek(10) == 20);
+        CHECK(either.seek(21) == IdStream::END);
+        OrStream noStreams{MyVector<std::unique_ptr<IdStream>>()};
+        CHECK(noStreams.seek(0) == IdStream::END);
+
+        FilterStream even(std::make_unique<RangeStream>(10), [](uint32_t id) { return id % 2 == 0; });
+        CHECK(even.seek(1) == 2);
+        CHECK(even.seek(2) == 2);
+        CHECK(even.seek(9) == IdStream::END);
+        FilterStream nothing(listOf({1, 3}), [](uint32_t) { return false; });
+        CHECK(nothing.seek(0) == IdStream::END);
+    }
+
+    Ids randomList(std::mt19937& rng, uint32_t universe) {
+        std::set<uint32_t> ids;
+        size_t count = rng() % 40;
+        for (size_t i = 0; i < count; ++i) ids.insert(rng() % universe);
+        return Ids(ids.begin(), ids.end());
+    }
+
+    // 嵌套的 And(Or(a, b), Filter(c)) 与集合运算比对，seek 的步长随机
+    void testRandomNesting() {
+        std::mt19937 rng(17);
+        const uint32_t UNIVERSE = 120;
+        for (int round = 0; round < 500; ++round) {
+            Ids a = randomList(rng, UNIVERSE);
+            Ids b = randomList(rng, UNIVERSE);
+            Ids c = randomList(rng, UNIVERSE);
+            uint32_t modulus = 1 + rng() % 4;
+
+            std::set<uint32_t> expected;
+            for (uint32_t id : c) {
+                bool inUnion = std::binary_search(a.begin(), a.end(), id) || std::binary_search(b.begin(), b.end(), id);
+                if (inUnion && id % modulus == 0) expected.insert(id);
+            }
+
+            MyVector<std::unique_ptr<IdStream>> parts;
+            parts.push_back(std::make_unique<OrStream>(streamsOf({a, b})));
+            parts.push_back(std::make_unique<FilterStream>(listOf(c), [modulus](uint32_t id) { return id % modulus == 0; }));
+            AndStream stream(std::move(parts));
+
+            bool same = true;
+            uint32_t target = 0;
+            while (same) {
+                uint32_t id = stream.seek(target);
+                auto next = expected.lower_bound(target);
+                uint32_t want = next == expected.end() ? IdStream::END : *next;
+                same = id == want;
+                if (id == IdStream::END || target >= UNIVERSE) break;
+                // 有时停在原地再 seek 一次，有时跳过若干下标
+                target = rng() % 3 == 0 ? id : id + static_cast<uint32_t>(rng() % 6);
+            }
+            CHECK(same);
+        }
+    }
+
+    using F = QueryCondition::Field;
+    const char* const VOCABULARY[] = {"Data", "structures", "in", "C++", "三体", "刘慈欣", "科幻", "the", "World", "machine"};
+    const size_t VOCABULARY_SIZE = sizeof(VOCABULARY) / sizeof(VOCABULARY[0]);
+
+    std::string randomText(std::mt19937& rng) {
+        std::string text;
+        int count = 1 + static_cast<int>(rng() % 3);
+        for (int i = 0; i < count; ++i) {
+            if (i > 0) text += " ";
+            text += VOCABULARY[rng() % VOCABULARY_SIZE];
+        }
+        return text;
+    }
+
+    QueryCondition randomCondition(std::mt19937& rng, int depth) {
+        switch (rng() % (depth > 0 ? 9 : 6)) {
+        case 0: {
+            std::string text = randomText(rng);
+            return QueryCondition::contains(F(rng() % 4), text.substr(rng() % text.size(), rng() % 7));
+        }
+        case 1: return QueryCondition::equals(F(rng() % 3), randomText(rng));
+        case 2: {
+            int from = 1995 + static_cast<int>(rng() % 30);
+            return QueryCondition::yearBetween(from, from + static_cast<int>(rng() % 8));
+        }
+        case 3: return QueryCondition::statusIs(static_cast<int>(rng() % 2));
+        case 4: return QueryCondition::equals(F::ISBN, "i" + std::to_string(rng() % 3000));
+        case 5: return QueryCondition::contains(F(rng() % 3), VOCABULARY[rng() % VOCABULARY_SIZE]);
+        case 6: return randomCondition(rng, depth - 1) && randomCondition(rng, depth - 1);
+        case 7: return randomCondition(rng, depth - 1) || randomCondition(rng, depth - 1);
+        default: return !randomCondition(rng, depth - 1);
+        }
+    }
+
+    bool columnLess(const Book& a, const Book& b, SortBy by) {
+        switch (by) {
+        case SortBy::ISBN: return a.getIsbn() < b.getIsbn();
+        case SortBy::TITLE: return a.getTitle() < b.getTitle();
+        case SortBy::AUTHOR: return a.getAuthor() < b.getAuthor();
+        case SortBy::PUBLISHER: return a.getPublisher() < b.getPublisher();
+        default: return a.getPublishYear() < b.getPublishYear();
+        }
+    }
+
+    // 逐本判断再排序；降序时同值按下标降序，即升序结果整体反转
+    Ids bruteForce(const BookQuery& query, const CatalogSnapshot& snapshot) {
+        Ids ids;
+        for (uint32_t i = 0; i < snapshot.getBookCount(); ++i) {
+            if (query.where.matches(snapshot.getBookAt(i))) ids.push_back(i);
+        }
+        if (query.sorted) {
+            std::stable_sort(ids.begin(), ids.end(), [&](uint32_t a, uint32_t b) {
+                return columnLess(snapshot.getBookAt(a), snapshot.getBookAt(b), query.sortBy);
+            });
+            if (query.order == SortOrder::DESCENDING) std::reverse(ids.begin(), ids.end());
+        }
+        if (ids.size() > query.limit) ids.resize(query.limit);
+        return ids;
+    }
+
+    void testQueryPlanning() {
+        std::mt19937 rng(5);
+        BookManager manager;
+        for (int i = 0; i < 3000; ++i) {
+            Book book("i" + std::to_string(i), randomText(rng), randomText(rng), randomText(rng),
+                      1995 + static_cast<int>(rng() % 30));
+            book.setStatus(static_cast<int>(rng() % 2));
+            manager.addBook(book);
+        }
+
+        size_t mismatches = 0;
+        for (int k = 0; k < 2000; ++k) {
+            BookQuery query(randomCondition(rng, 3));
+            if (rng() % 2) query.orderBy(SortBy(rng() % 5), SortOrder(rng() % 2));
+            if (rng() % 2) query.take(rng() % 50);
+            // 中途建好排序缓存，走沿整列顺序挑选的分支
+            if (k == 1000) {
+                manager.getSortedIndices(SortBy::TITLE);
+                manager.getSortedIndices(SortBy::YEAR);
+            }
+            CatalogSnapshot snapshot;
+            MyVector<uint32_t> ids = manager.queryIds(query, &snapshot);
+            Ids got;
+            for (size_t i = 0; i < ids.getSize(); ++i) got.push_back(ids[i]);
+            if (got != bruteForce(query, snapshot)) ++mismatches;
+
+            // forEachMatch 按下标升序回调，且回调返回 false 时停止
+            Ids visited;
+            manager.forEachMatch(query.where, [&](uint32_t id, const Book&) {
+                visited.push_back(id);
+                return visited.size() < 5;
+            });
+            BookQuery unsorted(query.where);
+            Ids expected = bruteForce(unsorted.take(5), snapshot);
+            if (visited != expected) ++mismatches;
+        }
+        CHECK(mismatches == 0);
+    }
+}
+
+int main() {
+    testListAndRange();
+    testCombinators();
+    testRandomNesting();
+    testQueryPlanning();
+    return TestSupport::result();
+}
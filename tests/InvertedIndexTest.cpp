@@ -0,0 +1,206 @@
+#include "TestSupport.h"
+#include "../include/BookManager.h"
+#include "../include/InvertedIndex.h"
+#include "../include/TextTokenizer.h"
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+/**
+ * @brief 分词、倒排表维护与按词检索的测试
+ * 倒排表在乱序插入、删除、下标前移后须保持升序无重复；
+ * BookManager::searchBookIds 在随机增删改、批量导入和重新载入后，
+ * 结果须与逐本分词比对的暴力检索完全一致。
+ * @author 陈子涵
+ */
+
+namespace {
+    std::vector<uint32_t> toVector(const MyVector<uint32_t>* list) {
+        std::vector<uint32_t> out;
+        for (size_t i = 0; list && i < list->getSize(); ++i) {
+            out.push_back((*list)[i]);
+        }
+        return out;
+    }
+
+    MyVector<uint32_t> idList(std::initializer_list<uint32_t> ids) {
+        MyVector<uint32_t> list;
+        for (uint32_t id : ids) list.push_back(id);
+        return list;
+    }
+
+    std::string words(std::string_view text) {
+        std::string joined;
+        TextTokenizer::forEachWord(text, [&](std::string_view word) {
+            joined += std::string(word) + "|";
+        });
+        return joined;
+    }
+
+    void testTokenizer() {
+        CHECK(words("Hello, 世界! C++ v2") == "hello|世|界|c|v2|");
+        CHECK(words("  --  ") == "");
+        CHECK(words("ABC-def_GHI") == "abc|def|ghi|");
+        // 残缺的 UTF-8 序列按单字节切分，不越界
+        CHECK(words("a\xE4\xB8") == "a|\xE4|\xB8|");
+    }
+
+    void testPostings() {
+        InvertedIndex index;
+        for (uint32_t id : {5u, 1u, 9u, 3u, 5u, 7u, 1u}) {
+            index.add("data", id);
+        }
+        index.add("tree", 2);
+        CHECK(toVector(index.find("data")) == std::vector<uint32_t>({1, 3, 5, 7, 9}));
+        CHECK(index.getTermCount() == 2 && index.getPostingCount() == 6);
+        CHECK(index.find("missing") == nullptr);
+
+        index.erase("data", 5);
+        index.erase("data", 4);
+        index.erase("missing", 1);
+        CHECK(toVector(index.find("data")) == std::vector<uint32_t>({1, 3, 7, 9}));
+        CHECK(index.getPostingCount() == 5);
+
+        // 删除下标 4 的文档后，大于 4 的下标各减一
+        index.shiftDown(idList({4}));
+        CHECK(toVector(index.find("data")) == std::vector<uint32_t>({1, 3, 6, 8}));
+        CHECK(toVector(index.find("tree")) == std::vector<uint32_t>({2}));
+
+        // 一次删除下标 0、3、7：1 -> 0，6 -> 4，8 -> 5，2 -> 1
+        index.erase("data", 3);
+        index.shiftDown(idList({0, 3, 7}));
+        CHECK(toVector(index.find("data")) == std::vector<uint32_t>({0, 4, 5}));
+        CHECK(toVector(index.find("tree")) == std::vector<uint32_t>({1}));
+        index.shiftDown(MyVector<uint32_t>());
+        CHECK(toVector(index.find("data")) == std::vector<uint32_t>({0, 4, 5}));
+
+        // 倒排表被删空后词仍可查到，表为空
+        index.erase("tree", 1);
+        CHECK(index.find("tree") != nullptr && index.find("tree")->getSize() == 0);
+
+        index.clear();
+        CHECK(index.getTermCount() == 0 && index.getPostingCount() == 0 && index.find("data") == nullptr);
+    }
+
+    void testListOperations() {
+        MyVector<uint32_t> a;
+        MyVector<uint32_t> b;
+        for (uint32_t v : {1u, 4u, 6u, 9u, 12u, 40u}) a.push_back(v);
+        for (uint32_t v = 0; v < 50; v += 3) b.push_back(v);
+        CHECK(InvertedIndex::gallop(b, 0, 10) == 4);
+        CHECK(InvertedIndex::gallop(b, 2, 0) == 2);
+        CHECK(InvertedIndex::gallop(b, 0, 100) == b.getSize());
+
+        MyVector<uint32_t> united = InvertedIndex::unite(a, b);
+        std::set<uint32_t> expected;
+        for (size_t i = 0; i < a.getSize(); ++i) expected.insert(a[i]);
+        for (size_t i = 0; i < b.getSize(); ++i) expected.insert(b[i]);
+        CHECK(toVector(&united) == std::vector<uint32_t>(expected.begin(), expected.end()));
+
+        MyVector<uint32_t> intersection = a;
+        InvertedIndex::intersect(intersection, b);
+        CHECK(toVector(&intersection) == std::vector<uint32_t>({6, 9, 12}));
+        MyVector<uint32_t> empty;
+        InvertedIndex::intersect(intersection, empty);
+        CHECK(intersection.getSize() == 0);
+    }
+
+    const char* const VOCABULARY[] = {"Data", "structures", "ALGORITHMS", "in", "C++", "三体", "刘慈欣", "科幻",
+                                      "世界", "history", "of", "the", "World", "machine", "learning"};
+
+    std::string randomText(std::mt19937& rng) {
+        std::string text;
+        int count = 1 + static_cast<int>(rng() % 4);
+        for (int i = 0; i < count; ++i) {
+            if (i > 0) text += rng() % 2 ? " " : "-";
+            text += VOCABULARY[rng() % (sizeof(VOCABULARY) / sizeof(VOCABULARY[0]))];
+        }
+        return text;
+    }
+
+    std::set<std::string> tokenSet(std::string_view text) {
+        std::set<std::string> tokens;
+        TextTokenizer::forEachWord(text, [&](std::string_view word) { tokens.insert(std::string(word)); });
+        return tokens;
+    }
+
+    const std::string& fieldOf(const Book& book, TextField field) {
+        return field == TextField::TITLE ? book.getTitle()
+               : field == TextField::AUTHOR ? book.getAuthor() : book.getPublisher();
+    }
+
+    bool searchMatchesBruteForce(const BookManager& manager) {
+        const char* queries[] = {"data", "DATA structures", "三体", "刘慈欣 科幻", "world history", "c++",
+                                 "zzz", "三", "the of", "", "!!"};
+        for (const char* query : queries) {
+            std::set<std::string> wanted = tokenSet(query);
+            for (TextField field : {TextField::TITLE, TextField::AUTHOR, TextField::PUBLISHER}) {
+                for (TermMatch match : {TermMatch::ALL, TermMatch::ANY}) {
+                    CatalogSnapshot snapshot;
+                    MyVector<uint32_t> ids = manager.searchBookIds(field, query, match, &snapshot);
+                    std::vector<uint32_t> expected;
+                    for (uint32_t i = 0; i < snapshot.getBookCount(); ++i) {
+                        std::set<std::string> tokens = tokenSet(fieldOf(snapshot.getBookAt(i), field));
+                        size_t hits = 0;
+                        for (const std::string& token : wanted) hits += tokens.count(token);
+                        bool matched = !wanted.empty() && (match == TermMatch::ALL ? hits == wanted.size() : hits > 0);
+                        if (matched) expected.push_back(i);
+                    }
+                    if (toVector(&ids) != expected) return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    void testSearchAgainstBruteForce(const TestSupport::TempDir& dir) {
+        std::mt19937 rng(7);
+        BookManager manager;
+        for (int i = 0; i < 1500; ++i) {
+            manager.addBook(Book("i" + std::to_string(i), randomText(rng), randomText(rng), randomText(rng), 2000));
+        }
+        CHECK(searchMatchesBruteForce(manager));
+
+        for (int k = 0; k < 300; ++k) {
+            std::string isbn = "i" + std::to_string(rng() % 1500);
+            switch (rng() % 4) {
+            case 0: manager.removeBook(isbn); break;
+            case 1: manager.updateBookField(isbn, "title", randomText(rng)); break;
+            case 2: manager.updateBook(isbn, Book(isbn, randomText(rng), randomText(rng), randomText(rng), 1999)); break;
+            default: manager.addBook(Book("n" + std::to_string(k), randomText(rng), randomText(rng), randomText(rng), 2001));
+            }
+        }
+        CHECK(searchMatchesBruteForce(manager));
+
+        // 批量删除，含重复和不存在的 ISBN
+        MyVector<std::string> isbns;
+        for (int i = 0; i < 120; ++i) isbns.push_back("i" + std::to_string(rng() % 1600));
+        size_t before = manager.getBookCount();
+        size_t removedCount = manager.removeBooks(isbns);
+        CHECK(manager.getBookCount() == before - removedCount);
+        CHECK(removedCount > 0 && manager.removeBooks(isbns) == 0);
+        CHECK(searchMatchesBruteForce(manager));
+
+        MyVector<Book> batch;
+        for (int i = 0; i < 200; ++i) {
+            batch.push_back(Book("i" + std::to_string(i * 7), randomText(rng), randomText(rng), randomText(rng), 2002));
+        }
+        manager.importBooks(std::move(batch), DuplicatePolicy::OVERWRITE);
+        CHECK(searchMatchesBruteForce(manager));
+
+        std::string path = dir.path("books.bin");
+        CHECK(manager.saveToBinaryFile(path));
+        CHECK(manager.loadFromBinaryFile(path));
+        CHECK(searchMatchesBruteForce(manager));
+    }
+}
+
+int main() {
+    TestSupport::TempDir dir("bms_inverted_index_test");
+    testTokenizer();
+    testPostings();
+    testListOperations();
+    testSearchAgainstBruteForce(dir);
+    return TestSupport::result();
+}
@@ -0,0 +1,130 @@
+#include "TestSupport.h"
+#include "../include/BookManager.h"
+#include "../include/MappedCatalog.h"
+#include "../include/User.h"
+#include <cstdio>
+#include <filesystem>
+#include <string>
+
+/**
+ * @brief 内存映射图书目录的测试
+ * 打开后各字段与写出的图书一致且都直接指向映射内容，没有任何一行被复制；
+ * 第一次修改某行时只把这一行复制成 Book，其余行仍指向映射，
+ * 写回快照后重新载入能看到修改；类型不符、被截断的文件打不开，内容损坏由 verifyChecksum 发现。
+ * @author 陈子涵
+ */
+
+namespace {
+    const int BOOK_COUNT = 1000;
+
+    std::string isbnOf(int i) { return "isbn" + std::to_string(i); }
+
+    bool rowMatches(const MappedCatalog& catalog, size_t row, const Book& book) {
+        return catalog.getIsbn(row) == book.getIsbn() && catalog.getTitle(row) == book.getTitle()
+               && catalog.getAuthor(row) == book.getAuthor() && catalog.getPublisher(row) == book.getPublisher()
+               && catalog.getPublishYear(row) == book.getPublishYear() && catalog.getStatus(row) == book.getStatus();
+    }
+
+    bool rowMapped(const MappedCatalog& catalog, size_t row) {
+        return catalog.isMapped(catalog.getIsbn(row)) && catalog.isMapped(catalog.getTitle(row))
+               && catalog.isMapped(catalog.getAuthor(row)) && catalog.isMapped(catalog.getPublisher(row));
+    }
+
+    void testZeroCopyUntilEdited(const TestSupport::TempDir& dir) {
+        std::string path = dir.path("books.bin");
+        BookManager books;
+        for (int i = 0; i < BOOK_COUNT; ++i) {
+            Book book(isbnOf(i), "title" + std::to_string(i), "author" + std::to_string(i % 17),
+                      "publisher" + std::to_string(i % 5), 1990 + i % 30);
+            book.setStatus(i % 3 == 0 ? 1 : 0);
+            books.addBook(book);
+        }
+        CHECK(books.saveToBinaryFile(path));
+
+        MappedCatalog catalog;
+        CHECK(catalog.open(path));
+        CHECK(catalog.verifyChecksum());
+        CHECK(catalog.getBookCount() == static_cast<size_t>(BOOK_COUNT));
+        size_t mismatches = 0;
+        size_t copied = 0;
+        {
+            auto lock = books.readLock();
+            for (size_t row = 0; row < catalog.getBookCount(); ++row) {
+                mismatches += rowMatches(catalog, row, books.getBookAt(static_cast<uint32_t>(row))) ? 0 : 1;
+                copied += rowMapped(catalog, row) ? 0 : 1;
+            }
+        }
+        CHECK(mismatches == 0);
+        CHECK(copied == 0);
+        CHECK(catalog.getEditedCount() == 0 && !catalog.isEdited(5));
+
+        // 第一次修改只复制这一行
+        catalog.editBook(5).setTitle("edited title");
+        CHECK(catalog.isEdited(5) && catalog.getEditedCount() == 1);
+        CHECK(catalog.getTitle(5) == "edited title" && catalog.getIsbn(5) == isbnOf(5));
+        CHECK(!catalog.isMapped(catalog.getTitle(5)) && !catalog.isMapped(catalog.getIsbn(5)));
+        CHECK(rowMapped(catalog, 4) && rowMapped(catalog, 6) && !catalog.isEdited(6));
+        // 再次修改同一行沿用副本
+        catalog.editBook(5).setStatus(1);
+        catalog.editBook(900).setPublishYear(2024);
+        CHECK(catalog.getEditedCount() == 2);
+        CHECK(catalog.getTitle(5) == "edited title" && catalog.getStatus(5) == 1);
+        CHECK(catalog.getBook(900).getPublishYear() == 2024);
+        copied = 0;
+        for (size_t row = 0; row < catalog.getBookCount(); ++row) {
+            copied += rowMapped(catalog, row) ? 0 : 1;
+        }
+        CHECK(copied == 2);
+
+        // 写回正在映射的文件，映射中未修改的行仍可读
+        CHECK(catalog.saveToBinaryFile(path));
+        CHECK(catalog.getTitle(6) == "title6" && rowMapped(catalog, 6));
+        BookManager reloaded;
+        CHECK(reloaded.loadFromBinaryFile(path));
+        Book book;
+        CHECK(reloaded.getBookCount() == static_cast<size_t>(BOOK_COUNT));
+        CHECK(reloaded.findBook(isbnOf(5), book) && book.getTitle() == "edited title" && book.getStatus() == 1);
+        CHECK(reloaded.findBook(isbnOf(900), book) && book.getPublishYear() == 2024);
+        CHECK(reloaded.findBook(isbnOf(6), book) && book.getTitle() == "title6");
+
+        catalog.close();
+        CHECK(!catalog.isOpen() && catalog.getEditedCount() == 0 && !catalog.saveToBinaryFile(path));
+    }
+
+    void testRejectsBadFiles(const TestSupport::TempDir& dir) {
+        std::string path = dir.path("books.bin");
+        MappedCatalog catalog;
+        CHECK(!catalog.open(dir.path("missing.bin")));
+
+        // 用户快照的类型不符
+        UserManager users;
+        users.addUser(User("u0", "p", USER));
+        std::string usersPath = dir.path("users.bin");
+        CHECK(users.saveToBinaryFile(usersPath));
+        CHECK(!catalog.open(usersPath));
+
+        // 字符串表中改一个字节：打开只看文件头，校验才能发现
+        std::string corruptPath = dir.path("corrupt.bin");
+        std::filesystem::copy_file(path, corruptPath);
+        std::FILE* file = std::fopen(corruptPath.c_str(), "r+b");
+        CHECK(file != nullptr);
+        if (file) {
+            std::fseek(file, 40, SEEK_SET);
+            std::fputc('#', file);
+            std::fclose(file);
+        }
+        CHECK(catalog.open(corruptPath) && !catalog.verifyChecksum());
+
+        std::string truncatedPath = dir.path("truncated.bin");
+        std::filesystem::copy_file(path, truncatedPath);
+        std::filesystem::resize_file(truncatedPath, std::filesystem::file_size(path) - 9);
+        CHECK(!catalog.open(truncatedPath) && !catalog.isOpen());
+    }
+}
+
+int main() {
+    TestSupport::TempDir dir("bms_mapped_catalog_test");
+    testZeroCopyUntilEdited(dir);
+    testRejectsBadFiles(dir);
+    return TestSupport::result();
+}
@@ -0,0 +1,168 @@
+#include "TestSupport.h"
+#include "../include/BookManager.h"
+#include "../include/PrefixIndex.h"
+#include <algorithm>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+/**
+ * @brief 前缀索引与输入补全的测试
+ * 取值按忽略 ASCII 大小写的顺序排列，计数归零才移除，批量归并与逐个加入等价；
+ * BookManager::getCompletions 在增删改、三种导入策略和重新载入后，
+ * 结果须与逐本比对前缀的暴力结果一致。
+ * @author 陈子涵
+ */
+
+namespace {
+    std::vector<std::string> toVector(const MyVector<std::string>& list) {
+        std::vector<std::string> out;
+        for (size_t i = 0; i < list.getSize(); ++i) {
+            out.push_back(list[i]);
+        }
+        return out;
+    }
+
+    using Strings = std::vector<std::string>;
+
+    void testPrefixIndex() {
+        PrefixIndex index;
+        for (const char* text : {"data", "Data", "DATA structures", "tree", "", "data", "三体", "三体 II"}) {
+            index.add(text);
+        }
+        CHECK(index.getSize() == 6);
+        // 忽略大小写后相同的按原文排序
+        CHECK(toVector(index.complete("da", 10)) == Strings({"Data", "data", "DATA structures"}));
+        CHECK(toVector(index.complete("DATA ", 10)) == Strings({"DATA structures"}));
+        CHECK(toVector(index.complete("三体", 10)) == Strings({"三体", "三体 II"}));
+        CHECK(toVector(index.complete("da", 2)) == Strings({"Data", "data"}));
+        CHECK(index.complete("x", 10).getSize() == 0);
+        CHECK(index.complete("", 100).getSize() == 6);
+
+        // "data" 加入了两次，删一次仍在
+        index.erase("data");
+        CHECK(toVector(index.complete("data", 10)) == Strings({"Data", "data", "DATA structures"}));
+        index.erase("data");
+        CHECK(toVector(index.complete("data", 10)) == Strings({"Data", "DATA structures"}));
+        index.erase("missing");
+        index.erase("");
+        CHECK(index.getSize() == 5);
+
+        // 批量归并：与已有取值合并计数，批内重复和空文本也要处理
+        std::string texts[] = {"tree", "Tree", "", "apple", "tree", "Data"};
+        MyVector<std::string_view> batch;
+        for (const std::string& text : texts) batch.push_back(text);
+        index.addAll(batch);
+        CHECK(toVector(index.complete("", 100))
+              == Strings({"apple", "Data", "DATA structures", "Tree", "tree", "三体", "三体 II"}));
+        // "tree" 共计三次，删两次仍在
+        index.erase("tree");
+        index.erase("tree");
+        CHECK(toVector(index.complete("t", 10)) == Strings({"Tree", "tree"}));
+        index.erase("tree");
+        CHECK(toVector(index.complete("t", 10)) == Strings({"Tree"}));
+
+        index.clear();
+        CHECK(index.getSize() == 0 && index.complete("", 10).getSize() == 0);
+    }
+
+    const char* const VOCABULARY[] = {"Data", "data", "DATA", "structures", "in", "C++", "三体", "刘慈欣", "科幻",
+                                      "the", "World", "machine"};
+
+    std::string randomText(std::mt19937& rng) {
+        // 约三分之一为空文本
+        std::string text;
+        int count = static_cast<int>(rng() % 3);
+        for (int i = 0; i < count; ++i) {
+            if (i > 0) text += " ";
+            text += VOCABULARY[rng() % (sizeof(VOCABULARY) / sizeof(VOCABULARY[0]))];
+        }
+        return text;
+    }
+
+    std::string fold(std::string text) {
+        for (char& c : text) {
+            if (c >= 'A' && c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
+        }
+        return text;
+    }
+
+    const std::string& fieldOf(const Book& book, CompletionField field) {
+        switch (field) {
+        case CompletionField::TITLE: return book.getTitle();
+        case CompletionField::AUTHOR: return book.getAuthor();
+        case CompletionField::PUBLISHER: return book.getPublisher();
+        default: return book.getIsbn();
+        }
+    }
+
+    bool completionsMatchBruteForce(const BookManager& manager) {
+        const char* prefixes[] = {"", "d", "Da", "DATA s", "三", "三体 ", "x", "i1", "I1", "i19"};
+        CatalogSnapshot snapshot = manager.snapshot();
+        for (const char* prefix : prefixes) {
+            std::string folded = fold(prefix);
+            for (CompletionField field : {CompletionField::TITLE, CompletionField::AUTHOR,
+                                          CompletionField::PUBLISHER, CompletionField::ISBN}) {
+                std::set<std::string> values;
+                for (size_t i = 0; i < snapshot.getBookCount(); ++i) {
+                    const std::string& text = fieldOf(snapshot.getBookAt(i), field);
+                    if (!text.empty() && fold(text).compare(0, folded.size(), folded) == 0) values.insert(text);
+                }
+                Strings expected(values.begin(), values.end());
+                std::sort(expected.begin(), expected.end(), [](const std::string& a, const std::string& b) {
+                    std::string fa = fold(a);
+                    std::string fb = fold(b);
+                    return fa != fb ? fa < fb : a < b;
+                });
+                for (size_t limit : {1u, 5u, 100000u}) {
+                    Strings limited(expected.begin(), expected.begin() + std::min(limit, expected.size()));
+                    if (toVector(manager.getCompletions(field, prefix, limit)) != limited) return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    void testCompletionsAgainstBruteForce(const TestSupport::TempDir& dir) {
+        std::mt19937 rng(5);
+        BookManager manager;
+        for (int i = 0; i < 2000; ++i) {
+            manager.addBook(Book("i" + std::to_string(i), randomText(rng), randomText(rng), randomText(rng), 2000));
+        }
+        CHECK(completionsMatchBruteForce(manager));
+
+        for (int k = 0; k < 500; ++k) {
+            std::string isbn = "i" + std::to_string(rng() % 2000);
+            switch (rng() % 4) {
+            case 0: manager.removeBook(isbn); break;
+            case 1: manager.updateBookField(isbn, "author", randomText(rng)); break;
+            case 2: manager.updateBook(isbn, Book(isbn, randomText(rng), randomText(rng), randomText(rng), 1999)); break;
+            default: manager.addBook(Book("n" + std::to_string(k), randomText(rng), randomText(rng), randomText(rng), 2001));
+            }
+        }
+        CHECK(completionsMatchBruteForce(manager));
+
+        for (DuplicatePolicy policy : {DuplicatePolicy::SKIP, DuplicatePolicy::OVERWRITE, DuplicatePolicy::MERGE}) {
+            MyVector<Book> batch;
+            for (int i = 0; i < 300; ++i) {
+                std::string isbn = (i % 3 ? "i" : "z") + std::to_string(i % 150 + static_cast<int>(policy) * 1000);
+                batch.push_back(Book(isbn, randomText(rng), randomText(rng), randomText(rng), 2002));
+            }
+            manager.importBooks(std::move(batch), policy);
+            CHECK(completionsMatchBruteForce(manager));
+        }
+
+        std::string path = dir.path("books.bin");
+        CHECK(manager.saveToBinaryFile(path));
+        CHECK(manager.loadFromBinaryFile(path));
+        CHECK(completionsMatchBruteForce(manager));
+    }
+}
+
+int main() {
+    TestSupport::TempDir dir("bms_prefix_index_test");
+    testPrefixIndex();
+    testCompletionsAgainstBruteForce(dir);
+    return TestSupport::result();
+}
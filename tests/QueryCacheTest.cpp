@@ -0,0 +1,145 @@
+#include "TestSupport.h"
+#include "../include/BookManager.h"
+#include <algorithm>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief 分页查询缓存的测试
+ * getQueryPage 的每一页须等于 queryIds 完整结果的对应切片，总数一致，越界页为空；
+ * 增删改、借阅状态变化和导入之后，缓存的旧结果不能再被返回；
+ * 超过 QUERY_CACHE_CAPACITY 个不同查询轮换时结果仍正确，并发翻页与写入不出错。
+ * @author 陈子涵
+ */
+
+namespace {
+    using F = QueryCondition::Field;
+
+    BookQuery queryFor(int k) {
+        BookQuery query(QueryCondition::contains(F::TITLE, "t" + std::to_string(k))
+                        || QueryCondition::yearBetween(2000 + k % 5, 2001 + k % 5));
+        if (k % 2) query.orderBy(SortBy::TITLE, k % 3 == 0 ? SortOrder::DESCENDING : SortOrder::ASCENDING);
+        return query;
+    }
+
+    bool pageMatchesFullResult(const BookManager& manager, const BookQuery& query, size_t offset, size_t count) {
+        size_t total = 0;
+        CatalogSnapshot snapshot;
+        MyVector<uint32_t> page = manager.getQueryPage(query, offset, count, total, &snapshot);
+        MyVector<uint32_t> full = manager.queryIds(query);
+        if (total != full.getSize()) return false;
+        size_t end = std::min(total, offset + count);
+        if (page.getSize() != (offset < total ? end - offset : 0)) return false;
+        for (size_t i = 0; i < page.getSize(); ++i) {
+            if (page[i] != full[offset + i]) return false;
+            // 下标对应同时取得的版本
+            if (!query.where.matches(snapshot.getBookAt(page[i]))) return false;
+        }
+        return true;
+    }
+
+    size_t totalOf(const BookManager& manager, const BookQuery& query) {
+        size_t total = 0;
+        manager.getQueryPage(query, 0, 10, total);
+        return total;
+    }
+
+    void testPagesAgainstFullResult() {
+        std::mt19937 rng(9);
+        BookManager manager;
+        for (int i = 0; i < 5000; ++i) {
+            manager.addBook(Book("i" + std::to_string(i), "t" + std::to_string(i % 97), "a", "p", 1990 + i % 30));
+        }
+        // 40 个不同查询轮换，超过缓存容量，期间穿插写入
+        size_t mismatches = 0;
+        for (int r = 0; r < 2000; ++r) {
+            if (!pageMatchesFullResult(manager, queryFor(static_cast<int>(rng() % 40)), rng() % 3000, rng() % 50)) {
+                ++mismatches;
+            }
+            std::string isbn = "i" + std::to_string(rng() % 5000);
+            switch (rng() % 20) {
+            case 0: manager.removeBook(isbn); break;
+            case 1: manager.updateBookStatus(isbn, 1); break;
+            case 2: manager.updateBookField(isbn, "title", "t" + std::to_string(rng() % 97)); break;
+            case 3: manager.addBook(Book("n" + std::to_string(r), "t5", "a", "p", 2001)); break;
+            default: break;
+            }
+        }
+        CHECK(mismatches == 0);
+        // 同一查询连续翻页，包括最后一页之后
+        BookQuery query = queryFor(7);
+        size_t total = totalOf(manager, query);
+        for (size_t offset = 0; offset <= total + 20; offset += 20) {
+            CHECK(pageMatchesFullResult(manager, query, offset, 20));
+        }
+    }
+
+    void testInvalidation() {
+        BookManager manager;
+        for (int i = 0; i < 100; ++i) {
+            manager.addBook(Book("i" + std::to_string(i), "t" + std::to_string(i % 10), "a", "p", 2000 + i % 5));
+        }
+        BookQuery borrowed(QueryCondition::statusIs(1));
+        BookQuery byTitle = BookQuery(QueryCondition::contains(F::TITLE, "t3")).orderBy(SortBy::YEAR);
+        CHECK(totalOf(manager, borrowed) == 0);
+        CHECK(totalOf(manager, byTitle) == 10);
+
+        // 借阅状态变化只影响状态条件的结果
+        CHECK(manager.updateBookStatus("i0", 1));
+        CHECK(totalOf(manager, borrowed) == 1);
+        CHECK(pageMatchesFullResult(manager, borrowed, 0, 10));
+        CHECK(manager.updateBookStatus("i0", 0));
+        CHECK(totalOf(manager, borrowed) == 0);
+
+        manager.updateBookField("i1", "title", "t3");
+        CHECK(totalOf(manager, byTitle) == 11);
+        manager.removeBook("i3");
+        CHECK(totalOf(manager, byTitle) == 10);
+        CHECK(pageMatchesFullResult(manager, byTitle, 0, 100));
+        manager.addBook(Book("new", "t3 new", "a", "p", 1999));
+        CHECK(totalOf(manager, byTitle) == 11);
+        // 新书年份最早，排序后排在第一页最前
+        CatalogSnapshot snapshot;
+        size_t total = 0;
+        MyVector<uint32_t> page = manager.getQueryPage(byTitle, 0, 1, total, &snapshot);
+        CHECK(page.getSize() == 1 && snapshot.getBookAt(page[0]).getIsbn() == "new");
+
+        MyVector<Book> batch;
+        batch.push_back(Book("i13", "other", "a", "p", 2000));
+        batch.push_back(Book("imported", "t3", "a", "p", 2000));
+        manager.importBooks(std::move(batch), DuplicatePolicy::OVERWRITE);
+        CHECK(totalOf(manager, byTitle) == 11);
+        CHECK(pageMatchesFullResult(manager, byTitle, 0, 100));
+    }
+
+    // 多个线程翻页，同时有线程写入
+    void testConcurrentPaging() {
+        BookManager manager;
+        for (int i = 0; i < 2000; ++i) {
+            manager.addBook(Book("i" + std::to_string(i), "t" + std::to_string(i % 97), "a", "p", 1990 + i % 30));
+        }
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([&manager, t] {
+                std::mt19937 rng(static_cast<unsigned>(t));
+                for (int r = 0; r < 300; ++r) {
+                    size_t total = 0;
+                    manager.getQueryPage(queryFor(static_cast<int>(rng() % 40)), rng() % 100, 20, total);
+                    if (t == 0 && r % 10 == 0) manager.addBook(Book("x" + std::to_string(r), "t1", "a", "p", 2000));
+                }
+            });
+        }
+        for (std::thread& thread : threads) thread.join();
+        CHECK(manager.getBookCount() == 2030);
+        CHECK(pageMatchesFullResult(manager, queryFor(1), 0, 50));
+    }
+}
+
+int main() {
+    testPagesAgainstFullResult();
+    testInvalidation();
+    testConcurrentPaging();
+    return TestSupport::result();
+}
@@ -0,0 +1,126 @@
+#include "TestSupport.h"
+#include "../include/BookManager.h"
+#include "../include/TextTokenizer.h"
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+ * @brief 码点三元组切分与子串检索的测试
+ * findBooksByTitle / Author / Publisher 走三元组倒排索引，
+ * 结果须与逐本 std::string::find 完全一致，包括短于三个码点的片段、
+ * 跨词的片段、残缺 UTF-8 以及增删改、导入和重新载入之后。
+ * @author 陈子涵
+ */
+
+namespace {
+    std::string trigrams(std::string_view text) {
+        std::string joined;
+        TextTokenizer::forEachTrigram(text, [&](std::string_view gram) { joined += std::string(gram) + "|"; });
+        return joined;
+    }
+
+    void testTrigrams() {
+        CHECK(trigrams("Data") == "Dat|ata|");
+        CHECK(trigrams("ab") == "");
+        CHECK(trigrams("三体人") == "三体人|");
+        CHECK(trigrams("三体 C") == "三体 |体 C|");
+        // 残缺序列的每个字节单独算一个码点
+        CHECK(trigrams("\xE4\xB8x") == "\xE4\xB8x|");
+        CHECK(TextTokenizer::isWellFormed("三体 abc"));
+        CHECK(!TextTokenizer::isWellFormed("\xE4\xB8"));
+        CHECK(!TextTokenizer::isWellFormed("\x80x"));
+    }
+
+    // 含残缺 UTF-8 片段，检验索引与检索的切分一致
+    const char* const VOCABULARY[] = {"Data", "structures", "ALGORITHMS", "in", "C++", "三体", "刘慈欣", "科幻",
+                                      "世界", "history", "of", "the", "World", "machine", "learning",
+                                      "\xE4\xB8", "\x80x", "ab"};
+
+    std::string randomText(std::mt19937& rng) {
+        std::string text;
+        int count = 1 + static_cast<int>(rng() % 4);
+        for (int i = 0; i < count; ++i) {
+            if (i > 0) text += rng() % 2 ? " " : "-";
+            text += VOCABULARY[rng() % (sizeof(VOCABULARY) / sizeof(VOCABULARY[0]))];
+        }
+        return text;
+    }
+
+    bool sameIsbns(const MyVector<Book>& found, const std::vector<std::string>& expected) {
+        if (found.getSize() != expected.size()) return false;
+        for (size_t i = 0; i < expected.size(); ++i) {
+            if (found[i].getIsbn() != expected[i]) return false;
+        }
+        return true;
+    }
+
+    bool matchesBruteForce(BookManager& manager, const std::string& needle) {
+        MyVector<Book> byTitle = manager.findBooksByTitle(needle);
+        MyVector<Book> byAuthor = manager.findBooksByAuthor(needle);
+        MyVector<Book> byPublisher = manager.findBooksByPublisher(needle);
+        CatalogSnapshot snapshot = manager.snapshot();
+        std::vector<std::string> titles, authors, publishers;
+        for (size_t i = 0; i < snapshot.getBookCount(); ++i) {
+            const Book& book = snapshot.getBookAt(i);
+            if (book.getTitle().find(needle) != std::string::npos) titles.push_back(book.getIsbn());
+            if (book.getAuthor().find(needle) != std::string::npos) authors.push_back(book.getIsbn());
+            if (book.getPublisher().find(needle) != std::string::npos) publishers.push_back(book.getIsbn());
+        }
+        return sameIsbns(byTitle, titles) && sameIsbns(byAuthor, authors) && sameIsbns(byPublisher, publishers);
+    }
+
+    bool allMatchBruteForce(BookManager& manager, std::mt19937& rng) {
+        const char* needles[] = {"ata", "Data", "data", "三体", "三", "体刘", "刘慈欣", "慈欣 科幻", "ures-the", "e M",
+                                 "zzz", "", "\xE4\xB8", "\x80", "C++", "++ 三", "s i", "历史", "orld machi"};
+        for (const char* needle : needles) {
+            if (!matchesBruteForce(manager, needle)) return false;
+        }
+        // 从随机文本中截取任意字节片段，可能切在码点中间
+        for (int r = 0; r < 150; ++r) {
+            std::string text = randomText(rng);
+            size_t pos = rng() % (text.size() + 1);
+            if (!matchesBruteForce(manager, text.substr(pos, rng() % 6))) return false;
+        }
+        return true;
+    }
+
+    void testSearchAgainstBruteForce(const TestSupport::TempDir& dir) {
+        std::mt19937 rng(11);
+        BookManager manager;
+        for (int i = 0; i < 1500; ++i) {
+            manager.addBook(Book("i" + std::to_string(i), randomText(rng), randomText(rng), randomText(rng), 2000));
+        }
+        CHECK(allMatchBruteForce(manager, rng));
+
+        for (int k = 0; k < 300; ++k) {
+            std::string isbn = "i" + std::to_string(rng() % 1500);
+            switch (rng() % 4) {
+            case 0: manager.removeBook(isbn); break;
+            case 1: manager.updateBookField(isbn, "publisher", randomText(rng)); break;
+            case 2: manager.updateBook(isbn, Book(isbn, randomText(rng), randomText(rng), randomText(rng), 1999)); break;
+            default: manager.addBook(Book("n" + std::to_string(k), randomText(rng), randomText(rng), randomText(rng), 2001));
+            }
+        }
+        CHECK(allMatchBruteForce(manager, rng));
+
+        MyVector<Book> batch;
+        for (int i = 0; i < 200; ++i) {
+            batch.push_back(Book("i" + std::to_string(i * 7), randomText(rng), randomText(rng), randomText(rng), 2002));
+        }
+        manager.importBooks(std::move(batch), DuplicatePolicy::OVERWRITE);
+        CHECK(allMatchBruteForce(manager, rng));
+
+        std::string path = dir.path("books.bin");
+        CHECK(manager.saveToBinaryFile(path));
+        CHECK(manager.loadFromBinaryFile(path));
+        CHECK(allMatchBruteForce(manager, rng));
+    }
+}
+
+int main() {
+    TestSupport::TempDir dir("bms_substring_search_test");
+    testTrigrams();
+    testSearchAgainstBruteForce(dir);
+    return TestSupport::result();
+}
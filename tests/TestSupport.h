@@ -0,0 +1,56 @@
+#pragma once
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <system_error>
+
+/**
+ * @brief 测试程序共用的检查宏和临时目录
+ * CHECK 失败时打印位置并计数，不中断后续检查；main 最后返回 TestSupport::result()。
+ * @author 陈子涵
+ */
+namespace TestSupport {
+    inline int& failureCount() {
+        static int count = 0;
+        return count;
+    }
+
+    inline int result() {
+        if (failureCount() > 0) {
+            std::fprintf(stderr, "%d check(s) failed\n", failureCount());
+            return 1;
+        }
+        std::printf("all checks passed\n");
+        return 0;
+    }
+
+    // 在系统临时目录下新建一个空目录，析构时连同内容删除
+    class TempDir {
+    private:
+        std::filesystem::path root;
+
+    public:
+        explicit TempDir(const std::string& name) {
+            root = std::filesystem::temp_directory_path() / name;
+            std::error_code error;
+            std::filesystem::remove_all(root, error);
+            std::filesystem::create_directories(root);
+        }
+        ~TempDir() {
+            std::error_code error;
+            std::filesystem::remove_all(root, error);
+        }
+        TempDir(const TempDir&) = delete;
+        TempDir& operator=(const TempDir&) = delete;
+
+        std::string path(const std::string& file) const { return (root / file).string(); }
+    };
+}
+
+#define CHECK(condition)                                                                   \
+    do {                                                                                   \
+        if (!(condition)) {                                                                \
+            std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #condition); \
+            ++TestSupport::failureCount();                                                 \
+        }                                                                                  \
+    } while (0)
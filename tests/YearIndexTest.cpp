@@ -0,0 +1,177 @@
+#include "TestSupport.h"
+#include "../include/BookManager.h"
+#include "../include/YearIndex.h"
+#include <algorithm>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief 出版年份索引与按年份检索的测试
+ * 范围外的年份（早于 MIN_YEAR、晚于 MAX_YEAR、零和负数）与桶内年份混在一起时，
+ * range 须先按年份、同年按下标排序，ids 按下标排序；删除后的下标前移对两部分都生效。
+ * findBooksByYear / findBooksByYearRange 在增删改、导入和重新载入后须与暴力结果一致。
+ * @author 陈子涵
+ */
+
+namespace {
+    std::vector<uint32_t> toVector(const MyVector<uint32_t>& list) {
+        std::vector<uint32_t> out;
+        for (size_t i = 0; i < list.getSize(); ++i) {
+            out.push_back(list[i]);
+        }
+        return out;
+    }
+
+    using Ids = std::vector<uint32_t>;
+
+    MyVector<uint32_t> idList(std::initializer_list<uint32_t> ids) {
+        MyVector<uint32_t> list;
+        for (uint32_t id : ids) list.push_back(id);
+        return list;
+    }
+
+    void testYearIndex() {
+        YearIndex index;
+        // 乱序加入，下标 i 的年份为 years[i]
+        const int years[] = {2000, 999, 2030, -50, 2000, 1000, 2024, 0, 999, 2025};
+        const uint32_t order[] = {9, 3, 0, 7, 5, 1, 8, 2, 6, 4};
+        for (uint32_t id : order) {
+            index.add(years[id], id);
+        }
+
+        CHECK(toVector(index.range(-100, 3000)) == Ids({3, 7, 1, 8, 5, 0, 4, 6, 9, 2}));
+        CHECK(toVector(index.ids(-100, 3000)) == Ids({0, 1, 2, 3, 4, 5, 6, 7, 8, 9}));
+        CHECK(index.count(-100, 3000) == 10);
+        CHECK(toVector(index.range(999, 1000)) == Ids({1, 8, 5}));
+        CHECK(toVector(index.range(2024, 2025)) == Ids({6, 9}));
+        CHECK(toVector(index.range(2000, 2000)) == Ids({0, 4}));
+        CHECK(toVector(index.range(0, 0)) == Ids({7}));
+        CHECK(index.range(2031, 5000).getSize() == 0 && index.count(1001, 1999) == 0);
+        CHECK(index.range(2024, 1000).getSize() == 0 && index.count(2024, 1000) == 0);
+
+        // 只看桶时，区间内有范围外年份须返回 false
+        MyVector<const MyVector<uint32_t>*> lists;
+        CHECK(index.bucketLists(1000, 2024, lists) && lists.getSize() == 3);
+        lists.clear();
+        CHECK(!index.bucketLists(990, 2024, lists));
+
+        // 删除下标 4（2000 年）和 3（-50 年）：先 erase，再一次前移
+        index.erase(2000, 4);
+        index.erase(-50, 3);
+        index.shiftDown(idList({3, 4}));
+        // 原下标 5..9 变为 3..7，原 0..2 不变
+        CHECK(toVector(index.range(-100, 3000)) == Ids({5, 1, 6, 3, 0, 4, 7, 2}));
+        CHECK(toVector(index.range(2000, 2000)) == Ids({0}));
+        CHECK(toVector(index.range(2025, 2030)) == Ids({7, 2}));
+        CHECK(toVector(index.ids(-100, 3000)) == Ids({0, 1, 2, 3, 4, 5, 6, 7}));
+
+        // 删除不存在的项不影响索引
+        index.erase(1500, 0);
+        index.erase(-1, 0);
+        CHECK(index.count(-100, 3000) == 8);
+
+        // 再删除下标 0、5（2000 年、0 年），桶内和范围外的下标都前移；空表不改动索引
+        index.erase(2000, 0);
+        index.erase(0, 5);
+        index.shiftDown(idList({0, 5}));
+        index.shiftDown(MyVector<uint32_t>());
+        CHECK(toVector(index.range(-100, 3000)) == Ids({0, 4, 2, 3, 5, 1}));
+        CHECK(toVector(index.ids(-100, 3000)) == Ids({0, 1, 2, 3, 4, 5}));
+
+        index.clear();
+        CHECK(index.count(-100000, 100000) == 0);
+    }
+
+    int randomYear(std::mt19937& rng) {
+        int r = static_cast<int>(rng() % 10);
+        if (r == 0) return rng() % 2 ? -static_cast<int>(rng() % 5) : 2025 + static_cast<int>(rng() % 3);
+        if (r == 1) return 990 + static_cast<int>(rng() % 20);
+        return 2015 + static_cast<int>(rng() % 15);
+    }
+
+    bool rangeMatchesBruteForce(BookManager& manager, int from, int to) {
+        MyVector<Book> found = manager.findBooksByYearRange(from, to);
+        CatalogSnapshot snapshot = manager.snapshot();
+        std::vector<std::pair<int, size_t>> expected;
+        for (size_t i = 0; i < snapshot.getBookCount(); ++i) {
+            int year = snapshot.getBookAt(i).getPublishYear();
+            if (year >= from && year <= to) expected.push_back({year, i});
+        }
+        std::sort(expected.begin(), expected.end());
+        if (found.getSize() != expected.size()) return false;
+        for (size_t i = 0; i < expected.size(); ++i) {
+            if (found[i].getIsbn() != snapshot.getBookAt(expected[i].second).getIsbn()) return false;
+        }
+        if (from == to) {
+            MyVector<Book> sameYear = manager.findBooksByYear(from);
+            if (sameYear.getSize() != expected.size()) return false;
+            for (size_t i = 0; i < expected.size(); ++i) {
+                if (sameYear[i].getIsbn() != found[i].getIsbn()) return false;
+            }
+        }
+        return true;
+    }
+
+    bool allMatchBruteForce(BookManager& manager, std::mt19937& rng) {
+        const std::pair<int, int> fixed[] = {{0, 0}, {-5, 3000}, {2020, 2020}, {2026, 2026}, {2024, 1000},
+                                             {-3, -1}, {999, 999}, {1000, 1000}, {2024, 2024}};
+        for (const auto& range : fixed) {
+            if (!rangeMatchesBruteForce(manager, range.first, range.second)) return false;
+        }
+        for (int k = 0; k < 60; ++k) {
+            int from = 980 + static_cast<int>(rng() % 60);
+            int to = from + static_cast<int>(rng() % 30) - 5;
+            if (!rangeMatchesBruteForce(manager, from, to)) return false;
+        }
+        return true;
+    }
+
+    void testSearchAgainstBruteForce(const TestSupport::TempDir& dir) {
+        std::mt19937 rng(3);
+        BookManager manager;
+        for (int i = 0; i < 3000; ++i) {
+            manager.addBook(Book("i" + std::to_string(i), "t", "a", "p", randomYear(rng)));
+        }
+        CHECK(allMatchBruteForce(manager, rng));
+
+        for (int k = 0; k < 500; ++k) {
+            std::string isbn = "i" + std::to_string(rng() % 3000);
+            switch (rng() % 4) {
+            case 0: manager.removeBook(isbn); break;
+            case 1: manager.updateBookField(isbn, "year", std::to_string(1000 + rng() % 1100)); break;
+            case 2: manager.updateBook(isbn, Book(isbn, "t", "a", "p", randomYear(rng))); break;
+            default: manager.addBook(Book("n" + std::to_string(k), "t", "a", "p", randomYear(rng)));
+            }
+        }
+        CHECK(allMatchBruteForce(manager, rng));
+
+        MyVector<std::string> isbns;
+        for (int i = 0; i < 200; ++i) isbns.push_back("i" + std::to_string(rng() % 3000));
+        CHECK(manager.removeBooks(isbns) > 0);
+        CHECK(allMatchBruteForce(manager, rng));
+
+        for (DuplicatePolicy policy : {DuplicatePolicy::SKIP, DuplicatePolicy::OVERWRITE, DuplicatePolicy::MERGE}) {
+            MyVector<Book> batch;
+            for (int i = 0; i < 300; ++i) {
+                std::string isbn = "i" + std::to_string(i % 150 + static_cast<int>(policy) * 1000);
+                batch.push_back(Book(isbn, "t", "a", "p", randomYear(rng)));
+            }
+            manager.importBooks(std::move(batch), policy);
+            CHECK(allMatchBruteForce(manager, rng));
+        }
+
+        std::string path = dir.path("books.bin");
+        CHECK(manager.saveToBinaryFile(path));
+        CHECK(manager.loadFromBinaryFile(path));
+        CHECK(allMatchBruteForce(manager, rng));
+    }
+}
+
+int main() {
+    TestSupport::TempDir dir("bms_year_index_test");
+    testYearIndex();
+    testSearchAgainstBruteForce(dir);
+    return TestSupport::result();
+}
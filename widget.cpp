@@ -6,6 +6,7 @@
 #include "include/BorrowManager.h"
 #include "include/PermissionManager.h"
 #include "include/MyQueue.h"
+#include "include/BookImporter.h"
 #include <QVBoxLayout>
 #include <QPushButton>
 #include <QStackedWidget>
@@ -57,16 +58,14 @@ Widget::Widget(QWidget *parent)
     // 加载用户数据
     loadUserData();
     
-    // 加载图书和借阅记录数据
-    loadBookAndBorrowData();
+    // 加载图书和借阅记录数据（含等待队列和借阅日志）
+    loadAllData();
     
     // 设置UI
     setupCustomUi();
     
     // 默认显示借阅图书页面（无需登录）
     switchToPage(BORROW_BOOK_PAGE);
-    
-    loadAllData(); // 自动加载所有持久化数据
 }
 
 Widget::~Widget()
@@ -74,14 +73,12 @@ Widget::~Widget()
     // 保存用户数据
     saveUserData();
     
-    // 保存图书和借阅记录数据
-    saveBookAndBorrowData();
+    // 保存图书、借阅记录和等待队列，须在释放 borrowManager 之前
+    saveAllData();
     
     delete borrowManager;
     delete permissionManager;
     delete ui;
-    
-    saveAllData(); // 自动保存所有持久化数据
 }
 
 //设置UI
@@ -476,6 +473,10 @@ void Widget::setupCustomUi()
 
     setupSearchHistoryPopup();
     historyPopup->hide();
+    // 输入停顿后再查补全，连续输入时不逐字查询
+    inputTimer = new QTimer(this);
+    inputTimer->setSingleShot(true);
+    inputTimer->setInterval(150);
 
     // 表格
     QTableWidget *borrowPage_table = new QTableWidget(borrowPage_widget);
@@ -704,17 +705,24 @@ void Widget::setupCustomUi()
 
     // 借阅图书信号槽
     connect(borrowPage_searchBtn, &QPushButton::clicked, this, [=]{ //搜索按钮
+        inputTimer->stop();
         searchHistory.push(borrowPage_searchEdit->text());
         updateSearchHistory();
         currentBorrowPage = 1;
         refreshBorrowPageTable(borrowPage_table, borrowPageFieldCombo->currentIndex(), borrowPage_searchEdit->text(), currentBorrowPage, cmbPageSize->currentText().toInt());
     });
     connect(borrowPage_searchEdit, &QLineEdit::returnPressed, this, [=]{ //搜索框
+        inputTimer->stop();
         searchHistory.push(borrowPage_searchEdit->text());
         updateSearchHistory();
         currentBorrowPage = 1;
         refreshBorrowPageTable(borrowPage_table, borrowPageFieldCombo->currentIndex(), borrowPage_searchEdit->text(), currentBorrowPage, cmbPageSize->currentText().toInt());
     });
+    // 输入时按所选字段给出补全建议
+    connect(borrowPage_searchEdit, &QLineEdit::textEdited, this, [=]{ inputTimer->start(); });
+    connect(inputTimer, &QTimer::timeout, this, [=]{
+        showSearchSuggestions(borrowPageFieldCombo->currentIndex());
+    });
     // 搜索框聚焦时显示历史
     connect(qApp, &QApplication::focusChanged, this, &Widget::onFocusChanged);
 
@@ -1449,8 +1457,12 @@ void Widget::updateLoginStatus()
 void Widget::saveUserData()
 {
     try {
-        QString userDataPath = QCoreApplication::applicationDirPath() + "/users.json";
-        userManager.saveToFile(userDataPath.toStdString());
+        QString userDataPath = dataFilePath("users");
+        if (userDataPath.endsWith(".bin")) {
+            userManager.saveToBinaryFile(QFile::encodeName(userDataPath).toStdString());
+        } else {
+            userManager.saveToFile(userDataPath.toStdString());
+        }
     } catch (const std::exception &e) {
         qDebug() << "保存用户数据失败:" << e.what();
     }
@@ -1460,8 +1472,12 @@ void Widget::saveUserData()
 void Widget::loadUserData()
 {
     try {
-        QString userDataPath = QCoreApplication::applicationDirPath() + "/users.json";
-        userManager.loadFromFile(userDataPath.toStdString());
+        QString userDataPath = dataFilePath("users");
+        if (userDataPath.endsWith(".bin")) {
+            userManager.loadFromBinaryFile(QFile::encodeName(userDataPath).toStdString());
+        } else {
+            userManager.loadFromFile(userDataPath.toStdString());
+        }
     } catch (const std::exception &e) {
         qDebug() << "加载用户数据失败:" << e.what();
     }
@@ -1472,11 +1488,11 @@ bool Widget::loginUser(const QString &username, const QString &password)
 {
     if (username.isEmpty() || password.isEmpty()) return false;
     
-    const User* user = userManager.findUser(username.toStdString());
-    if (user && user->password == password.toStdString()) {
+    User user;
+    if (userManager.getUser(username.toStdString(), user) && user.password == password.toStdString()) {
         isLoggedIn = true;
         currentUser = username;
-        currentUserRole = user->role;
+        currentUserRole = user.role;
         updateLoginStatus();
         return true;
     }
@@ -1489,7 +1505,7 @@ bool Widget::registerUser(const QString &username, const QString &password, Role
     if (username.isEmpty() || password.isEmpty()) return false;
     
     // 检查用户名是否已存在
-    if (userManager.findUser(username.toStdString())) {
+    if (userManager.hasUser(username.toStdString())) {
         return false;
     }
     
@@ -1522,7 +1538,8 @@ void Widget::logoutUser()
 void Widget::refreshBookTable(QTableWidget *table)
 {
     table->setRowCount(0);
-    const auto &books = bookManager.getAllBooks();
+    const CatalogSnapshot snapshot = bookManager.snapshot();
+    const auto &books = snapshot.getBooks();
     for (size_t i = 0; i < books.getSize(); ++i) {
         table->insertRow(i);
         table->setItem(i, 0, new QTableWidgetItem(QString::fromStdString(books[i].getIsbn())));
@@ -1533,6 +1550,41 @@ void Widget::refreshBookTable(QTableWidget *table)
     }
 }
 
+// 搜索框的字段下拉（ISBN、书名、作者、出版社、出版年份）与关键字组成查询条件，关键字为空时匹配全部
+static QueryCondition keywordCondition(int fieldIndex, const QString &keyword)
+{
+    QString key = keyword.trimmed();
+    if (key.isEmpty()) {
+        return QueryCondition();
+    }
+    std::string keyStr = key.toStdString();
+    switch (fieldIndex) {
+    case 0: return QueryCondition::equals(QueryCondition::Field::ISBN, keyStr);
+    case 1: return QueryCondition::contains(QueryCondition::Field::TITLE, keyStr);
+    case 2: return QueryCondition::contains(QueryCondition::Field::AUTHOR, keyStr);
+    case 3: return QueryCondition::contains(QueryCondition::Field::PUBLISHER, keyStr);
+    default: {
+        bool ok = false;
+        int year = key.toInt(&ok);
+        // 年份无法解析时用空区间，不匹配任何图书
+        return ok ? QueryCondition::yearBetween(year, year) : QueryCondition::yearBetween(1, 0);
+    }
+    }
+}
+
+// 表格列号对应的排序字段
+static SortBy columnSortBy(int column)
+{
+    switch (column) {
+    case 0: return SortBy::ISBN;
+    case 1: return SortBy::TITLE;
+    case 2: return SortBy::AUTHOR;
+    case 3: return SortBy::PUBLISHER;
+    case 4: return SortBy::YEAR;
+    default: return SortBy::TITLE;
+    }
+}
+
 //按查询排序结果刷新页面
 void Widget::refreshBookTable(QTableWidget *table, int fieldIndex, const QString &keyword)
 {
@@ -1540,64 +1592,23 @@ void Widget::refreshBookTable(QTableWidget *table, int fieldIndex, const QString
     bookTableLastFieldIndex = fieldIndex;
     bookTableLastKeyword = keyword;
     table->setRowCount(0);
-    MyVector<Book> result;
-    //按字段调用查询函数
-    QString key = keyword.trimmed();
-    if (key.isEmpty()) {
-        result = bookManager.getAllBooks();
-    } else {
-        std::string keyStr = key.toStdString();
-        switch (fieldIndex) {
-        case 0: //ISBN
-            {
-                Book* pBook = bookManager.findBookByIsbn(keyStr);
-                if (pBook) {
-                    result.add(*pBook); // 传递 Book 对象引用
-                }
-            }
-            break;
-        case 1: //书名
-            result = bookManager.findBooksByTitle(keyStr);
-            break;
-        case 2: // 作者
-            result = bookManager.findBooksByAuthor(keyStr);
-            break;
-        case 3: // 出版社
-            result = bookManager.findBooksByPublisher(keyStr);
-            break;
-        case 4: // 出版年份
-            {
-                bool ok = false;
-                int year = key.toInt(&ok);
-                if (ok) {
-                    result = bookManager.findBooksByYear(year);
-                }
-            }
-            break;
-        }
-    }
-    // 集成排序逻辑
+    // 条件和排序交给查询引擎，只取回下标，行内容从同一版本的视图中读取，不复制图书
+    BookQuery query(keywordCondition(fieldIndex, keyword));
     if (bookTableSortState.lastSortedColumn >= 0 && bookTableSortState.lastSortedColumn < 5) {
-        SortBy sortBy;
-        switch (bookTableSortState.lastSortedColumn) {
-        case 0: sortBy = SortBy::ISBN; break;
-        case 1: sortBy = SortBy::TITLE; break;
-        case 2: sortBy = SortBy::AUTHOR; break;
-        case 3: sortBy = SortBy::PUBLISHER; break;
-        case 4: sortBy = SortBy::YEAR; break;
-        default: sortBy = SortBy::TITLE; break;
-        }
         SortOrder order = bookTableSortState.ascending ? SortOrder::ASCENDING : SortOrder::DESCENDING;
-        result = bookManager.sortSearchResults(result, sortBy, order);
+        query.orderBy(columnSortBy(bookTableSortState.lastSortedColumn), order);
     }
+    CatalogSnapshot snapshot;
+    MyVector<uint32_t> ids = bookManager.queryIds(query, &snapshot);
     //展示
-    for (size_t i = 0; i < result.getSize(); ++i) {
+    for (size_t i = 0; i < ids.getSize(); ++i) {
+        const Book &book = snapshot.getBookAt(ids[i]);
         table->insertRow(i);
-        table->setItem(i, 0, new QTableWidgetItem(QString::fromStdString(result[i].getIsbn())));
-        table->setItem(i, 1, new QTableWidgetItem(QString::fromStdString(result[i].getTitle())));
-        table->setItem(i, 2, new QTableWidgetItem(QString::fromStdString(result[i].getAuthor())));
-        table->setItem(i, 3, new QTableWidgetItem(QString::fromStdString(result[i].getPublisher())));
-        table->setItem(i, 4, new QTableWidgetItem(QString::number(result[i].getPublishYear())));
+        table->setItem(i, 0, new QTableWidgetItem(QString::fromStdString(book.getIsbn())));
+        table->setItem(i, 1, new QTableWidgetItem(QString::fromStdString(book.getTitle())));
+        table->setItem(i, 2, new QTableWidgetItem(QString::fromStdString(book.getAuthor())));
+        table->setItem(i, 3, new QTableWidgetItem(QString::fromStdString(book.getPublisher())));
+        table->setItem(i, 4, new QTableWidgetItem(QString::number(book.getPublishYear())));
     }
 }
 
@@ -1641,12 +1652,7 @@ void Widget::onAddBook(QTableWidget *table)
             Book book(isbn.toStdString(), title.toStdString(), author.toStdString(), publisher.toStdString(), year);
             bookManager.addBook(book);
             // 立即保存图书数据到文件，确保数据同步
-            QString bookDataPath = QCoreApplication::applicationDirPath() + "/books.json";
-            if (bookManager.saveToFile(bookDataPath)) {
-                qDebug() << "图书数据已保存到文件:" << bookDataPath;
-            } else {
-                qDebug() << "图书数据保存失败:" << bookDataPath;
-            }
+            saveBookData();
             refreshBookTable(table);
         } catch (const std::exception &e) {
             QMessageBox::warning(this, "添加失败", e.what());
@@ -1706,12 +1712,7 @@ void Widget::onEditBook(QTableWidget *table)
                 return;
             }
             // 立即保存图书数据到文件，确保数据同步
-            QString bookDataPath = QCoreApplication::applicationDirPath() + "/books.json";
-            if (bookManager.saveToFile(bookDataPath)) {
-                qDebug() << "图书数据已保存到文件:" << bookDataPath;
-            } else {
-                qDebug() << "图书数据保存失败:" << bookDataPath;
-            }
+            saveBookData();
             refreshBookTable(table);
         } catch (const std::exception &e) {
             QMessageBox::warning(this, "修改失败", e.what());
@@ -1734,12 +1735,7 @@ void Widget::onDeleteBook(QTableWidget *table)
             return;
         }
         // 立即保存图书数据到文件，确保数据同步
-        QString bookDataPath = QCoreApplication::applicationDirPath() + "/books.json";
-        if (bookManager.saveToFile(bookDataPath)) {
-            qDebug() << "图书数据已保存到文件:" << bookDataPath;
-        } else {
-            qDebug() << "图书数据保存失败:" << bookDataPath;
-        }
+        saveBookData();
         refreshBookTable(table);
     }
 }
@@ -1759,6 +1755,7 @@ void Widget::refreshBorrowTable(QTableWidget *table)
     MyVector<BorrowRecord> records;
     if (hasPermission(ADMIN)) {
         // 管理员可以看到所有记录
+        auto lock = borrowManager->readLock();
         records = borrowManager->getAllBorrowRecords();
     } else {
         // 普通用户只能看到自己的记录
@@ -1794,6 +1791,7 @@ void Widget::refreshBorrowTable(QTableWidget *table, int fieldIndex, const QStri
     MyVector<BorrowRecord> records;
     if (hasPermission(ADMIN)) {
         // 管理员可以看到所有记录
+        auto lock = borrowManager->readLock();
         records = borrowManager->getAllBorrowRecords();
     } else {
         // 普通用户只能看到自己的记录
@@ -1809,8 +1807,10 @@ void Widget::refreshBorrowTable(QTableWidget *table, int fieldIndex, const QStri
         switch (fieldIndex) {
         case 0: //记录ID
         {
-            BorrowRecord *borrowRecord = borrowManager->findByRecordId(records,keyStr);
-            if (borrowRecord) {
+            // 按编号直接查管理器的索引；普通用户只能查到自己的记录
+            auto lock = borrowManager->readLock();
+            const BorrowRecord *borrowRecord = borrowManager->findRecordById(BorrowRecord::parseRecordId(keyStr));
+            if (borrowRecord && (hasPermission(ADMIN) || borrowRecord->getUsername() == currentUser.toStdString())) {
                 result.add(*borrowRecord);
             }
         }
@@ -1872,7 +1872,8 @@ void Widget::onBorrowBook(QTableWidget *table)
     dialog.setWindowTitle("借书");
     QFormLayout form(&dialog);
     QComboBox *bookCombo = new QComboBox(&dialog);
-    const auto &books = bookManager.getAllBooks();
+    const CatalogSnapshot snapshot = bookManager.snapshot();
+    const auto &books = snapshot.getBooks();
     for (size_t i = 0; i < books.getSize(); ++i) {
         QString bookInfo = QString("%1 - %2").arg(QString::fromStdString(books[i].getIsbn())).arg(QString::fromStdString(books[i].getTitle()));
         bookCombo->addItem(bookInfo, QString::fromStdString(books[i].getIsbn()));
@@ -1885,11 +1886,13 @@ void Widget::onBorrowBook(QTableWidget *table)
     if (dialog.exec() == QDialog::Accepted) {
         QString isbn = bookCombo->currentData().toString();
         try {
-            borrowManager->borrowBook(isbn.toStdString(), currentUser.toStdString());
-            borrowManager->saveToFile("borrow_records.json");
-            borrowManager->saveWaitingQueues("waiting_queues.json");
+            bool saved = borrowManager->borrowBook(isbn.toStdString(), currentUser.toStdString());
             refreshBorrowTable(table);
-            QMessageBox::information(this, "借书成功", "图书借阅成功！");
+            if (saved) {
+                QMessageBox::information(this, "借书成功", "图书借阅成功！");
+            } else {
+                QMessageBox::warning(this, "借书失败", "借阅记录保存失败");
+            }
         } catch (const std::exception &e) {
             QMessageBox::information(this, "借书提示", e.what());
         }
@@ -1912,11 +1915,9 @@ void Widget::onReturnBook(QTableWidget *table)
         QMessageBox::warning(this, "权限不足", "您只能归还自己的借阅记录。");
         return;
     }
-    QString recordId = table->item(row, 0)->text();
+    int recordId = BorrowRecord::parseRecordId(table->item(row, 0)->text().toStdString());
     try {
-        bool ok = borrowManager->returnBookByRecordId(recordId.toStdString());
-        borrowManager->saveToFile("borrow_records.json");
-        borrowManager->saveWaitingQueues("waiting_queues.json");
+        bool ok = borrowManager->returnBookByRecordId(recordId);
         refreshBorrowTable(table);
         if (ok) {
             QMessageBox::information(this, "还书成功", "图书归还成功！");
@@ -1948,16 +1949,9 @@ void Widget::onRenewBook(QTableWidget *table)
         return;
     }
     
-    int recordId = table->item(row, 0)->text().toInt();
+    int recordId = BorrowRecord::parseRecordId(table->item(row, 0)->text().toStdString());
     try {
-        borrowManager->renewBook(recordId);
-        // 立即保存借阅记录到文件，确保数据同步
-        QString borrowDataPath = QCoreApplication::applicationDirPath() + "/borrow_records.json";
-        if (borrowManager->saveToFile(borrowDataPath)) {
-            qDebug() << "借阅记录已保存到文件:" << borrowDataPath;
-        } else {
-            qDebug() << "借阅记录保存失败:" << borrowDataPath;
-        }
+        borrowManager->renewBook(recordId); // 变动已由借阅日志落盘
         refreshBorrowTable(table);
         QMessageBox::information(this, "续借成功", "图书续借成功！");
     } catch (const std::exception &e) {
@@ -1969,6 +1963,7 @@ void Widget::onRenewBook(QTableWidget *table)
 void Widget::refreshUserTable(QTableWidget *table)
 {
     table->setRowCount(0);
+    auto lock = userManager.readLock();
     const auto &users = userManager.getAllUsers();
     for (size_t i = 0; i < users.getSize(); ++i) {
         table->insertRow(i);
@@ -1981,7 +1976,8 @@ void Widget::refreshUserTable(QTableWidget *table)
 void Widget::refreshUserTable(QTableWidget *table, const QString &keyword)
 {
     table->setRowCount(0);
-    MyVector<User> searchUserResult = keyword.isEmpty()? userManager.getAllUsers(): userManager.fuzzyFindUsers(keyword.toStdString());
+    // 关键字为空时匹配全部用户
+    MyVector<User> searchUserResult = userManager.fuzzyFindUsers(keyword.toStdString());
     for (size_t i = 0; i < searchUserResult.getSize(); ++i) {
         table->insertRow(i);
         table->setItem(i, 0, new QTableWidgetItem(QString::fromStdString(searchUserResult[i].username)));
@@ -2022,7 +2018,7 @@ void Widget::onAddUser(QTableWidget *table)
             QMessageBox::warning(this, "输入错误", "用户名和密码不能为空！");
             return;
         }
-        if (userManager.findUser(username.toStdString())) {
+        if (userManager.hasUser(username.toStdString())) {
             QMessageBox::warning(this, "添加失败", "用户名已存在！");
             return;
         }
@@ -2051,8 +2047,8 @@ void Widget::onEditUser(QTableWidget *table)
         return;
     }
     QString oldUsername = table->item(row, 0)->text();
-    const User* userPtr = userManager.findUser(oldUsername.toStdString());
-    if (!userPtr) {
+    User oldUser;
+    if (!userManager.getUser(oldUsername.toStdString(), oldUser)) {
         QMessageBox::warning(this, "未找到", "未找到该用户，可能已被删除。");
         return;
     }
@@ -2060,13 +2056,13 @@ void Widget::onEditUser(QTableWidget *table)
     dialog.setWindowTitle("修改用户");
     QFormLayout form(&dialog);
     QLineEdit *usernameEdit = new QLineEdit(oldUsername, &dialog);
-    QLineEdit *passwordEdit = new QLineEdit(QString::fromStdString(userPtr->password), &dialog);
+    QLineEdit *passwordEdit = new QLineEdit(QString::fromStdString(oldUser.password), &dialog);
     passwordEdit->setEchoMode(QLineEdit::Password);
     //qcombobox 下拉框
     QComboBox *roleCombo = new QComboBox(&dialog);
     roleCombo->addItem("普通用户", USER);
     roleCombo->addItem("管理员", ADMIN);
-    roleCombo->setCurrentIndex(userPtr->role == ADMIN ? 1 : 0);
+    roleCombo->setCurrentIndex(oldUser.role == ADMIN ? 1 : 0);
     form.addRow("用户名:", usernameEdit);
     form.addRow("密码:", passwordEdit);
     form.addRow("角色:", roleCombo);
@@ -2083,7 +2079,7 @@ void Widget::onEditUser(QTableWidget *table)
             return;
         }
         // 用户名变更且新用户名已存在
-        if (username != oldUsername && userManager.findUser(username.toStdString())) {
+        if (username != oldUsername && userManager.hasUser(username.toStdString())) {
             QMessageBox::warning(this, "修改失败", "新用户名已存在！");
             return;
         }
@@ -2139,22 +2135,26 @@ void Widget::onImportBooks(QTableWidget *table)
     QString fileName = QFileDialog::getOpenFileName(this, "选择书籍文件", "", "Text Files (*.txt);;All Files (*)");
     if (fileName.isEmpty()) return;
 
-    QFile file(fileName);
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    if (!QFile::exists(fileName)) {
         QMessageBox::warning(this, "打开失败", "无法打开文件！");
         return;
     }
 
-    // 统计总行数
-    int totalLines = 0;
-    while (!file.atEnd()) {
-        file.readLine();
-        ++totalLines;
+    // 选择 ISBN 重复时的处理方式
+    const QStringList policyNames = {"跳过重复图书", "覆盖重复图书", "只补全重复图书的空字段"};
+    bool policyChosen = false;
+    QString policyName = QInputDialog::getItem(this, "重复图书", "ISBN 已存在时：", policyNames, 0, false, &policyChosen);
+    if (!policyChosen) return;
+    DuplicatePolicy policy = DuplicatePolicy::SKIP;
+    if (policyName == policyNames[1]) {
+        policy = DuplicatePolicy::OVERWRITE;
+    } else if (policyName == policyNames[2]) {
+        policy = DuplicatePolicy::MERGE;
     }
-    //重置文件指针
-    file.seek(0);
 
-    QProgressDialog *progress = new QProgressDialog("正在导入书籍...", "取消", 0, totalLines, this);
+    // 进度按已解析字节的千分比显示，不需要预先数行
+    static constexpr int PROGRESS_MAX = 1000;
+    QProgressDialog *progress = new QProgressDialog("正在导入书籍...", "取消", 0, PROGRESS_MAX, this);
     progress->setWindowModality(Qt::WindowModal);
     progress->setMinimumDuration(0);
     progress->setValue(0);
@@ -2163,67 +2163,44 @@ void Widget::onImportBooks(QTableWidget *table)
     QFutureWatcher<int> *watcher = new QFutureWatcher<int>(this);
     connect(progress, &QProgressDialog::canceled, watcher, &QFutureWatcher<int>::cancel);
 
-    auto importTask = [fileName, totalLines, this, progress, watcher]() -> int {
-        QFile file(fileName);
-        if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) return 0;
-        // 创建文本流
-        QTextStream in(&file);
-        int count = 0;
-        // 计算进度步长
-        //qmax 返回a和b中的较大值
-        int progressStep = qMax(1, totalLines / 1000);
-        while (!in.atEnd()) {
-            if (watcher->isCanceled()) break;
-            // 读取一行并去除空格
-            QString line = in.readLine().trimmed();
-            if (line.isEmpty()) continue;
-            QString jsonStr = line;
-            // 替换单引号为双引号
-            jsonStr.replace("'", "\"");
-            QJsonParseError err;
-            QJsonDocument doc = QJsonDocument::fromJson(jsonStr.toUtf8(), &err);
-            if (err.error != QJsonParseError::NoError || !doc.isObject()) continue;
-            QJsonObject obj = doc.object();
-            QString isbn = obj.value("ISBN").toString();
-            QString title = obj.value("书名").toString();
-            QString author = obj.value("作者").toString();
-            QString publisher = obj.value("出版社").toString();
-            int year = obj.value("出版年限").toInt();
-            if (isbn.isEmpty() || title.isEmpty() || author.isEmpty() || publisher.isEmpty() || year == 0) continue;
-            try {
-                Book book(isbn.toStdString(), title.toStdString(), author.toStdString(), publisher.toStdString(), year);
-                bookManager.addBookNoRebuild(book);
-            } catch (const std::exception &e) {
-                // 重复或异常跳过
-                qDebug() << "导入书籍失败:" << e.what();
-            }
-            ++count;
-            //判断是否需要更新进度条
-            if (count % progressStep == 0) {
-                // 使用Qt的信号槽机制更新进度条
-                QMetaObject::invokeMethod(progress, "setValue", Qt::QueuedConnection, Q_ARG(int, count));
-            }
-        }
-        // 重建图书哈希表
-        bookManager.rebuildBookHashTable();
-        // 更新进度条
-        QMetaObject::invokeMethod(progress, "setValue", Qt::QueuedConnection, Q_ARG(int, totalLines));
-        return count;
+    // 解析在后台多线程完成，结果在界面线程一次性并入图书管理器
+    std::shared_ptr<MyVector<Book>> imported = std::make_shared<MyVector<Book>>();
+    std::string path = QFile::encodeName(fileName).toStdString();
+    auto importTask = [path, imported, progress, watcher]() -> int {
+        BookImporter::Stats stats;
+        auto onProgress = [progress, watcher](size_t doneBytes, size_t totalBytes) {
+            int value = static_cast<int>(doneBytes * PROGRESS_MAX / (totalBytes > 0 ? totalBytes : 1));
+            // 使用Qt的信号槽机制更新进度条
+            QMetaObject::invokeMethod(progress, "setValue", Qt::QueuedConnection, Q_ARG(int, value));
+            return !watcher->isCanceled();
+        };
+        if (!BookImporter::parseFile(path, *imported, stats, 0, onProgress)) {
+            imported->clear();
+            return 0;
+        }
+        QMetaObject::invokeMethod(progress, "setValue", Qt::QueuedConnection, Q_ARG(int, PROGRESS_MAX));
+        return static_cast<int>(stats.bookCount);
     };
 
     // 连接信号槽
     // 导入完成后立即保存图书数据到文件，确保数据同步
     connect(watcher, &QFutureWatcher<int>::finished, this,[=]{
         progress->close();
-        QString bookDataPath = QCoreApplication::applicationDirPath() + "/books.json";
-        if (bookManager.saveToFile(bookDataPath)) {
-            qDebug() << "导入后图书数据已保存到文件:" << bookDataPath;
-        } else {
-            qDebug() << "导入后图书数据保存失败:" << bookDataPath;
+        ImportReport report = bookManager.importBooks(std::move(*imported), policy);
+        if (report.added > 0 || report.overwritten > 0 || report.merged > 0) {
+            saveBookData();
         }
         // 刷新图书表
         refreshBookTable(table);
-        QMessageBox::information(this, "导入完成", QString("成功导入%1条书籍信息。\n(如有重复或异常已自动跳过)").arg(watcher->result()));
+        QMessageBox::information(this, "导入完成",
+                                 QString("解析%1条书籍信息，新增%2条。\n重复%3条：跳过%4条，覆盖%5条，补全%6条，无变化%7条。\n(格式错误的行已自动跳过)")
+                                     .arg(watcher->result())
+                                     .arg(report.added)
+                                     .arg(report.duplicates())
+                                     .arg(report.skipped)
+                                     .arg(report.overwritten)
+                                     .arg(report.merged)
+                                     .arg(report.unchanged));
         watcher->deleteLater();
         progress->deleteLater();
     });
@@ -2255,8 +2232,15 @@ void Widget::refreshBorrowPageTable(QTableWidget *table, int pageNum, int pageSi
     table->setUpdatesEnabled(false);      // 禁用刷新，提升性能
     table->blockSignals(true);            // 禁用信号，防止多余触发
 
-    // 应用当前排序状态
-    MyVector<Book> sortedBooks;
+    // 应用当前排序状态：排序结果由 BookManager 按列缓存，这里只取当前页
+    // 各行从同一版本的视图中读取，刷新期间其他修改不影响本页
+    CatalogSnapshot snapshot = bookManager.snapshot();
+    int totalItems = static_cast<int>(snapshot.getBookCount()); //总数
+    int startIndex = std::max((pageNum - 1) * pageSize, 0);
+    int endIndex = std::min(startIndex + pageSize, totalItems);
+    int rowCount = std::max(endIndex - startIndex, 0);
+    MyVector<uint32_t> pageIndices;
+    bool sorted = false;
     if (borrowPageTableSortState.lastSortedColumn >= 0 && borrowPageTableSortState.lastSortedColumn < 5) {
         // 有排序状态，应用排序
         SortBy sortBy;
@@ -2269,26 +2253,18 @@ void Widget::refreshBorrowPageTable(QTableWidget *table, int pageNum, int pageSi
         default: sortBy = SortBy::TITLE; break;
         }
         SortOrder order = borrowPageTableSortState.ascending ? SortOrder::ASCENDING : SortOrder::DESCENDING;
-        sortedBooks = bookManager.getSortedBooks(sortBy, order);
-    } else {
-        // 没有排序状态，使用原始顺序
-        sortedBooks = bookManager.getAllBooks();
+        pageIndices = bookManager.getSortedPageIndices(sortBy, order, startIndex, rowCount, &snapshot);
+        sorted = true;
     }
+    // 没有排序状态时直接使用原始顺序
 
-    //分页
-    MyVector<Book> pagedResult;
-    int totalItems = static_cast<int>(sortedBooks.getSize()); //总数
-    int startIndex = (pageNum - 1) * pageSize;
-    int endIndex = std::min(startIndex + pageSize, totalItems);
-
-    for (int i = startIndex; i < endIndex; ++i) {
-        pagedResult.add(sortedBooks[i]);
-    }
-    int rowCount = static_cast<int>(pagedResult.getSize());
     table->clearContents();
     table->setRowCount(rowCount);         // 一次性设置行数
     for (int i = 0; i < rowCount; ++i) {
-        const Book &book = pagedResult[i];
+        // 排序时视图换成了与下标对应的版本，行数可能比开始时少
+        if (sorted && static_cast<size_t>(i) >= pageIndices.getSize()) break;
+        uint32_t bookIndex = sorted ? pageIndices[i] : static_cast<uint32_t>(startIndex + i);
+        const Book &book = snapshot.getBookAt(bookIndex);
         QString isbn = QString::fromStdString(book.getIsbn());
         QString title = QString::fromStdString(book.getTitle());
         QString author = QString::fromStdString(book.getAuthor());
@@ -2324,71 +2300,26 @@ void Widget::refreshBorrowPageTable(QTableWidget *table, int fieldIndex, const Q
     table->blockSignals(true);
 
     table->clearContents();
-    //按字段查询
-    MyVector<Book> result;
-    QString key = keyword.trimmed();
-    if (key.isEmpty()) {
-        result = bookManager.getAllBooks();
-    } else {
-        std::string keyStr = key.toStdString();
-        switch (fieldIndex) {
-        case 0: {
-            Book* pBook = bookManager.findBookByIsbn(keyStr);
-            if (pBook) result.add(*pBook);
-            break;
-        }
-        case 1:
-            result = bookManager.findBooksByTitle(keyStr);
-            break;
-        case 2:
-            result = bookManager.findBooksByAuthor(keyStr);
-            break;
-        case 3:
-            result = bookManager.findBooksByPublisher(keyStr);
-            break;
-        case 4: {
-            bool ok = false;
-            int year = key.toInt(&ok);
-            if (ok) result = bookManager.findBooksByYear(year);
-            break;
-        }
-        }
-    }
-
-    // 应用当前排序状态到搜索结果
-    MyVector<Book> sortedResult;
+    // 查询结果由 BookManager 按 (条件, 排序) 缓存，翻页和改每页条数只取当前页的下标
+    BookQuery query(keywordCondition(fieldIndex, keyword));
     if (borrowPageTableSortState.lastSortedColumn >= 0 && borrowPageTableSortState.lastSortedColumn < 5) {
-        // 有排序状态，应用排序到搜索结果
-        SortBy sortBy;
-        switch (borrowPageTableSortState.lastSortedColumn) {
-        case 0: sortBy = SortBy::ISBN; break;       // ISBN列
-        case 1: sortBy = SortBy::TITLE; break;      // 书名列
-        case 2: sortBy = SortBy::AUTHOR; break;     // 作者列
-        case 3: sortBy = SortBy::PUBLISHER; break;  // 出版社列
-        case 4: sortBy = SortBy::YEAR; break;       // 出版年份列
-        default: sortBy = SortBy::TITLE; break;
-        }
         SortOrder order = borrowPageTableSortState.ascending ? SortOrder::ASCENDING : SortOrder::DESCENDING;
-        sortedResult = bookManager.sortSearchResults(result, sortBy, order);
-    } else {
-        // 没有排序状态，使用原始搜索结果
-        sortedResult = result;
+        query.orderBy(columnSortBy(borrowPageTableSortState.lastSortedColumn), order);
     }
+    // 没有排序状态时按原始顺序
 
     //分页展示
-    MyVector<Book> pagedResult;
-    int totalItems = static_cast<int>(sortedResult.getSize());
-    int startIndex = (pageNum - 1) * pageSize;
-    int endIndex = std::min(startIndex + pageSize, totalItems);
-
-    for (int i = startIndex; i < endIndex; ++i) {
-        pagedResult.add(sortedResult[i]);
-    }
+    CatalogSnapshot snapshot;
+    size_t total = 0;
+    size_t pageLength = pageSize > 0 ? static_cast<size_t>(pageSize) : 0;
+    size_t startIndex = pageNum > 1 ? static_cast<size_t>(pageNum - 1) * pageLength : 0;
+    MyVector<uint32_t> pageIds = bookManager.getQueryPage(query, startIndex, pageLength, total, &snapshot);
+    int totalItems = static_cast<int>(total);
 
-    table->setRowCount(static_cast<int>(pagedResult.getSize())); // 2. 直接设置行数
+    table->setRowCount(static_cast<int>(pageIds.getSize())); // 2. 直接设置行数
 
-    for (size_t i = 0; i < pagedResult.getSize(); ++i) {
-        const Book &book = pagedResult[i];
+    for (size_t i = 0; i < pageIds.getSize(); ++i) {
+        const Book &book = snapshot.getBookAt(pageIds[i]);
         QString isbn = QString::fromStdString(book.getIsbn());
         QString title = QString::fromStdString(book.getTitle());
         QString author = QString::fromStdString(book.getAuthor());
@@ -2427,13 +2358,7 @@ void Widget::handleBorrowPageBorrowClicked(const QString &isbn, const QString &t
     try {
         bool success = borrowManager->borrowBook(isbn.toStdString(), currentUser.toStdString());
         if (success) {
-            // 立即保存借阅记录到文件，确保数据同步
-            QString borrowDataPath = QCoreApplication::applicationDirPath() + "/borrow_records.json";
-            if (borrowManager->saveToFile(borrowDataPath)) {
-                qDebug() << "借阅记录已保存到文件:" << borrowDataPath;
-            } else {
-                qDebug() << "借阅记录保存失败:" << borrowDataPath;
-            }
+            // 借阅记录已由借阅日志落盘，无需整体重写
             QMessageBox::information(this, "借阅成功", QString("成功借阅《%1》！").arg(title));
         } else {
             QMessageBox::warning(this, "借阅失败", "借阅失败，可能已借阅或库存不足。");
@@ -2443,22 +2368,44 @@ void Widget::handleBorrowPageBorrowClicked(const QString &isbn, const QString &t
     }
 }
 
+QString Widget::dataFilePath(const QString &baseName) const
+{
+    QString basePath = QCoreApplication::applicationDirPath() + "/" + baseName;
+    return QFile::exists(basePath + ".bin") ? basePath + ".bin" : basePath + ".json";
+}
+
+// 保存图书数据，按文件后缀选择 JSON 或二进制快照
+bool Widget::saveBookData()
+{
+    QString bookDataPath = dataFilePath("books");
+    bool saved = bookDataPath.endsWith(".bin")
+                     ? bookManager.saveToBinaryFile(QFile::encodeName(bookDataPath).toStdString())
+                     : bookManager.saveToFile(bookDataPath);
+    if (saved) {
+        qDebug() << "图书数据已保存到文件:" << bookDataPath;
+    } else {
+        qDebug() << "图书数据保存失败:" << bookDataPath;
+    }
+    return saved;
+}
+
 // 保存图书和借阅记录数据
 void Widget::saveBookAndBorrowData()
 {
     try {
-        QString bookDataPath = QCoreApplication::applicationDirPath() + "/books.json";
-        QString borrowDataPath = QCoreApplication::applicationDirPath() + "/borrow_records.json";
+        QString borrowDataPath = dataFilePath("borrow_records");
         
         // 保存图书数据
-        if (bookManager.saveToFile(bookDataPath)) {
-            qDebug() << "图书数据保存成功:" << bookDataPath;
-        } else {
-            qDebug() << "图书数据保存失败:" << bookDataPath;
-        }
+        saveBookData();
         
-        // 保存借阅记录数据
-        if (borrowManager->saveToFile(borrowDataPath)) {
+        // 保存借阅记录数据：写出快照并清空借阅日志
+        bool borrowSaved = borrowManager->compact();
+        if (!borrowSaved) {
+            borrowSaved = borrowDataPath.endsWith(".bin")
+                              ? borrowManager->saveToBinaryFile(QFile::encodeName(borrowDataPath).toStdString())
+                              : borrowManager->saveToFile(borrowDataPath);
+        }
+        if (borrowSaved) {
             qDebug() << "借阅记录数据保存成功:" << borrowDataPath;
         } else {
             qDebug() << "借阅记录数据保存失败:" << borrowDataPath;
@@ -2472,12 +2419,15 @@ void Widget::saveBookAndBorrowData()
 void Widget::loadBookAndBorrowData()
 {
     try {
-        QString bookDataPath = QCoreApplication::applicationDirPath() + "/books.json";
-        QString borrowDataPath = QCoreApplication::applicationDirPath() + "/borrow_records.json";
+        QString bookDataPath = dataFilePath("books");
+        QString borrowDataPath = dataFilePath("borrow_records");
         
         // 加载图书数据
         if (QFile::exists(bookDataPath)) {
-            if (bookManager.loadFromFile(bookDataPath)) {
+            bool loaded = bookDataPath.endsWith(".bin")
+                              ? bookManager.loadFromBinaryFile(QFile::encodeName(bookDataPath).toStdString())
+                              : bookManager.loadFromFile(bookDataPath);
+            if (loaded) {
                 qDebug() << "图书数据加载成功:" << bookDataPath;
             } else {
                 qDebug() << "图书数据加载失败:" << bookDataPath;
@@ -2486,15 +2436,13 @@ void Widget::loadBookAndBorrowData()
             qDebug() << "图书数据文件不存在，将创建新文件:" << bookDataPath;
         }
         
-        // 加载借阅记录数据
-        if (QFile::exists(borrowDataPath)) {
-            if (borrowManager->loadFromFile(borrowDataPath)) {
-                qDebug() << "借阅记录数据加载成功:" << borrowDataPath;
-            } else {
-                qDebug() << "借阅记录数据加载失败:" << borrowDataPath;
-            }
+        // 加载借阅记录数据：载入快照和等待队列，再重放借阅日志
+        QString queueDataPath = QCoreApplication::applicationDirPath() + "/waiting_queues.json";
+        QString journalPath = QCoreApplication::applicationDirPath() + "/borrow_journal.log";
+        if (borrowManager->openJournal(borrowDataPath, queueDataPath, journalPath)) {
+            qDebug() << "借阅记录数据加载成功:" << borrowDataPath;
         } else {
-            qDebug() << "借阅记录数据文件不存在，将创建新文件:" << borrowDataPath;
+            qDebug() << "借阅记录数据加载失败:" << borrowDataPath;
         }
     } catch (const std::exception &e) {
         qDebug() << "加载图书和借阅记录数据失败:" << e.what();
@@ -2505,16 +2453,11 @@ void Widget::loadBookAndBorrowData()
 void Widget::refreshBorrowDataFromFile()
 {
     try {
-        QString borrowDataPath = QCoreApplication::applicationDirPath() + "/borrow_records.json";
-        
-        if (QFile::exists(borrowDataPath)) {
-            if (borrowManager->loadFromFile(borrowDataPath)) {
-                qDebug() << "借阅记录数据重新加载成功:" << borrowDataPath;
-            } else {
-                qDebug() << "借阅记录数据重新加载失败:" << borrowDataPath;
-            }
+        // 重新载入快照并重放借阅日志
+        if (borrowManager->reloadFromJournal()) {
+            qDebug() << "借阅记录数据重新加载成功";
         } else {
-            qDebug() << "借阅记录数据文件不存在:" << borrowDataPath;
+            qDebug() << "借阅记录数据重新加载失败";
         }
     } catch (const std::exception &e) {
         qDebug() << "重新加载借阅记录数据失败:" << e.what();
@@ -2601,16 +2544,15 @@ void Widget::onBorrowPageTableHeaderClicked(int logicalIndex)
 }
 
 void Widget::saveAllData() {
-    // 假设有成员 borrowManager
-    borrowManager->saveToFile("borrow_records.json");
-    borrowManager->saveWaitingQueues("waiting_queues.json");
-    // 可扩展：保存用户、图书等
+    // 借阅记录与等待队列写入同一份快照，随后清空借阅日志
+    saveBookAndBorrowData();
+    // 可扩展：保存用户等
 }
 
 void Widget::loadAllData() {
-    borrowManager->loadFromFile("borrow_records.json");
-    borrowManager->loadWaitingQueues("waiting_queues.json");
-    // 可扩展：加载用户、图书等
+    // 借阅记录与等待队列在 loadBookAndBorrowData 中随借阅日志一并载入
+    loadBookAndBorrowData();
+    // 可扩展：加载用户等
 }
 
 void Widget::setupSearchHistoryPopup() {
@@ -2687,6 +2629,32 @@ void Widget::updateSearchHistory(){
     }
 }
 
+// 输入补全：弹窗改为显示以当前输入开头的字段取值，输入清空时恢复搜索记录
+void Widget::showSearchSuggestions(int fieldIndex) {
+    QString prefix = borrowPage_searchEdit->text().trimmed();
+    if (prefix.isEmpty()) {
+        updateSearchHistory();
+        showSearchHistory();
+        return;
+    }
+    CompletionField field;
+    switch (fieldIndex) {
+    case 0: field = CompletionField::ISBN; break;
+    case 1: field = CompletionField::TITLE; break;
+    case 2: field = CompletionField::AUTHOR; break;
+    case 3: field = CompletionField::PUBLISHER; break;
+    default: // 出版年份不做补全
+        hideSearchHistory();
+        return;
+    }
+    MyVector<std::string> completions = bookManager.getCompletions(field, prefix.toStdString(), MAX_SUGGESTIONS);
+    historyModel->clear();
+    for (size_t i = 0; i < completions.getSize(); ++i) {
+        historyModel->appendRow(new QStandardItem(QString::fromStdString(completions[i])));
+    }
+    showSearchHistory();
+}
+
 // 定义槽函数
 void Widget::onFocusChanged(QWidget* old, QWidget* now) {
     Q_UNUSED(old);
@@ -137,6 +137,9 @@ private:
     void loadUserData();
     void saveBookAndBorrowData();
     void loadBookAndBorrowData();
+    // 数据文件路径：程序目录下存在同名 .bin 二进制快照时优先使用，否则用 JSON
+    QString dataFilePath(const QString &baseName) const;
+    bool saveBookData();
     void refreshBorrowDataFromFile();
     
     // 权限检查方法
@@ -161,6 +164,7 @@ private:
 
     MyStack<QString> searchHistory;  // 用于保存搜索记录的栈
     const int MAX_HISTORY = 10;     // 最大保存记录数
+    const int MAX_SUGGESTIONS = 10; // 输入补全最多显示的条数
 
     //更新页码信息
     void updatePageInfo(int pageNum, int pageSize, int totalResults);
@@ -172,6 +176,7 @@ private:
     void showSearchHistory();
     void hideSearchHistory();
     void updateSearchHistory();
+    void showSearchSuggestions(int fieldIndex);
     void onFocusChanged(QWidget* old, QWidget* now);
 };
 #endif // WIDGET_H